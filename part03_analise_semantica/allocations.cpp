@@ -0,0 +1,162 @@
+#include "superheader.h"
+#include <cstdio>
+
+static const char* const SUBSYSTEM_NAMES[ALLOC_SUBSYSTEMS] = {
+    "outros", "scanner", "parser", "simbolos", "diagnosticos"
+};
+
+const char* allocSubsystemName(AllocSubsystem subsystem) {
+    return SUBSYSTEM_NAMES[subsystem];
+}
+
+#ifdef XPP_TRACK_ALLOCATIONS
+
+thread_local AllocSubsystem currentAllocSubsystem = ALLOC_OTHER;
+
+// Contadores globais: um bloco pode ser liberado por outra thread (as interfaces de um
+// programa são criadas nas threads do pool e liberadas na principal).
+struct SubsystemCounters {
+    std::atomic<uint64_t> count;
+    std::atomic<uint64_t> bytes;
+    std::atomic<int64_t> live;
+    std::atomic<int64_t> peak;
+};
+static SubsystemCounters counters[ALLOC_SUBSYSTEMS];
+
+// Cabeçalho de cada bloco; 16 bytes preservam o alinhamento de `malloc`.
+struct alignas(16) BlockHeader {
+    uint64_t size;
+    AllocSubsystem subsystem;
+};
+
+static void count(AllocSubsystem s, int64_t bytes) {
+    SubsystemCounters& c = counters[s];
+    if (bytes > 0) {
+        c.count.fetch_add(1, std::memory_order_relaxed);
+        c.bytes.fetch_add((uint64_t) bytes, std::memory_order_relaxed);
+    }
+    int64_t live = c.live.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+    int64_t peak = c.peak.load(std::memory_order_relaxed);
+    while (live > peak && !c.peak.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {
+    }
+}
+
+void countArenaBlock(int64_t bytes) {
+    count(ALLOC_SYMBOLS, bytes);
+}
+
+static void* allocate(size_t size) {
+    BlockHeader* h = (BlockHeader*) malloc(size + sizeof(BlockHeader));
+    if (h == nullptr)
+        return nullptr;
+    h->size = size;
+    h->subsystem = currentAllocSubsystem;
+    count(h->subsystem, (int64_t) size);
+    return h + 1;
+}
+
+static void release(void* p) {
+    if (p == nullptr)
+        return;
+    BlockHeader* h = (BlockHeader*) p - 1;
+    count(h->subsystem, -(int64_t) h->size);
+    free(h);
+}
+
+void* operator new(size_t size) {
+    void* p = allocate(size);
+    if (p == nullptr)
+        throw std::bad_alloc();
+    return p;
+}
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    return allocate(size);
+}
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+    return allocate(size);
+}
+void operator delete(void* p) noexcept {
+    release(p);
+}
+void operator delete[](void* p) noexcept {
+    release(p);
+}
+void operator delete(void* p, size_t) noexcept {
+    release(p);
+}
+void operator delete[](void* p, size_t) noexcept {
+    release(p);
+}
+void operator delete(void* p, const std::nothrow_t&) noexcept {
+    release(p);
+}
+void operator delete[](void* p, const std::nothrow_t&) noexcept {
+    release(p);
+}
+
+bool allocationTracking() {
+    return true;
+}
+
+AllocationStats allocationStats(AllocSubsystem s) {
+    AllocationStats stats;
+    stats.count = counters[s].count.load(std::memory_order_relaxed);
+    stats.bytes = counters[s].bytes.load(std::memory_order_relaxed);
+    stats.live = counters[s].live.load(std::memory_order_relaxed);
+    stats.peak = counters[s].peak.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void resetAllocationPeaks() {
+    for (SubsystemCounters& c : counters)
+        c.peak.store(c.live.load(std::memory_order_relaxed), std::memory_order_relaxed);
+}
+
+#else
+
+bool allocationTracking() {
+    return false;
+}
+
+AllocationStats allocationStats(AllocSubsystem) {
+    return AllocationStats();
+}
+
+void resetAllocationPeaks() {}
+
+#endif
+
+// Alocações e bytes desde `before`; "vivos" é o saldo do período (o que ainda não foi
+// liberado) e o pico é o máximo de bytes vivos do subsistema no período.
+void printAllocations(ostream& out, const AllocationStats before[ALLOC_SUBSYSTEMS]) {
+    if (!allocationTracking()) {
+        out << "\n[ALOC] Contagem de alocacoes desativada (compile com -DXPP_TRACK_ALLOCATIONS)\n";
+        return;
+    }
+
+    char line[160];
+    snprintf(line, sizeof(line), "\n[ALOC] %-13s %12s %14s %14s %14s\n", "Subsistema", "Alocacoes", "Bytes", "Vivos (B)", "Pico (B)");
+    out << line;
+    AllocationStats total = AllocationStats();
+    for (int s = 0; s < ALLOC_SUBSYSTEMS; s++) {
+        AllocationStats now = allocationStats((AllocSubsystem) s);
+        AllocationStats d;
+        d.count = now.count - before[s].count;
+        d.bytes = now.bytes - before[s].bytes;
+        d.live = now.live - before[s].live;
+        d.peak = now.peak - before[s].live;
+        total.count += d.count;
+        total.bytes += d.bytes;
+        total.live += d.live;
+        snprintf(line, sizeof(line), "[ALOC] %-13s %12llu %14llu %14lld %14lld\n", SUBSYSTEM_NAMES[s],
+                 (unsigned long long) d.count, (unsigned long long) d.bytes, (long long) d.live, (long long) d.peak);
+        out << line;
+    }
+    // Os picos dos subsistemas não acontecem ao mesmo tempo, então não há pico total.
+    snprintf(line, sizeof(line), "[ALOC] %-13s %12llu %14llu %14lld %14s\n", "total",
+             (unsigned long long) total.count, (unsigned long long) total.bytes, (long long) total.live, "-");
+    out << line;
+}
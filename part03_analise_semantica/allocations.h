@@ -0,0 +1,70 @@
+#include "superheader.h"
+
+// Subsistemas a que as alocações são atribuídas (`--alloc-report`).
+enum AllocSubsystem : uint8_t {
+    ALLOC_OTHER,        // Driver, E/S, caches e tudo fora de um `AllocationScope`.
+    ALLOC_SCANNER,
+    ALLOC_PARSER,
+    ALLOC_SYMBOLS,      // Tabelas de símbolos, arena, nomes e tipos.
+    ALLOC_DIAGNOSTICS,
+    ALLOC_SUBSYSTEMS
+};
+
+// Alocações de um subsistema desde o início do processo.
+struct AllocationStats {
+    uint64_t count;     // Alocações (blocos de `new` e blocos da arena).
+    uint64_t bytes;     // Bytes pedidos.
+    int64_t live;       // Bytes ainda não liberados.
+    int64_t peak;       // Máximo de `live` (desde `resetAllocationPeaks`).
+};
+
+// A contagem substitui os `operator new`/`delete` globais e guarda, antes de cada bloco, o
+// tamanho e o subsistema que o alocou, para que a liberação seja atribuída a quem alocou
+// mesmo em outra thread. Isso custa 16 bytes por bloco e um contador atômico por operação,
+// então só existe nas compilações com `-DXPP_TRACK_ALLOCATIONS`; nas outras, `AllocationScope`
+// e `countArenaBlock` não geram código e `--alloc-report` informa que a contagem está
+// desativada.
+//
+// O subsistema corrente é o do `AllocationScope` mais interno da thread: uma busca na tabela
+// de símbolos feita pelo parser é atribuída à tabela de símbolos.
+#ifdef XPP_TRACK_ALLOCATIONS
+extern thread_local AllocSubsystem currentAllocSubsystem;
+#endif
+
+class AllocationScope {
+public:
+#ifdef XPP_TRACK_ALLOCATIONS
+    explicit AllocationScope(AllocSubsystem subsystem) : previous(currentAllocSubsystem) {
+        currentAllocSubsystem = subsystem;
+    }
+    ~AllocationScope() {
+        currentAllocSubsystem = previous;
+    }
+#else
+    explicit AllocationScope(AllocSubsystem) {}
+#endif
+
+private:
+#ifdef XPP_TRACK_ALLOCATIONS
+    AllocSubsystem previous;
+#endif
+
+    AllocationScope(const AllocationScope&);
+    AllocationScope& operator=(const AllocationScope&);
+};
+
+bool allocationTracking();                          // Compilado com `XPP_TRACK_ALLOCATIONS`.
+AllocationStats allocationStats(AllocSubsystem subsystem);
+void resetAllocationPeaks();                        // Pico := bytes vivos agora.
+const char* allocSubsystemName(AllocSubsystem subsystem);
+
+// Blocos da arena (obtidos com `malloc`, fora do `operator new`), atribuídos à tabela de
+// símbolos. `bytes` negativo: liberação.
+#ifdef XPP_TRACK_ALLOCATIONS
+void countArenaBlock(int64_t bytes);
+#else
+inline void countArenaBlock(int64_t) {}
+#endif
+
+// Imprime as alocações feitas desde `before` (um `allocationStats` de cada subsistema).
+void printAllocations(ostream& out, const AllocationStats before[ALLOC_SUBSYSTEMS]);
@@ -0,0 +1,53 @@
+#include "superheader.h"
+
+Arena::Arena(size_t size) {
+    blockSize = size;
+    cursor = nullptr;
+    limit = nullptr;
+    used = 0;
+    reserved = 0;
+}
+
+Arena::~Arena() {
+    countArenaBlock(-(int64_t) reserved);
+    for (char* block : blocks)
+        free(block);
+}
+
+// Alinha o cursor e reserva `size` bytes. Pedidos maiores que o bloco padrao
+// recebem um bloco proprio do tamanho exato.
+void* Arena::allocate(size_t size, size_t align) {
+    uintptr_t p = ((uintptr_t) cursor + align - 1) & ~(uintptr_t) (align - 1);
+
+    if (cursor == nullptr || p + size > (uintptr_t) limit) {
+        size_t n = size + align > blockSize ? size + align : blockSize;
+        char* block = (char*) malloc(n);
+        if (block == nullptr)
+            throw std::bad_alloc();
+        blocks.push_back(block);
+        reserved += n;
+        countArenaBlock((int64_t) n);
+        cursor = block;
+        limit = block + n;
+        p = ((uintptr_t) cursor + align - 1) & ~(uintptr_t) (align - 1);
+    }
+
+    cursor = (char*) (p + size);
+    used += size;
+    return (void*) p;
+}
+
+char* Arena::copyString(const char* data, size_t len) {
+    char* s = (char*) allocate(len + 1, 1);
+    memcpy(s, data, len);
+    s[len] = '\0';
+    return s;
+}
+
+size_t Arena::bytesUsed() {
+    return used;
+}
+
+size_t Arena::bytesReserved() {
+    return reserved;
+}
@@ -0,0 +1,27 @@
+#include "superheader.h"
+
+// A classe `Arena` e um alocador sequencial ("bump allocator") por compilacao.
+// A memoria e obtida em blocos grandes e distribuida incrementando um ponteiro;
+// objetos individuais nunca sao liberados, apenas a arena inteira de uma vez.
+class Arena {
+public:
+    Arena(size_t blockSize = 64 * 1024);
+    ~Arena();
+
+    void* allocate(size_t size, size_t align); // Reserva `size` bytes alinhados.
+    char* copyString(const char*, size_t);     // Copia uma sequencia de caracteres para a arena.
+
+    size_t bytesUsed();     // Bytes entregues aos objetos.
+    size_t bytesReserved(); // Bytes obtidos do sistema (soma dos blocos).
+
+private:
+    std::vector<char*> blocks; // Blocos alocados.
+    size_t blockSize;          // Tamanho padrao de cada bloco.
+    char* cursor;              // Proxima posicao livre do bloco atual.
+    char* limit;               // Fim do bloco atual.
+    size_t used;
+    size_t reserved;
+
+    Arena(const Arena&);            // Nao copiavel.
+    Arena& operator=(const Arena&);
+};
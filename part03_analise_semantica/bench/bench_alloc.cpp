@@ -0,0 +1,128 @@
+// Orçamento de alocações: com a contagem por subsistema (`XPP_TRACK_ALLOCATIONS`), confere
+//   1. zero alocações no heap por token de identificador depois do aquecimento (inclusive
+//      identificadores longos, fora da otimização de strings curtas);
+//   2. alocações por classe compilada, pela diferença entre dois programas de tamanhos
+//      diferentes (o custo fixo da compilação se cancela), por subsistema;
+//   3. alocações do subsistema de diagnósticos em uma compilação com erro.
+// Imprime o relatório de cada etapa e retorna 1 se algum orçamento for excedido.
+//
+// Compilacao e execucao (a partir de part03_analise_semantica/):
+//   g++ -O2 -DXPP_TRACK_ALLOCATIONS -o bench_alloc bench/bench_alloc.cpp $(ls *.cpp | grep -v principal.cpp)
+//   ./bench_alloc
+#include "../superheader.h"
+#include <cstdio>
+
+// Orçamentos (alocações por classe de `generate`, com um campo, construtor e dois métodos).
+// O parser copia o lexema de cada nome que guarda; só os três nomes longos da classe (o
+// método, o parâmetro e o seu uso) passam da otimização de strings curtas.
+static const double SYMBOLS_PER_CLASS = 8;
+static const double PARSER_PER_CLASS = 3;
+static const double SCANNER_PER_CLASS = 0.1;    // Só o texto de entrada, que cresce com o fonte.
+static const uint64_t DIAGNOSTICS_PER_ERROR = 16;
+
+static void snapshot(AllocationStats out[ALLOC_SUBSYSTEMS]) {
+    for (int s = 0; s < ALLOC_SUBSYSTEMS; s++)
+        out[s] = allocationStats((AllocSubsystem) s);
+}
+
+static uint64_t allocationsSince(const AllocationStats before[ALLOC_SUBSYSTEMS], AllocSubsystem s) {
+    return allocationStats(s).count - before[s].count;
+}
+
+static string generate(int classes) {
+    string s;
+    for (int i = 0; i < classes; i++) {
+        string c = "Classe" + to_string(i);
+        s += "class " + c + (i % 10 ? " extends Classe" + to_string(i - 1) : "") + " {\n";
+        s += "    int campo" + to_string(i) + ";\n";
+        s += "    constructor() {\n        campo" + to_string(i) + " = " + to_string(i) + ";\n    }\n";
+        s += "    int metodo" + to_string(i) + "(int x) {\n        int y;\n        y = x + 1;\n        return y;\n    }\n";
+        s += "    int identificadorBemComprido" + to_string(i) + "(int parametroTambemComprido) {\n"
+             "        return parametroTambemComprido;\n    }\n";
+        s += "}\n";
+    }
+    return s;
+}
+
+// Compila `source` e devolve as alocações de cada subsistema.
+static void compileCounting(const string& source, bool expectOk, uint64_t counts[ALLOC_SUBSYSTEMS]) {
+    AllocationStats before[ALLOC_SUBSYSTEMS];
+    std::ostringstream out;
+    snapshot(before);
+    {
+        Compilation compilation(out);
+        if (compilation.compileSource(source) != expectOk)
+            printf("FALHA: resultado inesperado da compilacao: %s\n", out.str().c_str());
+    }
+    for (int s = 0; s < ALLOC_SUBSYSTEMS; s++)
+        counts[s] = allocationsSince(before, (AllocSubsystem) s);
+}
+
+int main() {
+    if (!allocationTracking()) {
+        printf("FALHA: compile com -DXPP_TRACK_ALLOCATIONS\n");
+        return 1;
+    }
+    bool ok = true;
+
+    // 1. Tokens de identificador: curtos, longos e palavras reservadas misturados.
+    string text;
+    for (int i = 0; i < 200000; i++)
+        text += i % 3 == 0 ? "x" + to_string(i % 97) + " " :
+                i % 3 == 1 ? "identificadorMuitoMaisComprido" + to_string(i) + " " : "return ";
+    SymbolTable* keywords = Compilation::createPrelude();
+    Scanner* scanner = Scanner::fromSource(text, keywords);
+    for (int i = 0; i < 1000; i++)
+        scanner->nextToken();
+    AllocationStats before[ALLOC_SUBSYSTEMS];
+    snapshot(before);
+    resetAllocationPeaks();
+    long tokens = 1000;
+    while (scanner->nextToken()->type != END_OF_FILE)
+        tokens++;
+    uint64_t scanned = 0;
+    for (int s = 0; s < ALLOC_SUBSYSTEMS; s++)
+        scanned += allocationsSince(before, (AllocSubsystem) s);
+    printf("identificadores: %ld tokens, %llu alocacoes depois do aquecimento\n", tokens, (unsigned long long) scanned);
+    printAllocations(cout, before);
+    cout.flush();
+    if (scanned != 0) {
+        printf("FALHA: esperava zero alocacoes por token de identificador\n");
+        ok = false;
+    }
+    delete scanner;
+    delete keywords;
+
+    // 2. Alocações por classe: a diferença entre 2000 e 1000 classes, por subsistema.
+    uint64_t small[ALLOC_SUBSYSTEMS], large[ALLOC_SUBSYSTEMS];
+    compileCounting(generate(1000), true, small); // Aquecimento (caches do processo).
+    compileCounting(generate(1000), true, small);
+    snapshot(before);
+    resetAllocationPeaks();
+    compileCounting(generate(2000), true, large);
+    printf("\nprograma de 2000 classes:");
+    printAllocations(cout, before);
+    cout.flush();
+    const double budget[ALLOC_SUBSYSTEMS] = { 1e9, SCANNER_PER_CLASS, PARSER_PER_CLASS, SYMBOLS_PER_CLASS, 0 };
+    for (int s = ALLOC_SCANNER; s <= ALLOC_DIAGNOSTICS; s++) {
+        double perClass = ((double) large[s] - (double) small[s]) / 1000;
+        printf("%-13s %.3f alocacoes por classe (orcamento %.3f)\n", allocSubsystemName((AllocSubsystem) s), perClass, budget[s]);
+        if (perClass > budget[s]) {
+            printf("FALHA: orcamento de %s excedido\n", allocSubsystemName((AllocSubsystem) s));
+            ok = false;
+        }
+    }
+
+    // 3. Um erro semântico no fim de um programa grande: o diagnóstico custa poucas alocações.
+    uint64_t failed[ALLOC_SUBSYSTEMS];
+    compileCounting(generate(1000) + "class Erro extends Inexistente { }\n", false, failed);
+    printf("\ndiagnostico de um erro: %llu alocacoes (orcamento %llu)\n",
+           (unsigned long long) failed[ALLOC_DIAGNOSTICS], (unsigned long long) DIAGNOSTICS_PER_ERROR);
+    if (failed[ALLOC_DIAGNOSTICS] > DIAGNOSTICS_PER_ERROR) {
+        printf("FALHA: orcamento de diagnosticos excedido\n");
+        ok = false;
+    }
+
+    printf("%s\n", ok ? "OK" : "FALHOU");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,115 @@
+// Latência do servidor de linguagem: abre um documento de ~50 mil linhas em um
+// `DocumentAnalysis` e mede, para edições dentro de métodos, o tempo entre a edição e os
+// diagnósticos atualizados (`replace` + `analyze` + `diagnostics`). Cada rodada insere uma
+// linha, introduz um erro (variável não declarada) e o desfaz; o erro precisa aparecer na
+// linha certa e sumir depois, e o mesmo erro é conferido com uma compilação completa.
+// Retorna 1 se a mediana passar de 10 ms.
+//
+// Compilacao e execucao (a partir de part03_analise_semantica/):
+//   g++ -O2 -o bench_lsp bench/bench_lsp.cpp $(ls *.cpp | grep -v principal.cpp)
+//   ./bench_lsp [classes] [rodadas]
+#include "../superheader.h"
+#include <cstdio>
+
+using Clock = std::chrono::steady_clock;
+
+// Classes em cadeias de herança de 10, com campos, construtor e métodos que usam a classe
+// anterior como parâmetro (12 linhas por classe).
+static string generate(int classes) {
+    string s;
+    for (int i = 0; i < classes; i++) {
+        string c = "C" + to_string(i);
+        s += "class " + c + (i % 10 ? " extends C" + to_string(i - 1) : "") + " {\n";
+        s += "    int f" + to_string(i) + ";\n";
+        s += "    constructor() {\n        f" + to_string(i) + " = " + to_string(i) + ";\n    }\n";
+        s += "    int m" + to_string(i) + "(int x) {\n        int y;\n        y = x + " + to_string(i % 7) + ";\n        return y;\n    }\n";
+        s += "    int u" + to_string(i) + "(" + (i > 0 ? "C" + to_string(i - 1) + " o" : "int o") + ") { return " +
+             (i > 0 ? "o.m" + to_string(i - 1) + "(1)" : "o") + "; }\n";
+        s += "}\n";
+    }
+    return s;
+}
+
+static double since(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+static double percentile(std::vector<double> v, double p) {
+    std::sort(v.begin(), v.end());
+    return v[std::min(v.size() - 1, (size_t) (p * v.size()))];
+}
+
+int main(int argc, char* argv[]) {
+    int classes = argc > 1 ? atoi(argv[1]) : 4200;
+    int rounds = argc > 2 ? atoi(argv[2]) : 200;
+    string source = generate(classes);
+
+    DocumentAnalysis doc;
+    Clock::time_point start = Clock::now();
+    doc.setText(source);
+    size_t analyzed = doc.analyze();
+    double openMs = since(start);
+    int lines = (int) std::count(source.begin(), source.end(), '\n');
+    printf("documento: %d linhas, %zu classes; abertura %.1f ms (%zu analises)\n",
+           lines, doc.classCount(), openMs, analyzed);
+    if (!doc.diagnostics().empty()) {
+        printf("FALHA: diagnosticos no documento valido: %s\n", doc.diagnostics()[0].message.c_str());
+        return 1;
+    }
+
+    std::vector<double> times;
+    std::vector<int> added(classes, 0); // Linhas já inseridas em cada classe.
+    size_t reanalyzed = 0;
+    srand(42);
+    for (int r = 0; r < rounds; r++) {
+        int i = classes / 4 + rand() % (classes / 2);
+        int line = 12 * i + 1 + 8 + added[i];                // `return y;` em mi.
+        for (int j = 0; j < i; j++)
+            line += added[j];
+        size_t at = doc.offsetOf(line, 1);
+        added[i]++;
+
+        start = Clock::now();
+        doc.replace(at, 0, "        y = y + 1;\n");
+        reanalyzed += doc.analyze();
+        bool clean = doc.diagnostics().empty();
+        times.push_back(since(start));
+
+        size_t use = doc.offsetOf(line, 9);
+        start = Clock::now();
+        doc.replace(use, 1, "z");                            // `z = y + 1;`: z não existe.
+        reanalyzed += doc.analyze();
+        std::vector<DocumentDiagnostic> errors = doc.diagnostics();
+        times.push_back(since(start));
+
+        if (!clean || errors.size() != 1 || errors[0].line != line) {
+            printf("FALHA: rodada %d, classe %d: %zu diagnosticos\n", r, i, errors.size());
+            return 1;
+        }
+        if (r == 0) {
+            std::ostringstream out;
+            Compilation full(out);
+            full.compileSource(doc.text());
+            if (out.str().find("Linha " + to_string(line) + ": " + errors[0].message) == string::npos) {
+                printf("FALHA: compilacao completa difere: %s\n", out.str().c_str());
+                return 1;
+            }
+        }
+
+        start = Clock::now();
+        doc.replace(use, 1, "y");
+        reanalyzed += doc.analyze();
+        clean = doc.diagnostics().empty();
+        times.push_back(since(start));
+        if (!clean) {
+            printf("FALHA: rodada %d, erro nao foi removido\n", r);
+            return 1;
+        }
+    }
+
+    double p50 = percentile(times, 0.5);
+    printf("edicoes: %zu, classes reanalisadas: %zu\n", times.size(), reanalyzed);
+    printf("edicao -> diagnosticos: p50 %.3f ms, p99 %.3f ms, max %.3f ms\n",
+           p50, percentile(times, 0.99), percentile(times, 1.0));
+    return p50 > 10.0 ? 1 : 0;
+}
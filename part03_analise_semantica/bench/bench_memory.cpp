@@ -0,0 +1,169 @@
+// Escala de memória: compila programas gerados (`tools/program_generator.h`) de tamanhos
+// crescentes, cada um em um processo filho, e registra por tamanho o pico de RSS, os bytes
+// por byte de fonte e por símbolo, e o crescimento do pico em cada fase do `TimeReport`
+// (leitura e análise). Compilado com `-DXPP_TRACK_ALLOCATIONS`, mostra também o pico de bytes
+// vivos de cada subsistema por byte de fonte.
+//
+// O custo fixo do processo se cancela na inclinação entre o menor e o maior programa: os
+// bytes de RSS por byte de fonte acrescentado. O teste falha se essa inclinação passar de
+// `MAX_BYTES_PER_SOURCE_BYTE`, ou se algum programa não compilar.
+//
+// O programa é gravado em um arquivo temporário e compilado pelo mesmo caminho do driver
+// (`Compilation::compile`); o processo pai libera o fonte antes do `fork`, para que o pico do
+// filho só conte a compilação.
+//
+// Compilacao e execucao (a partir de part03_analise_semantica/):
+//   g++ -O2 -o bench_memory bench/bench_memory.cpp $(ls *.cpp | grep -v principal.cpp)
+//   ./bench_memory [tamanhos em MB...]     (padrao: 1 2 4 8 16 32 64)
+#include "../superheader.h"
+#include "../tools/program_generator.h"
+#include <cstdio>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// Orçamento: a leitura guarda o texto uma vez (1 byte por byte de fonte, com a string
+// reservada pelo tamanho do arquivo) e a análise acrescenta de 0,3 a 0,7, conforme os
+// tamanhos caiam antes ou depois de uma duplicação das tabelas. Entre pares de tamanhos de
+// 1 a 64 MB a inclinação medida fica entre 0,5 e 1,7; o orçamento deixa ~45% de folga sobre
+// o pior par.
+static const double MAX_BYTES_PER_SOURCE_BYTE = 2.5;
+
+struct Measurement {
+    bool ok;
+    long sourceBytes;
+    long symbols;
+    long baseKB;                        // RSS do filho antes de compilar.
+    long peakKB;                        // Pico de RSS do filho.
+    long phaseKB[TIME_PHASES];          // Crescimento do pico em cada fase externa.
+    int64_t subsystemPeak[ALLOC_SUBSYSTEMS];
+};
+
+// Campo em KB de /proc/self/status ("VmRSS", "VmHWM").
+static long statusKB(const char* field) {
+    FILE* f = fopen("/proc/self/status", "r");
+    if (f == nullptr)
+        return 0;
+    char line[256];
+    long value = 0;
+    size_t n = strlen(field);
+    while (fgets(line, sizeof(line), f) != nullptr)
+        if (strncmp(line, field, n) == 0 && line[n] == ':')
+            value = atol(line + n + 1);
+    fclose(f);
+    return value;
+}
+
+static void compileChild(const char* path, long sourceBytes, int fd) {
+    Measurement m = Measurement();
+    m.sourceBytes = sourceBytes;
+    AllocationStats before[ALLOC_SUBSYSTEMS];
+    for (int s = 0; s < ALLOC_SUBSYSTEMS; s++)
+        before[s] = allocationStats((AllocSubsystem) s);
+    resetAllocationPeaks();
+    m.baseKB = statusKB("VmRSS");
+
+    std::ostringstream discard;
+    TimeReport report;
+    long symbols = compilerStats.symbols;
+    report.start();
+    {
+        Compilation compilation(discard);
+        m.ok = compilation.compile(path);
+        m.peakKB = statusKB("VmHWM"); // Antes de liberar a compilação.
+    }
+    report.stop();
+    m.symbols = compilerStats.symbols - symbols;
+    for (int p = 0; p < TIME_PHASES; p++)
+        m.phaseKB[p] = report.rssGrowthKB((TimedPhase) p);
+    for (int s = 0; s < ALLOC_SUBSYSTEMS; s++)
+        m.subsystemPeak[s] = allocationStats((AllocSubsystem) s).peak - before[s].live;
+
+    if (write(fd, &m, sizeof(m)) != (ssize_t) sizeof(m))
+        _exit(1);
+    _exit(0);
+}
+
+static bool measure(size_t mb, Measurement* m) {
+    const char* path = "bench_memory.tmp.xpp";
+    long sourceBytes;
+    {
+        GeneratorOptions options;
+        options.targetBytes = mb * 1024 * 1024;
+        string source = ProgramGenerator(options).generate();
+        sourceBytes = (long) source.size();
+        FILE* f = fopen(path, "wb");
+        if (f == nullptr || fwrite(source.data(), 1, source.size(), f) != source.size())
+            return false;
+        fclose(f);
+    }
+
+    int fds[2];
+    if (pipe(fds) != 0)
+        return false;
+    cout.flush();
+    pid_t pid = fork();
+    if (pid == 0) {
+        close(fds[0]);
+        compileChild(path, sourceBytes, fds[1]);
+    }
+    close(fds[1]);
+    bool ok = pid > 0 && read(fds[0], m, sizeof(*m)) == (ssize_t) sizeof(*m);
+    close(fds[0]);
+    int status = 0;
+    if (pid > 0)
+        waitpid(pid, &status, 0);
+    remove(path);
+    return ok && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+int main(int argc, char* argv[]) {
+    std::vector<size_t> sizes;
+    for (int i = 1; i < argc; i++)
+        sizes.push_back((size_t) atol(argv[i]));
+    if (sizes.empty())
+        sizes = { 1, 2, 4, 8, 16, 32, 64 };
+
+    printf("%8s %10s %10s %10s %12s %10s %10s %10s", "Fonte MB", "Simbolos", "Pico (MB)", "B/byte", "B/simbolo",
+           "leitura", "analise", "interface");
+    if (allocationTracking())
+        for (int s = 1; s < ALLOC_SUBSYSTEMS; s++)
+            printf(" %12s", allocSubsystemName((AllocSubsystem) s));
+    printf("\n%-74s", "");
+    printf("%s\n", allocationTracking() ? " (pico de bytes vivos por byte de fonte)" : "(B/byte por fase)");
+
+    std::vector<Measurement> results;
+    bool ok = true;
+    for (size_t mb : sizes) {
+        Measurement m;
+        if (!measure(mb, &m) || !m.ok) {
+            printf("FALHA: o programa de %zu MB nao compilou\n", mb);
+            ok = false;
+            continue;
+        }
+        results.push_back(m);
+        double growth = (m.peakKB - m.baseKB) * 1024.0;
+        printf("%8.1f %10ld %10.1f %10.2f %12.1f", m.sourceBytes / (1024.0 * 1024.0), m.symbols, growth / (1024.0 * 1024.0),
+               growth / m.sourceBytes, m.symbols > 0 ? growth / m.symbols : 0.0);
+        for (TimedPhase p : { TIME_READ, TIME_SYNTAX, TIME_INTERFACE })
+            printf(" %10.2f", m.phaseKB[p] * 1024.0 / m.sourceBytes);
+        if (allocationTracking())
+            for (int s = 1; s < ALLOC_SUBSYSTEMS; s++)
+                printf(" %12.2f", (double) m.subsystemPeak[s] / m.sourceBytes);
+        printf("\n");
+        fflush(stdout);
+    }
+
+    if (results.size() >= 2) {
+        const Measurement& a = results.front();
+        const Measurement& b = results.back();
+        double slope = ((b.peakKB - b.baseKB) - (a.peakKB - a.baseKB)) * 1024.0 / (double) (b.sourceBytes - a.sourceBytes);
+        printf("\nRSS por byte de fonte acrescentado: %.2f (orcamento %.2f)\n", slope, MAX_BYTES_PER_SOURCE_BYTE);
+        if (slope > MAX_BYTES_PER_SOURCE_BYTE) {
+            printf("FALHA: a memoria por byte de fonte passou do orcamento\n");
+            ok = false;
+        }
+    }
+
+    printf("%s\n", ok ? "OK" : "FALHOU");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,159 @@
+// Escala paralela da compilação de programas de vários arquivos (`ProgramBuild`): compila a
+// mesma carga com 1, 2, 4, 8 ... N threads e, para cada número de threads, mostra o tempo
+// (mediana das repetições), o speedup e a eficiência em relação a uma thread, e a divisão do
+// tempo das threads do pool (`ThreadPool::stats`): executando tarefas, paradas com a fila
+// vazia e esperando o mutex da fila. O desequilíbrio é o tempo de trabalho da thread mais
+// ocupada sobre a média (1.00: carga igual em todas).
+//
+// As cargas são geradas localmente (`tools/program_generator.h`) em `bench_parallel.tmp/`:
+//   - muitos_arquivos: um arquivo principal que importa 256 arquivos pequenos independentes;
+//   - arquivo_grande: um único arquivo de 16 MB (nada a paralelizar na análise);
+//   - heranca_profunda: 8 cadeias de 16 arquivos em que cada arquivo importa o anterior e as
+//     suas classes estendem as dele, formando hierarquias de dezenas de níveis; o
+//     paralelismo é limitado ao número de cadeias.
+//
+// Compilacao e execucao (a partir de part03_analise_semantica/):
+//   g++ -O2 -o bench_parallel bench/bench_parallel.cpp $(ls *.cpp | grep -v principal.cpp)
+//   ./bench_parallel [N] [repeticoes]     (padrao: uma thread por nucleo, 3 repeticoes)
+#include "../superheader.h"
+#include "../tools/program_generator.h"
+#include <cstdio>
+
+namespace fs = std::filesystem;
+using Clock = std::chrono::steady_clock;
+
+static const char* const DIR = "bench_parallel.tmp";
+
+struct Workload {
+    const char* name;
+    string mainPath;
+    string mainSource;
+};
+
+static bool writeFile(const string& path, const string& text) {
+    std::ofstream out(path, std::ios::binary);
+    out << text;
+    return (bool) out;
+}
+
+// Um arquivo gerado com as classes [firstClass, firstClass + classes), importando `import`
+// e estendendo `baseClass` (de `import`) quando não são vazios.
+static string generateFile(int seed, int firstClass, int classes, const string& import, const string& baseClass) {
+    GeneratorOptions options;
+    options.seed = seed;
+    options.classes = classes;
+    options.firstClass = firstClass;
+    options.baseClass = baseClass;
+    string text = import.empty() ? "" : "import \"" + import + "\";\n";
+    ProgramGenerator(options).generate(text);
+    return text;
+}
+
+// Nome da classe `id` no gerador (comprimento mínimo padrão de 6 caracteres).
+static string className(int id) {
+    string s = "C" + to_string(id);
+    return s + string(s.size() < 6 ? 6 - s.size() : 0, 'z');
+}
+
+static std::vector<Workload> generateWorkloads() {
+    std::vector<Workload> workloads;
+    fs::create_directories(DIR);
+
+    Workload many = { "muitos_arquivos", string(DIR) + "/muitos.xpp", "" };
+    for (int i = 0; i < 256; i++) {
+        string file = "pequeno" + to_string(i) + ".xpp";
+        writeFile(string(DIR) + "/" + file, generateFile(i + 1, i * 100, 40, "", ""));
+        many.mainSource += "import \"" + file + "\";\n";
+    }
+    many.mainSource += generateFile(1000, 1000000, 4, "", "");
+    workloads.push_back(many);
+
+    GeneratorOptions large;
+    large.targetBytes = 16 * 1024 * 1024;
+    workloads.push_back({ "arquivo_grande", string(DIR) + "/grande.xpp", ProgramGenerator(large).generate() });
+
+    Workload deep = { "heranca_profunda", string(DIR) + "/profunda.xpp", "" };
+    const int CHAINS = 8, LENGTH = 16, CLASSES = 40;
+    for (int c = 0; c < CHAINS; c++) {
+        string previous;
+        for (int d = 0; d < LENGTH; d++) {
+            int first = (c * LENGTH + d) * CLASSES;
+            string file = "cadeia" + to_string(c) + "_" + to_string(d) + ".xpp";
+            // As raízes de cada arquivo estendem a última classe do anterior: a hierarquia ganha
+            // pelo menos um nível por arquivo.
+            string base = d > 0 ? className(first - 1) : "";
+            writeFile(string(DIR) + "/" + file, generateFile(c * LENGTH + d + 1, first, CLASSES, previous, base));
+            previous = file;
+        }
+        deep.mainSource += "import \"" + previous + "\";\n";
+    }
+    deep.mainSource += generateFile(2000, 2000000, 4, "", "");
+    workloads.push_back(deep);
+    return workloads;
+}
+
+struct Run {
+    double ms;
+    std::vector<ThreadPool::WorkerStats> workers;
+};
+
+static bool compileOnce(const Workload& w, size_t threads, SymbolTable* prelude, Run* run) {
+    std::ostringstream out;
+    Clock::time_point start = Clock::now();
+    ProgramBuild build(threads, prelude);
+    bool ok = build.compile(w.mainPath, w.mainSource, out);
+    run->ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    run->workers = build.workerStats();
+    if (!ok)
+        printf("FALHA: %s nao compilou:\n%s\n", w.name, out.str().c_str());
+    return ok;
+}
+
+int main(int argc, char* argv[]) {
+    size_t maxThreads = argc > 1 ? (size_t) atol(argv[1]) : std::max(1u, std::thread::hardware_concurrency());
+    int repetitions = argc > 2 ? std::max(1, atoi(argv[2])) : 3;
+    std::vector<size_t> counts;
+    for (size_t n = 1; n < maxThreads; n *= 2)
+        counts.push_back(n);
+    counts.push_back(maxThreads);
+
+    std::vector<Workload> workloads = generateWorkloads();
+    SymbolTable* prelude = Compilation::createPrelude();
+    bool ok = true;
+
+    for (const Workload& w : workloads) {
+        printf("\n== %s ==\n", w.name);
+        printf("%7s %11s %8s %10s %10s %10s %10s %14s\n", "Threads", "Tempo (ms)", "Speedup", "Eficiencia",
+               "Trabalho", "Fila vazia", "Mutex", "Desequilibrio");
+        double single = 0;
+        for (size_t threads : counts) {
+            std::vector<Run> runs(repetitions);
+            for (Run& run : runs)
+                ok = compileOnce(w, threads, prelude, &run) && ok;
+            std::sort(runs.begin(), runs.end(), [](const Run& a, const Run& b) { return a.ms < b.ms; });
+            const Run& median = runs[runs.size() / 2];
+            if (threads == 1)
+                single = median.ms;
+
+            // Frações do tempo total das threads do pool (threads x tempo).
+            double busy = 0, idle = 0, lock = 0, busiest = 0;
+            for (const ThreadPool::WorkerStats& s : median.workers) {
+                busy += s.busyMs;
+                idle += s.idleMs;
+                lock += s.lockMs;
+                busiest = std::max(busiest, s.busyMs);
+            }
+            double capacity = median.ms * median.workers.size();
+            double mean = busy / median.workers.size();
+            printf("%7zu %11.1f %8.2f %9.0f%% %9.1f%% %9.1f%% %9.2f%% %14.2f\n", threads, median.ms, single / median.ms,
+                   100 * single / median.ms / threads, 100 * busy / capacity, 100 * idle / capacity, 100 * lock / capacity,
+                   mean > 0 ? busiest / mean : 0.0);
+            fflush(stdout);
+        }
+    }
+    delete prelude;
+    fs::remove_all(DIR);
+
+    printf("%s\n", ok ? "OK" : "FALHOU");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,140 @@
+// Benchmark e teste de estresse da `PersistentSymbolTable`.
+// 1. Custo de uma atualização de k símbolos em tabelas de 10^3 e 10^5 símbolos, comparado a
+//    copiar uma `SymbolTable` inteira para cada nova versão.
+// 2. Leitores concorrentes tirando snapshots enquanto um escritor publica versões: cada versão
+//    grava o mesmo número em todos os símbolos "marca_*", então um snapshot que misture duas
+//    versões é detectado.
+//
+// Compilacao (a partir de part03_analise_semantica/):
+//   g++ -O2 -pthread -o bench_persistent bench/bench_persistent.cpp persistentsymboltable.cpp symboltable.cpp stentry.cpp arena.cpp interner.cpp typetable.cpp classhierarchy.cpp moduleinterface.cpp stats.cpp
+#include "../superheader.h"
+#include <chrono>
+#include <cstdio>
+#include <thread>
+
+using Clock = std::chrono::steady_clock;
+
+static double secondsSince(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+static PersistentSymbol symbol(const string& name, int line) {
+    PersistentSymbol s;
+    s.name = name;
+    s.type = "int";
+    s.kind = VARIABLE;
+    s.isArray = false;
+    s.line = line;
+    return s;
+}
+
+static void benchUpdates() {
+    size_t sizes[] = { 1000, 100000 };
+    size_t changes[] = { 1, 10, 100 };
+
+    cout << "simbolos    alterados   HAMT (us/versao)   copia FlatHashMap (us/versao)" << endl;
+    for (size_t n : sizes) {
+        PersistentSymbolTable table;
+        {
+            PersistentSymbolTable::Transaction t(table);
+            for (size_t i = 0; i < n; i++)
+                t.put(symbol("variavel_" + to_string(i), 1));
+            t.commit();
+        }
+
+        SymbolTable* global = new SymbolTable();
+        SymbolTable flat(global);
+        for (size_t i = 0; i < n; i++)
+            flat.add(new (global->arena) STEntry(global->intern("variavel_" + to_string(i)), VARIABLE, TYPE_INT));
+
+        for (size_t k : changes) {
+            int versions = 2000;
+            Clock::time_point start = Clock::now();
+            for (int v = 0; v < versions; v++) {
+                PersistentSymbolTable::Transaction t(table);
+                for (size_t j = 0; j < k; j++)
+                    t.put(symbol("variavel_" + to_string((v * k + j) * 7919 % n), v));
+                t.commit();
+            }
+            double hamt = secondsSince(start) / versions * 1e6;
+
+            // Sem compartilhamento estrutural, cada versão precisa de uma cópia completa.
+            int copies = n >= 100000 ? 20 : 2000;
+            start = Clock::now();
+            for (int v = 0; v < copies; v++) {
+                SymbolTable copy(global);
+                flat.symbols.forEach([&](Atom name, STEntry* e) { copy.symbols.insert(name, e); });
+            }
+            double full = secondsSince(start) / copies * 1e6;
+
+            printf("%-11zu %-11zu %16.2f   %29.2f\n", n, k, hamt, full);
+        }
+        delete global;
+    }
+}
+
+static bool stress(int readerCount, int versions) {
+    const int MARKS = 64;
+    PersistentSymbolTable table;
+    {
+        PersistentSymbolTable::Transaction t(table);
+        for (int i = 0; i < 10000; i++)
+            t.put(symbol("variavel_" + to_string(i), 0));
+        for (int i = 0; i < MARKS; i++)
+            t.put(symbol("marca_" + to_string(i), 0));
+        t.commit();
+    }
+
+    std::atomic<bool> stop(false);
+    std::atomic<long> snapshots(0), lookups(0), torn(0);
+    std::vector<std::thread> readers;
+
+    for (int r = 0; r < readerCount; r++) {
+        readers.emplace_back([&]() {
+            while (!stop.load()) {
+                PersistentSymbolTable::Snapshot s(table);
+                int line = s->get("marca_0")->line;
+                for (int i = 1; i < MARKS; i++)
+                    if (s->get("marca_" + to_string(i))->line != line)
+                        torn++;
+                snapshots++;
+                lookups += MARKS;
+            }
+        });
+    }
+
+    Clock::time_point start = Clock::now();
+    for (int v = 1; v <= versions; v++) {
+        PersistentSymbolTable::Transaction t(table);
+        for (int i = 0; i < MARKS; i++)
+            t.put(symbol("marca_" + to_string(i), v));
+        if (v % 2)
+            t.put(symbol("temporaria_" + to_string(v), v));
+        else
+            t.remove("temporaria_" + to_string(v - 1));
+        t.commit();
+    }
+    double elapsed = secondsSince(start);
+    stop.store(true);
+    for (std::thread& t : readers)
+        t.join();
+
+    PersistentSymbolTable::Snapshot last(table);
+    bool ok = torn.load() == 0 && last->size() == 10000 + MARKS && last->number() == (uint64_t) versions + 1;
+
+    printf("leitores=%d versoes=%d: %.0f versoes/s, %.3e buscas/s, %ld snapshots, %ld inconsistentes, %zu versoes pendentes -> %s\n",
+           readerCount, versions, versions / elapsed, lookups.load() / elapsed, snapshots.load(), torn.load(),
+           table.pendingVersions(), ok ? "OK" : "FALHOU");
+    return ok;
+}
+
+int main() {
+    benchUpdates();
+    cout << endl;
+
+    bool ok = true;
+    unsigned cores = std::thread::hardware_concurrency();
+    for (int readers : { 1, 4, (int) (cores > 1 ? cores - 1 : 1) })
+        ok = stress(readers, 20000) && ok;
+    return ok ? 0 : 1;
+}
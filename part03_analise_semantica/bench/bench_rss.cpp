@@ -0,0 +1,63 @@
+// Teste de memória residente: executa 10^5 compilações no mesmo processo (alternando um
+// programa válido e programas com erro léxico, sintático e semântico) e verifica que o RSS
+// fica estável depois do aquecimento. Retorna 1 se o RSS crescer mais que a tolerância.
+//
+// Compilacao e execucao (a partir de part03_analise_semantica/):
+//   g++ -O2 -o bench_rss bench/bench_rss.cpp $(ls *.cpp | grep -v principal.cpp)
+//   ./bench_rss > /dev/null
+#include "../superheader.h"
+#include <cstdio>
+#include <sstream>
+#include <unistd.h>
+
+// RSS atual em KB (Linux: /proc/self/statm).
+static long residentKB() {
+    long pages = 0, resident = 0;
+    FILE* f = fopen("/proc/self/statm", "r");
+    if (f == nullptr)
+        return 0;
+    if (fscanf(f, "%ld %ld", &pages, &resident) != 2)
+        resident = 0;
+    fclose(f);
+    return resident * (sysconf(_SC_PAGESIZE) / 1024);
+}
+
+int main(int argc, char* argv[]) {
+    long iterations = argc > 1 ? atol(argv[1]) : 100000;
+    const long TOLERANCE_KB = 1024;
+    const char* files[] = {
+        "tests/test_heranca.xpp",
+        "tests/test_erro_lexico.xpp",
+        "tests/test_erro_sintaxe.xpp",
+        "tests/test_erro_semantico1.xpp",
+    };
+
+    // A saída das compilações é descartada; o relatório vai para stderr.
+    std::streambuf* original = cout.rdbuf();
+    std::ostringstream discard;
+    cout.rdbuf(discard.rdbuf());
+
+    // Aquecimento: 1% das iterações, e pelo menos uma. Só o primeiro arquivo compila sem erro.
+    long warmup = std::max(1L, iterations / 100);
+    long warm = 0, failures = 0, expectedFailures = 0;
+    for (long i = 0; i < iterations; i++) {
+        Compilation compilation;
+        if (!compilation.compile(files[i % 4]))
+            failures++;
+        if (i % 4 != 0)
+            expectedFailures++;
+        discard.str("");
+
+        if (i + 1 == warmup)
+            warm = residentKB();
+        if ((i + 1) % (iterations / 10 > 0 ? iterations / 10 : 1) == 0)
+            fprintf(stderr, "compilacoes=%ld rss=%ld KB\n", i + 1, residentKB());
+    }
+    cout.rdbuf(original);
+
+    long final = residentKB();
+    bool ok = failures == expectedFailures && final - warm <= TOLERANCE_KB;
+    fprintf(stderr, "rss apos aquecimento=%ld KB, final=%ld KB, crescimento=%ld KB (tolerancia %ld KB), com erro=%ld -> %s\n",
+            warm, final, final - warm, TOLERANCE_KB, failures, ok ? "OK" : "FALHOU");
+    return ok ? 0 : 1;
+}
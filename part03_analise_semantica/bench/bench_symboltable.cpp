@@ -0,0 +1,351 @@
+// Microbenchmarks da tabela de simbolos (`SymbolTable` e `STEntry`), nas cargas do compilador:
+//   - palavra reservada encontrada e nao encontrada, como no estado 2 do scanner (`get` pelo
+//     lexema na tabela raiz sobre o preludio), com nomes novos e ja internalizados;
+//   - insercao de locais novos em um escopo (`add`, seguido do `clear` de `exitScope`);
+//   - `declareVariable` completo: verificacao de redeclaracao, internalizacao, entrada na
+//     arena e insercao;
+//   - busca a partir de escopos de profundidade 1 a 64 (o `get` sobe pelos pais ate a raiz);
+//   - verificacao de redeclaracao (`getLocal`) com e sem conflito;
+//   - entrada e saida de escopos, com o reaproveitamento de `enterScope`/`exitScope` e sem ele.
+//
+// Cada caso roda em lotes calibrados para durar pelo menos `MIN_SAMPLE_MS` e coleta
+// `--samples` lotes depois do aquecimento. O relatorio traz, em ns por operacao, a mediana, o
+// intervalo de confianca de 95% da mediana (pelas estatisticas de ordem, sem supor
+// distribuicao), o p99, a media e o desvio padrao. `--json` grava o mesmo em JSON, e
+// `--compare` compara dois desses arquivos (por exemplo, antes e depois de trocar a
+// implementacao da tabela): a diferenca so e marcada quando os intervalos nao se sobrepoem.
+//
+// Compilacao e execucao (a partir de part03_analise_semantica/):
+//   g++ -O2 -o bench_symboltable bench/bench_symboltable.cpp $(ls *.cpp | grep -v principal.cpp)
+//   ./bench_symboltable [--samples N] [--filter TEXTO] [--json saida.json]
+//   ./bench_symboltable --compare base.json novo.json
+#include "../superheader.h"
+#include "../tools/json.h"
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+
+using Clock = std::chrono::steady_clock;
+
+static const double MIN_SAMPLE_MS = 2;
+static const int WARMUP_BATCHES = 5;
+
+// Mantem o resultado vivo para o compilador nao eliminar as buscas.
+static volatile uintptr_t sink;
+
+struct Summary {
+    string name;
+    long opsPerSample;
+    int samples;
+    double median, low, high, p99, mean, stddev; // ns por operacao
+};
+
+// Um caso executa `ops` operacoes e devolve o tempo, em segundos, so da parte medida (a
+// preparacao de cada lote fica fora).
+typedef std::function<double(long ops)> Workload;
+
+static double secondsSince(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+static Summary measure(const string& name, const Workload& run, int samples) {
+    long ops = 64;
+    while (run(ops) * 1e3 < MIN_SAMPLE_MS)
+        ops *= 2;
+    for (int i = 0; i < WARMUP_BATCHES; i++)
+        run(ops);
+
+    std::vector<double> ns;
+    for (int i = 0; i < samples; i++)
+        ns.push_back(run(ops) * 1e9 / ops);
+    std::sort(ns.begin(), ns.end());
+
+    Summary s;
+    s.name = name;
+    s.opsPerSample = ops;
+    s.samples = samples;
+    s.median = samples % 2 ? ns[samples / 2] : (ns[samples / 2 - 1] + ns[samples / 2]) / 2;
+    // Postos da mediana com 95% de confianca: n/2 -+ 1.96 * sqrt(n)/2.
+    double spread = 1.96 * std::sqrt((double) samples) / 2;
+    s.low = ns[std::max(0, (int) std::floor(samples / 2.0 - spread))];
+    s.high = ns[std::min(samples - 1, (int) std::ceil(samples / 2.0 + spread))];
+    s.p99 = ns[std::min(samples - 1, (int) std::ceil(0.99 * samples) - 1)];
+    double sum = 0, squares = 0;
+    for (double x : ns)
+        sum += x;
+    s.mean = sum / samples;
+    for (double x : ns)
+        squares += (x - s.mean) * (x - s.mean);
+    s.stddev = samples > 1 ? std::sqrt(squares / (samples - 1)) : 0;
+    return s;
+}
+
+static void printHeader() {
+    printf("%-28s %10s %21s %10s %10s %9s\n", "caso", "mediana", "IC 95% (ns/op)", "p99", "media", "desvio");
+}
+
+static void printSummary(const Summary& s) {
+    printf("%-28s %10.2f [%9.2f, %9.2f] %10.2f %10.2f %9.2f\n", s.name.c_str(), s.median, s.low, s.high, s.p99, s.mean, s.stddev);
+}
+
+static string toJson(const std::vector<Summary>& results) {
+    string out = "{\"unit\":\"ns/op\",\"benchmarks\":[";
+    char number[256];
+    for (size_t i = 0; i < results.size(); i++) {
+        const Summary& s = results[i];
+        out += i > 0 ? ",\n{\"name\":" : "\n{\"name\":";
+        appendJson(out, s.name);
+        snprintf(number, sizeof(number),
+                 ",\"samples\":%d,\"ops_per_sample\":%ld,\"median\":%.3f,\"ci95_low\":%.3f,\"ci95_high\":%.3f,"
+                 "\"p99\":%.3f,\"mean\":%.3f,\"stddev\":%.3f}",
+                 s.samples, s.opsPerSample, s.median, s.low, s.high, s.p99, s.mean, s.stddev);
+        out += number;
+    }
+    return out + "\n]}\n";
+}
+
+static bool readJson(const char* path, std::vector<Summary>* results) {
+    std::ifstream in(path, std::ios::binary);
+    string text((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    JsonValue root;
+    if (!in || !JsonReader(text).parse(&root))
+        return false;
+    for (const JsonValue& b : root["benchmarks"].items) {
+        Summary s = Summary();
+        s.name = b["name"].asString();
+        s.median = atof(b["median"].text.c_str());
+        s.low = atof(b["ci95_low"].text.c_str());
+        s.high = atof(b["ci95_high"].text.c_str());
+        results->push_back(s);
+    }
+    return true;
+}
+
+static int compare(const char* basePath, const char* newPath) {
+    std::vector<Summary> base, current;
+    if (!readJson(basePath, &base) || !readJson(newPath, &current)) {
+        fprintf(stderr, "Nao foi possivel ler %s ou %s\n", basePath, newPath);
+        return 2;
+    }
+    printf("%-28s %12s %12s %9s\n", "caso", "base (ns)", "novo (ns)", "razao");
+    for (const Summary& n : current) {
+        for (const Summary& b : base) {
+            if (b.name != n.name)
+                continue;
+            const char* verdict = n.high < b.low ? "mais rapido" : n.low > b.high ? "mais lento" : "igual (ICs se sobrepoem)";
+            printf("%-28s %12.2f %12.2f %8.3fx  %s\n", n.name.c_str(), b.median, n.median, n.median / b.median, verdict);
+        }
+    }
+    return 0;
+}
+
+// Ambiente dos casos: preludio compartilhado e a tabela raiz de uma compilacao sobre ele.
+struct Fixture {
+    SymbolTable* prelude;
+    SymbolTable* root;
+    std::vector<string> keywords;       // Lexemas das palavras reservadas.
+    std::vector<string> fresh;          // Identificadores nunca internalizados.
+    std::vector<string> interned;       // Identificadores ja vistos (declarados em outra classe).
+    std::vector<string> locals;         // Nomes de locais, ja internalizados.
+    std::vector<STEntry*> localEntries;
+
+    Fixture() {
+        prelude = Compilation::createPrelude();
+        root = SymbolTable::withPrelude(prelude);
+        keywords = { "class", "extends", "int", "string", "break", "print", "read", "return",
+                     "super", "if", "else", "for", "new", "constructor" };
+        for (int i = 0; i < 256; i++) {
+            fresh.push_back("identificador" + to_string(i));
+            interned.push_back("campo" + to_string(i));
+            root->intern(interned.back());
+            locals.push_back("local" + to_string(i));
+            localEntries.push_back(new (root->arena) STEntry(root->intern(locals.back()), VARIABLE, TYPE_INT));
+        }
+    }
+    ~Fixture() {
+        delete root;
+        delete prelude;
+    }
+};
+
+// Uma pilha de `depth` escopos sobre a raiz, cada um com alguns locais, como os blocos
+// aninhados de um metodo. Os nomes buscados estao na raiz (o pior caso do `get`).
+static double lookupAtDepth(Fixture& f, int depth, long ops) {
+    std::vector<SymbolTable*> scopes;
+    SymbolTable* top = f.root;
+    for (int d = 0; d < depth; d++) {
+        top = new SymbolTable(top);
+        scopes.push_back(top);
+        for (int i = 0; i < 4; i++)
+            top->add(f.localEntries[(d * 4 + i) % f.localEntries.size()]);
+    }
+    STEntry* target = new (f.root->arena) STEntry(f.root->intern("Global"), CLASS_NAME);
+    f.root->add(target);
+    string name = "Global";
+
+    Clock::time_point start = Clock::now();
+    uintptr_t acc = 0;
+    for (long i = 0; i < ops; i++)
+        acc += (uintptr_t) top->get(name);
+    double seconds = secondsSince(start);
+    sink = acc;
+
+    f.root->symbols.erase(target->name);
+    for (SymbolTable* scope : scopes)
+        delete scope;
+    return seconds;
+}
+
+int main(int argc, char* argv[]) {
+    int samples = 101;
+    string filter;
+    const char* jsonPath = nullptr;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--compare" && i + 2 < argc)
+            return compare(argv[i + 1], argv[i + 2]);
+        if (arg == "--samples" && i + 1 < argc)
+            samples = std::max(3, atoi(argv[++i]));
+        else if (arg == "--filter" && i + 1 < argc)
+            filter = argv[++i];
+        else if (arg == "--json" && i + 1 < argc)
+            jsonPath = argv[++i];
+        else {
+            fprintf(stderr, "Uso: %s [--samples N] [--filter TEXTO] [--json saida.json] | --compare base.json novo.json\n", argv[0]);
+            return 2;
+        }
+    }
+
+    Fixture f;
+    std::vector<std::pair<string, Workload>> cases;
+
+    // Estado 2 do scanner: `symbolTable->get(lexema)` e o teste de `reserved`.
+    auto scannerLookup = [&f](const std::vector<string>& lexemes) {
+        return [&f, &lexemes](long ops) {
+            size_t n = lexemes.size();
+            Clock::time_point start = Clock::now();
+            uintptr_t acc = 0;
+            for (long i = 0; i < ops; i++) {
+                STEntry* entry = f.root->get(lexemes[i % n]);
+                acc += entry != nullptr && entry->reserved;
+            }
+            double seconds = secondsSince(start);
+            sink = acc;
+            return seconds;
+        };
+    };
+    cases.push_back({ "keyword_hit", scannerLookup(f.keywords) });
+    cases.push_back({ "keyword_miss_fresh", scannerLookup(f.fresh) });
+    cases.push_back({ "keyword_miss_interned", scannerLookup(f.interned) });
+
+    // Locais novos em um escopo de metodo, liberado como em `exitScope`.
+    cases.push_back({ "insert_locals", [&f](long ops) {
+        SymbolTable scope(f.root);
+        size_t n = f.localEntries.size();
+        Clock::time_point start = Clock::now();
+        for (long i = 0; i < ops; i++) {
+            scope.add(f.localEntries[i % n]);
+            if (i % 16 == 15)
+                scope.clear();
+        }
+        return secondsSince(start);
+    } });
+
+    // `declareVariable`: `getLocal`, `intern`, entrada na arena e `add`. Cada lote usa uma
+    // compilacao nova, para que a arena e o `Interner` nao cresçam entre os lotes.
+    cases.push_back({ "declare_variable", [&f](long ops) {
+        SymbolTable* root = SymbolTable::withPrelude(f.prelude);
+        SymbolTable* scope = new SymbolTable(root);
+        size_t n = f.locals.size();
+        Clock::time_point start = Clock::now();
+        for (long i = 0; i < ops; i++) {
+            const string& name = f.locals[i % n];
+            if (scope->getLocal(name) == nullptr)
+                scope->add(new (root->arena) STEntry(root->intern(name), VARIABLE, TYPE_INT, false, (int) i));
+            if (i % n == n - 1)
+                scope->clear();
+        }
+        double seconds = secondsSince(start);
+        delete scope;
+        delete root;
+        return seconds;
+    } });
+
+    for (int depth : { 1, 2, 4, 8, 16, 32, 64 })
+        cases.push_back({ "lookup_depth_" + to_string(depth), [&f, depth](long ops) { return lookupAtDepth(f, depth, ops); } });
+
+    // Verificacao de redeclaracao de `declareVariable`: o nome ja esta no escopo, ou nao.
+    auto redeclaration = [&f](bool conflict) {
+        return [&f, conflict](long ops) {
+            SymbolTable scope(f.root);
+            for (size_t i = 0; i < 16; i++)
+                scope.add(f.localEntries[i]);
+            size_t offset = conflict ? 0 : 16;
+            Clock::time_point start = Clock::now();
+            uintptr_t acc = 0;
+            for (long i = 0; i < ops; i++)
+                acc += (uintptr_t) scope.getLocal(f.locals[offset + i % 16]);
+            double seconds = secondsSince(start);
+            sink = acc;
+            return seconds;
+        };
+    };
+    cases.push_back({ "redeclaration_hit", redeclaration(true) });
+    cases.push_back({ "redeclaration_miss", redeclaration(false) });
+
+    // Um bloco (`if`, `for`) com dois locais: `enterScope`, duas insercoes, `exitScope`.
+    cases.push_back({ "scope_churn_pooled", [&f](long ops) {
+        std::vector<SymbolTable*> pool;
+        SymbolTable* current = f.root;
+        Clock::time_point start = Clock::now();
+        for (long i = 0; i < ops; i++) {
+            SymbolTable* scope;
+            if (pool.empty()) {
+                scope = new SymbolTable(current);
+            } else {
+                scope = pool.back();
+                pool.pop_back();
+                scope->parent = current;
+            }
+            scope->add(f.localEntries[i % 128]);
+            scope->add(f.localEntries[128 + i % 128]);
+            scope->clear();
+            pool.push_back(scope);
+        }
+        double seconds = secondsSince(start);
+        for (SymbolTable* scope : pool)
+            delete scope;
+        return seconds;
+    } });
+    cases.push_back({ "scope_churn_fresh", [&f](long ops) {
+        Clock::time_point start = Clock::now();
+        for (long i = 0; i < ops; i++) {
+            SymbolTable* scope = new SymbolTable(f.root);
+            scope->add(f.localEntries[i % 128]);
+            scope->add(f.localEntries[128 + i % 128]);
+            delete scope;
+        }
+        return secondsSince(start);
+    } });
+
+    std::vector<Summary> results;
+    printHeader();
+    for (const auto& c : cases) {
+        if (!filter.empty() && c.first.find(filter) == string::npos)
+            continue;
+        results.push_back(measure(c.first, c.second, samples));
+        printSummary(results.back());
+        fflush(stdout);
+    }
+
+    if (jsonPath != nullptr) {
+        std::ofstream out(jsonPath, std::ios::binary);
+        out << toJson(results);
+        if (!out) {
+            fprintf(stderr, "Nao foi possivel gravar %s\n", jsonPath);
+            return 1;
+        }
+    }
+    return 0;
+}
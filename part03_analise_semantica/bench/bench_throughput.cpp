@@ -0,0 +1,96 @@
+// Vazão de ponta a ponta sobre programas gerados (`tools/program_generator.h`, semente fixa)
+// de 1 MB, 100 MB e 1 GB. Para cada tamanho mede, sem instrumentação:
+//   - o scanner sozinho (`nextToken` até o fim do arquivo);
+//   - a compilação completa (scanner, parser e análise semântica, que rodam intercalados);
+//   - a análise sem o scanner, pela diferença entre as duas;
+// e imprime MB/s e tokens/s de cada uma. Depois compila de novo com um `TimeReport` ativo,
+// que separa o tempo do parser e o da análise semântica (medir cada token custa alguns
+// nanossegundos, então essa tabela é mais lenta que as medidas acima).
+//
+// A tabela de símbolos de 1 GB de fonte não cabe na memória, então fontes maiores que
+// `CHUNK_MB` são divididos em programas independentes de até `CHUNK_MB` (sementes
+// consecutivas), compilados um a um; os tempos e tokens são somados. O tempo de geração não
+// entra nas medidas.
+//
+// Compilacao e execucao (a partir de part03_analise_semantica/):
+//   g++ -O2 -o bench_throughput bench/bench_throughput.cpp $(ls *.cpp | grep -v principal.cpp)
+//   ./bench_throughput [tamanhos em MB...]     (padrao: 1 100 1024)
+#include "../superheader.h"
+#include "../tools/program_generator.h"
+#include <cstdio>
+
+using Clock = std::chrono::steady_clock;
+
+static const size_t CHUNK_MB = 128;
+
+static double secondsSince(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+static void printRate(const char* phase, size_t bytes, long tokens, double seconds) {
+    printf("%-10s %10.3f %10.1f %14.0f\n", phase, seconds, bytes / (1024.0 * 1024.0) / seconds, tokens / seconds);
+}
+
+int main(int argc, char* argv[]) {
+    std::vector<size_t> sizes;
+    for (int i = 1; i < argc; i++)
+        sizes.push_back((size_t) atol(argv[i]));
+    if (sizes.empty())
+        sizes = { 1, 100, 1024 };
+
+    SymbolTable* prelude = Compilation::createPrelude();
+    bool ok = true;
+    for (size_t mb : sizes) {
+        size_t bytes = 0;
+        long tokens = 0;
+        double lexSeconds = 0, fullSeconds = 0;
+        TimeReport report;
+        std::ostringstream discard;
+
+        for (size_t done = 0, chunk = 0; done < mb; done += CHUNK_MB, chunk++) {
+            GeneratorOptions options;
+            options.seed = 1 + chunk;
+            options.targetBytes = (std::min(CHUNK_MB, mb - done)) * 1024 * 1024;
+            string source = ProgramGenerator(options).generate();
+            bytes += source.size();
+
+            Clock::time_point start = Clock::now();
+            Scanner* scanner = Scanner::fromSource(source, prelude);
+            while (scanner->nextToken()->type != END_OF_FILE)
+                tokens++;
+            delete scanner;
+            lexSeconds += secondsSince(start);
+
+            start = Clock::now();
+            {
+                Compilation compilation(discard, prelude);
+                if (!compilation.compileSource(source)) {
+                    printf("FALHA: programa gerado (semente %zu) nao compilou:\n%s\n", (size_t) options.seed, discard.str().c_str());
+                    ok = false;
+                }
+            }
+            fullSeconds += secondsSince(start);
+            discard.str("");
+
+            report.start();
+            {
+                Compilation compilation(discard, prelude);
+                compilation.compileSource(source);
+            }
+            report.stop();
+            discard.str("");
+        }
+
+        printf("\n== %zu MB (%zu bytes, %ld tokens) ==\n", mb, bytes, tokens);
+        printf("%-10s %10s %10s %14s\n", "Etapa", "Tempo (s)", "MB/s", "Tokens/s");
+        printRate("lexico", bytes, tokens, lexSeconds);
+        printRate("analise", bytes, tokens, fullSeconds - lexSeconds);
+        printRate("completo", bytes, tokens, fullSeconds);
+        report.print(cout);
+        cout.flush();
+    }
+    delete prelude;
+
+    printf("%s\n", ok ? "OK" : "FALHOU");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,133 @@
+// Índice de referências em escala: compila N arquivos gerados (~50 mil linhas cada, classes
+// com nomes distintos por arquivo) registrando as ocorrências, e atualiza o índice arquivo a
+// arquivo, como compilações sucessivas com `--emit-xref`. Depois mede as consultas
+// (`references` e `subclasses`) no índice completo, confere os resultados contra o fonte
+// gerado, recompila um arquivo alterado e confere que só as entradas dele mudaram.
+// Retorna 1 se a mediana das consultas passar de 1 ms.
+//
+// Compilacao e execucao (a partir de part03_analise_semantica/):
+//   g++ -O2 -o bench_xref bench/bench_xref.cpp $(ls *.cpp | grep -v principal.cpp)
+//   ./bench_xref [arquivos] [classes por arquivo]
+#include "../superheader.h"
+#include <cstdio>
+
+using Clock = std::chrono::steady_clock;
+
+// Mesma forma do `bench_lsp` (12 linhas por classe), com um prefixo por arquivo.
+static string generate(const string& prefix, int classes) {
+    string s;
+    for (int i = 0; i < classes; i++) {
+        string c = prefix + to_string(i);
+        string prev = prefix + to_string(i - 1);
+        s += "class " + c + (i % 10 ? " extends " + prev : "") + " {\n";
+        s += "    int f" + to_string(i) + ";\n";
+        s += "    constructor() {\n        f" + to_string(i) + " = " + to_string(i) + ";\n    }\n";
+        s += "    int m" + to_string(i) + "(int x) {\n        int y;\n        y = x + " + to_string(i % 7) + ";\n        return y;\n    }\n";
+        s += "    int u" + to_string(i) + "(" + (i > 0 ? prev + " o" : "int o") + ") { return " +
+             (i > 0 ? "o.m" + to_string(i - 1) + "(1)" : "o") + "; }\n";
+        s += "}\n";
+    }
+    return s;
+}
+
+static double since(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+static double percentile(std::vector<double> v, double p) {
+    std::sort(v.begin(), v.end());
+    return v[std::min(v.size() - 1, (size_t) (p * v.size()))];
+}
+
+// Compila o arquivo e atualiza o índice com as suas ocorrências; `false` se houve erro.
+static bool compileInto(const string& index, const string& path, const string& source, double* updateMs) {
+    std::ostringstream out;
+    CrossReference occurrences;
+    Compilation compilation(out);
+    compilation.setCrossReference(&occurrences);
+    if (!compilation.compileSource(source)) {
+        printf("FALHA: %s nao compilou: %s\n", path.c_str(), out.str().c_str());
+        return false;
+    }
+    Clock::time_point start = Clock::now();
+    bool ok = XrefIndex::update(index, { { path, occurrences.all() } });
+    *updateMs = since(start);
+    return ok;
+}
+
+int main(int argc, char* argv[]) {
+    int fileCount = argc > 1 ? atoi(argv[1]) : 20;
+    int classes = argc > 2 ? atoi(argv[2]) : 4200;
+    string dir = (std::filesystem::temp_directory_path() / ("bench_xref." + to_string(Clock::now().time_since_epoch().count()))).string();
+    std::filesystem::create_directories(dir);
+    string index = dir + "/indice.xpx";
+
+    std::vector<string> prefixes, paths;
+    double updateMs = 0, lastUpdate = 0;
+    Clock::time_point start = Clock::now();
+    for (int f = 0; f < fileCount; f++) {
+        prefixes.push_back("F" + to_string(f) + "C");
+        paths.push_back(dir + "/arquivo" + to_string(f) + ".xpp");
+        if (!compileInto(index, paths.back(), generate(prefixes.back(), classes), &lastUpdate))
+            return 1;
+        updateMs += lastUpdate;
+    }
+    double buildMs = since(start);
+
+    XrefIndex full;
+    if (!full.open(index) || full.fileCount() != (size_t) fileCount) {
+        printf("FALHA: indice invalido\n");
+        return 1;
+    }
+    printf("indice: %d arquivos, %d linhas, %zu ocorrencias, %.1f MB\n", fileCount, fileCount * classes * 12,
+           full.referenceCount(), std::filesystem::file_size(index) / 1048576.0);
+    printf("compilacao + atualizacao: %.0f ms (atualizacoes %.0f ms; ultima %.1f ms)\n", buildMs, updateMs, lastUpdate);
+
+    // Consultas aleatórias; cada uma é conferida contra o que o gerador produziu.
+    std::vector<double> times;
+    srand(42);
+    for (int q = 0; q < 2000; q++) {
+        int f = rand() % fileCount, i = 1 + rand() % (classes - 2);
+        string cls = prefixes[f] + to_string(i);
+        std::vector<XrefReference> refs;
+        std::vector<XrefSubclass> subs;
+
+        start = Clock::now();
+        full.references(cls + ".m" + to_string(i), &refs);  // Declaração e uso em u(i+1).
+        full.subclasses(cls, &subs);
+        times.push_back(since(start));
+
+        size_t expectedSubs = (i + 1) % 10 ? 1 : 0;
+        if (refs.size() != 2 || !refs[0].declaration || refs[0].file != paths[f] || subs.size() != expectedSubs) {
+            printf("FALHA: consulta %s: %zu ocorrencias, %zu subclasses\n", cls.c_str(), refs.size(), subs.size());
+            return 1;
+        }
+    }
+
+    // Recompilação de um arquivo em que a chamada `o.m1(1)` foi removida: só as entradas dele
+    // mudam (saem os usos de `o` e de `m1`).
+    string changed = generate(prefixes[0], classes);
+    size_t at = changed.find("o.m1(1)");
+    changed.replace(at, 7, "1");
+    if (!compileInto(index, paths[0], changed, &lastUpdate))
+        return 1;
+    XrefIndex updated;
+    std::vector<XrefReference> refs, others;
+    if (!updated.open(index)) {
+        printf("FALHA: indice atualizado invalido\n");
+        return 1;
+    }
+    updated.references(prefixes[0] + "1.m1", &refs);
+    updated.references(prefixes[1] + "1.m1", &others);
+    if (refs.size() != 1 || others.size() != 2 || updated.referenceCount() != full.referenceCount() - 2) {
+        printf("FALHA: atualizacao incremental: %zu e %zu ocorrencias\n", refs.size(), others.size());
+        return 1;
+    }
+
+    double p50 = percentile(times, 0.5);
+    printf("recompilacao de um arquivo: atualizacao do indice %.1f ms\n", lastUpdate);
+    printf("consulta (referencias + subclasses): p50 %.4f ms, p99 %.4f ms\n", p50, percentile(times, 0.99));
+
+    std::filesystem::remove_all(dir);
+    return p50 > 1.0 ? 1 : 0;
+}
@@ -0,0 +1,250 @@
+#include "superheader.h"
+
+ClassHierarchy::ClassHierarchy(TypeTable* t) {
+    types = t;
+    built = true; // Um índice vazio está trivialmente atualizado.
+}
+
+ClassHierarchy::ClassNode* ClassHierarchy::node(TypeId type) {
+    int* i = index.find(type);
+    return i != nullptr ? &nodes[*i] : nullptr;
+}
+
+void ClassHierarchy::addClass(TypeId type, TypeId parent, int line) {
+    ClassNode n;
+    n.type = type;
+    n.parent = parent;
+    n.line = line;
+    n.pre = -1;
+    n.post = -1;
+    n.depth = 0;
+    n.firstChild = -1;
+    n.nextSibling = -1;
+    n.fields = 0;
+    n.methods = 0;
+    n.imported = false;
+
+    // Achata os membros da classe pai, que já está completa quando a filha é declarada.
+    ClassNode* p = parent == NO_TYPE ? nullptr : node(parent);
+    if (p != nullptr) {
+        n.members = p->members;
+        n.fields = p->fields;
+        n.methods = p->methods;
+        n.params = p->params;
+    }
+
+    if (index.insert(type, (int) nodes.size())) {
+        nodes.push_back(std::move(n));
+        built = false;
+    }
+}
+
+// Monta as listas de filhos e percorre a floresta a partir das raízes (classes sem pai,
+// ou cujo pai não foi registrado) com uma pilha explícita, já que hierarquias profundas
+// estourariam a recursão.
+bool ClassHierarchy::build(std::vector<TypeId>* cycle) {
+    std::vector<int> roots;
+
+    for (ClassNode& n : nodes) {
+        n.firstChild = -1;
+        n.nextSibling = -1;
+        n.pre = -1;
+    }
+    for (size_t i = nodes.size(); i-- > 0; ) {
+        int* p = nodes[i].parent == NO_TYPE ? nullptr : index.find(nodes[i].parent);
+        if (p == nullptr) {
+            roots.push_back((int) i);
+        } else {
+            nodes[i].nextSibling = nodes[*p].firstChild;
+            nodes[*p].firstChild = (int) i;
+        }
+    }
+
+    int counter = 0;
+    std::vector<int> stack;
+    for (size_t r = roots.size(); r-- > 0; ) {
+        nodes[roots[r]].depth = 0;
+        stack.push_back(roots[r]);
+
+        while (!stack.empty()) {
+            int i = stack.back();
+            if (nodes[i].pre < 0) {
+                // Primeira visita: numera e empilha os filhos.
+                nodes[i].pre = counter++;
+                for (int c = nodes[i].firstChild; c >= 0; c = nodes[c].nextSibling) {
+                    nodes[c].depth = nodes[i].depth + 1;
+                    stack.push_back(c);
+                }
+            } else {
+                // Todos os filhos já foram numerados: fecha o intervalo.
+                nodes[i].post = counter - 1;
+                stack.pop_back();
+            }
+        }
+    }
+
+    // Classes não visitadas estão em um ciclo ou descendem de um.
+    for (size_t i = 0; i < nodes.size(); i++) {
+        if (nodes[i].pre >= 0)
+            continue;
+
+        if (cycle != nullptr) {
+            // Caminha pelos pais até repetir uma classe: ela está no ciclo.
+            FlatHashMap<TypeId, bool> seen;
+            int j = (int) i;
+            while (seen.insert(nodes[j].type, true))
+                j = *index.find(nodes[j].parent);
+
+            cycle->clear();
+            int k = j;
+            do {
+                cycle->push_back(nodes[k].type);
+                k = *index.find(nodes[k].parent);
+            } while (k != j);
+        }
+        return false;
+    }
+
+    built = true;
+    return true;
+}
+
+bool ClassHierarchy::isBuilt() {
+    return built;
+}
+
+bool ClassHierarchy::isSubclass(TypeId sub, TypeId super) {
+    if (sub == super)
+        return true;
+
+    ClassNode* a = node(sub);
+    ClassNode* b = node(super);
+    if (a == nullptr || b == nullptr || a->pre < 0 || b->pre < 0)
+        return false;
+
+    return b->pre <= a->pre && a->post <= b->post;
+}
+
+// int e string só aceitam o próprio tipo; classes aceitam subclasses; arrays de classes
+// seguem a regra do elemento (covariância, como em Java).
+bool ClassHierarchy::isAssignable(TypeId target, TypeId value) {
+    while (types->isArray(target) && types->isArray(value)) {
+        target = types->elementOf(target);
+        value = types->elementOf(value);
+    }
+
+    if (types->isClass(target) && types->isClass(value))
+        return isSubclass(value, target);
+
+    return target == value;
+}
+
+bool ClassHierarchy::contains(TypeId type) {
+    return node(type) != nullptr;
+}
+
+TypeId ClassHierarchy::parentOf(TypeId type) {
+    ClassNode* n = node(type);
+    return n != nullptr ? n->parent : NO_TYPE;
+}
+
+int ClassHierarchy::depthOf(TypeId type) {
+    ClassNode* n = node(type);
+    return n != nullptr ? n->depth : 0;
+}
+
+int ClassHierarchy::lineOf(TypeId type) {
+    ClassNode* n = node(type);
+    return n != nullptr ? n->line : 0;
+}
+
+size_t ClassHierarchy::size() {
+    return nodes.size();
+}
+
+// Um campo sempre recebe um slot novo; se tiver o nome de um membro herdado, passa a
+// ocultá-lo. Retorna `false` se a classe já declarou um membro com esse nome.
+bool ClassHierarchy::addField(TypeId cls, Atom name, TypeId type, bool isArray, int line) {
+    ClassNode* n = node(cls);
+    if (n == nullptr)
+        return false;
+
+    Member* existing = n->members.find(name);
+    if (existing != nullptr && existing->owner == cls)
+        return false;
+
+    Member m = { type, cls, n->fields++, line, VARIABLE, isArray, 0, 0 };
+    if (existing != nullptr)
+        *existing = m;
+    else
+        n->members.insert(name, m);
+    return true;
+}
+
+// Um método com o nome de um método herdado o sobrescreve e reaproveita a entrada da vtable;
+// caso contrário recebe uma entrada nova.
+bool ClassHierarchy::addMethod(TypeId cls, Atom name, TypeId returnType, bool isArray, int line) {
+    ClassNode* n = node(cls);
+    if (n == nullptr)
+        return false;
+
+    Member* existing = n->members.find(name);
+    if (existing != nullptr && existing->owner == cls)
+        return false;
+
+    int slot = existing != nullptr && existing->kind == METHOD ? existing->slot : n->methods++;
+    Member m = { returnType, cls, slot, line, METHOD, isArray, 0, 0 };
+    if (existing != nullptr)
+        *existing = m;
+    else
+        n->members.insert(name, m);
+    return true;
+}
+
+const ClassHierarchy::Member* ClassHierarchy::findMember(TypeId cls, Atom name) {
+    ClassNode* n = node(cls);
+    return n != nullptr ? n->members.find(name) : nullptr;
+}
+
+bool ClassHierarchy::setParams(TypeId cls, Atom method, const std::vector<TypeId>& types) {
+    ClassNode* n = node(cls);
+    Member* m = n != nullptr ? n->members.find(method) : nullptr;
+    if (m == nullptr || m->kind != METHOD || m->owner != cls)
+        return false;
+
+    m->firstParam = (int) n->params.size();
+    m->paramCount = (int) types.size();
+    n->params.insert(n->params.end(), types.begin(), types.end());
+    return true;
+}
+
+const std::vector<TypeId>& ClassHierarchy::params(TypeId cls) {
+    static const std::vector<TypeId> none;
+    ClassNode* n = node(cls);
+    return n != nullptr ? n->params : none;
+}
+
+int ClassHierarchy::fieldCount(TypeId cls) {
+    ClassNode* n = node(cls);
+    return n != nullptr ? n->fields : 0;
+}
+
+int ClassHierarchy::methodCount(TypeId cls) {
+    ClassNode* n = node(cls);
+    return n != nullptr ? n->methods : 0;
+}
+
+TypeId ClassHierarchy::classAt(size_t i) {
+    return nodes[i].type;
+}
+
+void ClassHierarchy::markImported(TypeId cls) {
+    ClassNode* n = node(cls);
+    if (n != nullptr)
+        n->imported = true;
+}
+
+bool ClassHierarchy::isImported(TypeId cls) {
+    ClassNode* n = node(cls);
+    return n != nullptr && n->imported;
+}
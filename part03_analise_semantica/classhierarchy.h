@@ -0,0 +1,83 @@
+#include "superheader.h"
+
+// A classe `ClassHierarchy` é o índice da árvore de herança das classes declaradas.
+// As classes são registradas à medida que são declaradas e, depois que todas foram vistas,
+// `build()` percorre a árvore em profundidade atribuindo a cada classe um intervalo
+// [pre, post]. Assim, "A é subclasse de B" vira uma comparação de inteiros:
+//     pre(B) <= pre(A) && post(A) <= post(B)
+// A construção também detecta ciclos de `extends`: classes que não são alcançadas a
+// partir de nenhuma raiz pertencem (ou descendem de) um ciclo.
+//
+// Cada classe também tem uma tabela de membros achatada: ao ser registrada, a classe copia
+// a tabela da classe pai e depois recebe os próprios campos e métodos. Resolver `obj.membro`
+// é, portanto, uma única busca na tabela hash da classe, sem subir pela herança.
+class ClassHierarchy {
+public:
+    // Campo ou método visível em uma classe (declarado nela ou herdado).
+    struct Member {
+        TypeId type;      // Tipo do campo ou tipo de retorno do método.
+        TypeId owner;     // Classe que declarou o membro.
+        int slot;         // Campo: posição no objeto; método: entrada na vtable.
+        int line;         // Linha da declaração.
+        SymbolKind kind;  // VARIABLE (campo) ou METHOD.
+        bool isArray;
+        int firstParam;   // Métodos: início dos tipos dos parâmetros em `params(cls)`.
+        int paramCount;   // Métodos: número de parâmetros.
+    };
+
+    ClassHierarchy(TypeTable*);
+
+    void addClass(TypeId type, TypeId parent, int line); // Registra uma classe e sua classe pai.
+    bool build(std::vector<TypeId>* cycle);              // Calcula os intervalos; em caso de ciclo, retorna `false` e preenche `cycle`.
+    bool isBuilt();                                      // Indica se o índice está atualizado.
+
+    bool isSubclass(TypeId sub, TypeId super);           // `sub` é `super` ou descende dele (O(1) após `build`).
+    bool isAssignable(TypeId target, TypeId value);      // Um valor do tipo `value` pode ser atribuído a `target`.
+    bool contains(TypeId type);                          // A classe foi registrada.
+    TypeId parentOf(TypeId type);                        // Classe pai (NO_TYPE se não houver).
+    int depthOf(TypeId type);                            // Profundidade na árvore (raízes têm 0).
+    int lineOf(TypeId type);                             // Linha da declaração.
+    size_t size();                                       // Número de classes registradas.
+
+    bool addField(TypeId cls, Atom name, TypeId type, bool isArray, int line);        // Novo campo (oculta campo herdado).
+    bool addMethod(TypeId cls, Atom name, TypeId returnType, bool isArray, int line); // Novo método (ou sobrescrita).
+    const Member* findMember(TypeId cls, Atom name);     // Membro próprio ou herdado; `nullptr` se não existir.
+    bool setParams(TypeId cls, Atom method, const std::vector<TypeId>& types); // Tipos dos parâmetros de um método próprio.
+    const std::vector<TypeId>& params(TypeId cls);       // Tipos de parâmetros referenciados pelos membros da classe.
+    int fieldCount(TypeId cls);                          // Número de slots de campos (inclui herdados).
+    int methodCount(TypeId cls);                         // Tamanho da vtable (inclui herdados).
+    TypeId classAt(size_t i);                            // i-ésima classe registrada (ordem de declaração).
+    void markImported(TypeId cls);                       // Classe veio de uma interface binária.
+    bool isImported(TypeId cls);
+
+    // Percorre os membros visíveis de uma classe: f(Atom nome, const Member&).
+    template <typename F> void forEachMember(TypeId cls, F f) {
+        ClassNode* n = node(cls);
+        if (n != nullptr)
+            n->members.forEach(f);
+    }
+
+private:
+    struct ClassNode {
+        TypeId type;
+        TypeId parent;
+        int line;
+        int pre;          // Ordem de entrada na busca em profundidade.
+        int post;         // Maior `pre` da subárvore.
+        int depth;
+        int firstChild;   // Índice do primeiro filho (-1 se não houver).
+        int nextSibling;  // Índice do próximo irmão (-1 se não houver).
+        FlatHashMap<Atom, Member> members; // Membros achatados (próprios e herdados).
+        int fields;       // Próximo slot de campo.
+        int methods;      // Próximo slot da vtable.
+        std::vector<TypeId> params; // Tipos dos parâmetros dos métodos (próprios e herdados).
+        bool imported;    // Carregada de uma interface binária.
+    };
+
+    TypeTable* types;
+    std::vector<ClassNode> nodes;
+    FlatHashMap<TypeId, int> index; // Tipo da classe -> posição em `nodes`.
+    bool built;
+
+    ClassNode* node(TypeId);
+};
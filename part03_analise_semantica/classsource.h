@@ -0,0 +1,29 @@
+#include "superheader.h"
+
+// Classe lida de uma interface binária (apenas membros próprios; os herdados vêm da
+// interface da classe pai). As strings apontam diretamente para o arquivo mapeado.
+struct InterfaceMember {
+    std::string_view name;
+    std::string_view type;    // Tipo escrito como em `TypeTable::name` (ex.: "Animal[]").
+    int line;
+    SymbolKind kind;          // VARIABLE (campo) ou METHOD.
+    bool isArray;
+    std::vector<std::string_view> params; // Tipos dos parâmetros (métodos).
+};
+
+struct InterfaceClass {
+    std::string_view name;
+    std::string_view parent;  // Vazio se a classe não herda de nenhuma outra.
+    int line;
+    std::vector<InterfaceMember> members;
+};
+
+// Origem de classes já analisadas, consultada por `SymbolTable::getClass` quando uma classe
+// não foi declarada na compilação atual: uma interface binária (`ModuleInterface`) ou as
+// demais classes de um documento aberto no editor (`DocumentAnalysis`). As strings de
+// `out` precisam continuar válidas até o fim da compilação que fez a busca.
+class ClassSource {
+public:
+    virtual ~ClassSource() {}
+    virtual bool findClass(std::string_view name, InterfaceClass* out) = 0;
+};
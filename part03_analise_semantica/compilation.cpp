@@ -0,0 +1,79 @@
+#include "superheader.h"
+
+// Os contadores de `--stats` são zerados para que reflitam apenas esta compilação.
+Compilation::Compilation(ostream& o, SymbolTable* prelude) {
+    compilerStats = CompilerStats();
+    out = &o;
+    parser = nullptr;
+    xref = nullptr;
+    if (prelude != nullptr) {
+        symbolTable = SymbolTable::withPrelude(prelude);
+    } else {
+        symbolTable = new SymbolTable();
+        symbolTable->initializeKeywords();
+    }
+}
+
+// O parser é destruído antes da tabela raiz porque seus escopos apontam para ela.
+Compilation::~Compilation() {
+    delete parser;
+    delete symbolTable;
+}
+
+SymbolTable* Compilation::createPrelude() {
+    SymbolTable* prelude = new SymbolTable();
+    prelude->initializeKeywords();
+    return prelude;
+}
+
+// Interfaces binárias: apenas mapeadas aqui; as classes são carregadas sob demanda.
+bool Compilation::import(const string& path) {
+    std::shared_ptr<ModuleInterface> module = std::make_shared<ModuleInterface>();
+    if (!module->open(path))
+        return false;
+    import(module);
+    return true;
+}
+
+void Compilation::import(std::shared_ptr<ModuleInterface> module) {
+    symbolTable->modules.push_back(module.get());
+    modules.push_back(module);
+}
+
+void Compilation::import(ClassSource* source) {
+    symbolTable->modules.push_back(source);
+}
+
+void Compilation::setCrossReference(CrossReference* x) {
+    xref = x;
+}
+
+bool Compilation::compile(const string& fileName) {
+    return run(new Parser(fileName, symbolTable, *out));
+}
+
+bool Compilation::compileSource(const string& source, int firstLine) {
+    return run(new Parser(Scanner::fromSource(source, symbolTable, firstLine), symbolTable, *out));
+}
+
+bool Compilation::run(Parser* p) {
+    delete parser;
+    parser = p;
+    parser->setCrossReference(xref);
+    return parser->run();
+}
+
+string Compilation::interfaceData() {
+    PhaseTimer timer(TIME_INTERFACE);
+    TraceSpan span("fase", "interface");
+    return ModuleInterface::serialize(symbolTable);
+}
+
+const std::vector<Diagnostic>& Compilation::diagnostics() {
+    static const std::vector<Diagnostic> none;
+    return parser != nullptr ? parser->getDiagnostics() : none;
+}
+
+SymbolTable* Compilation::getSymbolTable() {
+    return symbolTable;
+}
@@ -0,0 +1,42 @@
+#include "superheader.h"
+
+// A classe `Compilation` é dona de tudo o que uma compilação aloca:
+// - a tabela de símbolos raiz, que por sua vez é dona da arena (onde ficam as entradas e os
+//   nomes), do `Interner`, da `TypeTable` e da `ClassHierarchy`;
+// - o parser, dono do scanner e dos escopos criados durante a análise;
+// - as interfaces importadas, que podem ser compartilhadas com outras compilações.
+// Destruir a compilação libera tudo de uma vez, o que permite compilar repetidamente no
+// mesmo processo sem crescimento de memória.
+//
+// Com um prelúdio (tabela de palavras reservadas congelada, ver `SymbolTable::withPrelude`)
+// a compilação não recria as palavras reservadas nem os seus nomes.
+class Compilation {
+public:
+    Compilation(ostream& out = cout, SymbolTable* prelude = nullptr);
+    ~Compilation();
+
+    bool import(const string& path);                        // Abre uma interface binária; `false` se inválida.
+    void import(std::shared_ptr<ModuleInterface> module);   // Usa uma interface já aberta.
+    void import(ClassSource* source);                       // Outra origem de classes (sem posse).
+    void setCrossReference(CrossReference* xref);           // Registra declarações e usos (sem posse).
+    bool compile(const string& fileName);                   // Analisa o arquivo; `false` se houve erro.
+    bool compileSource(const string& source, int firstLine = 1); // Analisa um texto já carregado.
+    string interfaceData();                                 // Interface binária das classes compiladas.
+    const std::vector<Diagnostic>& diagnostics();           // Erros da última análise.
+    SymbolTable* getSymbolTable();
+
+    // Prelúdio compartilhado: tabela raiz apenas com as palavras reservadas.
+    static SymbolTable* createPrelude();
+
+private:
+    ostream* out;
+    SymbolTable* symbolTable;
+    Parser* parser;
+    CrossReference* xref;
+    std::vector<std::shared_ptr<ModuleInterface>> modules;
+
+    bool run(Parser* p);
+
+    Compilation(const Compilation&);
+    Compilation& operator=(const Compilation&);
+};
@@ -0,0 +1,205 @@
+#include "superheader.h"
+
+namespace fs = std::filesystem;
+
+static const char ENTRY_MAGIC[4] = { 'X', 'P', 'P', 'C' };
+static const uint32_t ENTRY_VERSION = 1;
+static const char* ENTRY_SUFFIX = ".xpc";
+static const char* TEMP_PREFIX = "tmp.";
+static const char* SIZE_FILE = "size"; // Estimativa do total das entradas (texto decimal).
+
+CompilationCache::CompilationCache(const string& d, uint64_t max) {
+    dir = d;
+    maxBytes = max;
+    std::error_code ec;
+    fs::create_directories(dir, ec);
+}
+
+// Cada parte entra com o seu tamanho, para que ("ab", "c") e ("a", "bc") gerem chaves
+// diferentes. Os 128 bits vêm de dois hashes do mesmo material com finais distintos.
+string CompilationCache::key(const std::vector<string>& parts) {
+    string material;
+    for (const string& p : parts) {
+        uint64_t size = p.size();
+        material.append((const char*) &size, sizeof(size));
+        material += p;
+    }
+
+    uint64_t h1 = hashBytes(material.data(), material.size());
+    material.push_back('\x5c');
+    uint64_t h2 = hashBytes(material.data(), material.size());
+
+    char hex[33];
+    snprintf(hex, sizeof(hex), "%016llx%016llx", (unsigned long long) h1, (unsigned long long) h2);
+    return hex;
+}
+
+string CompilationCache::pathOf(const string& key) {
+    return (fs::path(dir) / (key + ENTRY_SUFFIX)).string();
+}
+
+static bool readFile(const string& path, string* data) {
+    ifstream in(path, ios::in | ios::binary);
+    if (!in.is_open())
+        return false;
+    data->assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    return !in.bad();
+}
+
+// Leitor sequencial com verificação de limites: uma entrada truncada ou corrompida é
+// tratada como ausente.
+struct EntryReader {
+    const string& data;
+    size_t pos;
+
+    bool u32(uint32_t* v) {
+        if (pos + 4 > data.size())
+            return false;
+        memcpy(v, data.data() + pos, 4);
+        pos += 4;
+        return true;
+    }
+
+    bool bytes(string* out) {
+        uint32_t size;
+        if (!u32(&size) || pos + size > data.size())
+            return false;
+        out->assign(data, pos, size);
+        pos += size;
+        return true;
+    }
+};
+
+bool CompilationCache::lookup(const string& key, CacheEntry* entry) {
+    string path = pathOf(key);
+    string data;
+    if (!readFile(path, &data))
+        return false;
+
+    EntryReader r = { data, 4 };
+    uint32_t version, status, hasInterface;
+    bool ok = data.size() >= 4 && memcmp(data.data(), ENTRY_MAGIC, 4) == 0 && r.u32(&version) &&
+              version == ENTRY_VERSION && r.u32(&status) && r.bytes(&entry->output) &&
+              r.u32(&hasInterface) && r.bytes(&entry->interfaceData) && r.pos == data.size();
+    if (!ok) {
+        std::error_code ec;
+        fs::remove(path, ec);
+        return false;
+    }
+    entry->status = (int) status;
+    entry->hasInterface = hasInterface != 0;
+
+    // Acesso recente: a data de modificação é a ordem usada pela remoção LRU.
+    std::error_code ec;
+    fs::last_write_time(path, fs::file_time_type::clock::now(), ec);
+    return true;
+}
+
+static void put32(string& buf, uint32_t v) {
+    buf.append((const char*) &v, 4);
+}
+
+bool CompilationCache::store(const string& key, const CacheEntry& entry) {
+    string data(ENTRY_MAGIC, 4);
+    put32(data, ENTRY_VERSION);
+    put32(data, (uint32_t) entry.status);
+    put32(data, (uint32_t) entry.output.size());
+    data += entry.output;
+    put32(data, entry.hasInterface ? 1 : 0);
+    put32(data, (uint32_t) entry.interfaceData.size());
+    data += entry.interfaceData;
+
+    if (!writeAtomically(pathOf(key), data))
+        return false;
+
+    // O total é estimado pela última varredura mais os bytes gravados desde então; o
+    // diretório só é varrido quando a estimativa passa do limite (ou se ela não existe).
+    // Sobrescritas e gravações concorrentes só superestimam o total, antecipando a varredura.
+    string sizeText;
+    uint64_t total = 0;
+    if (readFile((fs::path(dir) / SIZE_FILE).string(), &sizeText))
+        total = strtoull(sizeText.c_str(), nullptr, 10) + data.size();
+    if (sizeText.empty() || total > maxBytes)
+        evict();
+    else
+        writeAtomically((fs::path(dir) / SIZE_FILE).string(), to_string((unsigned long long) total));
+    return true;
+}
+
+// O nome temporário inclui um contador global e o endereço de uma variável local (distinto
+// entre threads) além do relógio, para não colidir entre processos e threads.
+bool CompilationCache::writeAtomically(const string& path, const string& data) {
+    static std::atomic<unsigned long> counter(0);
+    int local;
+    fs::path target(path);
+    string unique = to_string((unsigned long long) std::chrono::steady_clock::now().time_since_epoch().count()) + "." +
+                    to_string((uintptr_t) &local) + "." + to_string(counter++);
+    fs::path temp = target.parent_path() / (TEMP_PREFIX + target.filename().string() + "." + unique);
+
+    {
+        ofstream out(temp, ios::out | ios::binary | ios::trunc);
+        if (!out.is_open())
+            return false;
+        out.write(data.data(), data.size());
+        if (!out.good()) {
+            out.close();
+            std::error_code ec;
+            fs::remove(temp, ec);
+            return false;
+        }
+    }
+
+    std::error_code ec;
+    fs::rename(temp, target, ec);
+    if (ec) {
+        fs::remove(temp, ec);
+        return false;
+    }
+    return true;
+}
+
+// Remove as entradas menos usadas até o total ficar abaixo de 90% do limite (a folga evita
+// uma varredura a cada nova entrada) e grava o total restante como a estimativa de `store`.
+// Temporários abandonados há mais de uma hora também são removidos. Falhas de remoção
+// (entrada em uso em outro processo) são ignoradas.
+void CompilationCache::evict() {
+    struct File {
+        fs::path path;
+        fs::file_time_type time;
+        uint64_t size;
+    };
+    std::vector<File> files;
+    uint64_t total = 0;
+    fs::file_time_type now = fs::file_time_type::clock::now();
+
+    std::error_code ec;
+    for (fs::directory_iterator it(dir, ec), end; !ec && it != end; it.increment(ec)) {
+        string name = it->path().filename().string();
+        std::error_code fileEc;
+        fs::file_time_type time = fs::last_write_time(it->path(), fileEc);
+        uint64_t size = fs::file_size(it->path(), fileEc);
+        if (fileEc)
+            continue;
+
+        if (name.rfind(TEMP_PREFIX, 0) == 0) {
+            if (now - time > std::chrono::hours(1))
+                fs::remove(it->path(), fileEc);
+        } else if (name.size() > 4 && name.compare(name.size() - 4, 4, ENTRY_SUFFIX) == 0) {
+            files.push_back({ it->path(), time, size });
+            total += size;
+        }
+    }
+
+    if (total > maxBytes) {
+        std::sort(files.begin(), files.end(), [](const File& a, const File& b) { return a.time < b.time; });
+        uint64_t target = maxBytes / 10 * 9;
+        for (const File& f : files) {
+            if (total <= target)
+                break;
+            std::error_code removeEc;
+            if (fs::remove(f.path, removeEc))
+                total -= f.size;
+        }
+    }
+    writeAtomically((fs::path(dir) / SIZE_FILE).string(), to_string((unsigned long long) total));
+}
@@ -0,0 +1,44 @@
+#include "superheader.h"
+
+// Resultado de uma compilação guardado no cache: código de saída, mensagens e, se houve
+// `--emit-interface`, o conteúdo da interface gerada.
+struct CacheEntry {
+    int status;
+    string output;
+    bool hasInterface;
+    string interfaceData;
+
+    CacheEntry() : status(0), hasInterface(false) {}
+};
+
+// A classe `CompilationCache` é um cache local de resultados endereçado por conteúdo.
+// A chave (128 bits, em hexadecimal) é o hash de tudo o que determina o resultado: versão
+// do compilador, opções, conteúdo das interfaces importadas e bytes do fonte. Em um acerto,
+// a análise léxica, sintática e semântica não é executada.
+//
+// Cada entrada é um arquivo `<chave>.xpc` no diretório do cache:
+//   "XPPC" | versão | código de saída | {tamanho, saída} | possui interface | {tamanho, interface}
+// Entradas são escritas em um arquivo temporário e renomeadas, então processos concorrentes
+// nunca leem uma entrada parcial. O tamanho total é limitado por LRU: um acerto atualiza a
+// data de modificação da entrada e as mais antigas são removidas quando o limite é excedido.
+// O arquivo `size` guarda uma estimativa do total, para que o diretório só seja varrido
+// quando ela passar do limite.
+class CompilationCache {
+public:
+    CompilationCache(const string& dir, uint64_t maxBytes);
+
+    static string key(const std::vector<string>& parts); // Chave das partes (com seus tamanhos).
+
+    bool lookup(const string& key, CacheEntry* entry);    // `false` se ausente ou inválida.
+    bool store(const string& key, const CacheEntry& entry);
+    void evict();                                         // Aplica o limite de tamanho (LRU).
+
+    // Escreve `data` em `path` por arquivo temporário + rename (nunca deixa o arquivo parcial).
+    static bool writeAtomically(const string& path, const string& data);
+
+private:
+    string dir;
+    uint64_t maxBytes;
+
+    string pathOf(const string& key);
+};
@@ -0,0 +1,26 @@
+#include "superheader.h"
+
+void CrossReference::clear() {
+    occurrences.clear();
+    declarations.clear();
+}
+
+void CrossReference::add(const Occurrence& occurrence) {
+    occurrences.push_back(occurrence);
+}
+
+const std::vector<Occurrence>& CrossReference::all() {
+    return occurrences;
+}
+
+// As entradas vivem na arena da compilação, então o endereço identifica a declaração até o
+// fim da análise.
+void CrossReference::declare(const STEntry* entry, const Occurrence& declaration) {
+    declarations[entry] = occurrences.size();
+    occurrences.push_back(declaration);
+}
+
+const Occurrence* CrossReference::declarationOf(const STEntry* entry) {
+    auto found = declarations.find(entry);
+    return found != declarations.end() ? &occurrences[found->second] : nullptr;
+}
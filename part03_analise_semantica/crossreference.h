@@ -0,0 +1,34 @@
+#include "superheader.h"
+
+// Ocorrência de um identificador no fonte: a declaração de um símbolo ou um uso dele.
+struct Occurrence {
+    int line;           // Posição do identificador (linha e coluna a partir de 1).
+    int column;
+    int length;
+    bool declaration;
+    SymbolKind kind;    // CLASS_NAME, VARIABLE, PARAMETER ou METHOD.
+    bool field;         // VARIABLE: campo de classe (senão, variável local).
+    string name;
+    string owner;       // Classe que declara o símbolo; locais e parâmetros: a classe do método.
+    string type;        // Tipo (métodos: retorno; classes: a classe pai, ou vazio).
+    int declLine;       // Declaração de locais e parâmetros (0 para classes e membros, que são
+    int declColumn;     // localizados por `owner` e `name`).
+};
+
+// A classe `CrossReference` registra as declarações e os usos de identificadores durante a
+// análise (`Parser::setCrossReference`). O parser só registra quando há um registro ligado,
+// então a compilação comum não paga nada por isso.
+class CrossReference {
+public:
+    void clear();
+    void add(const Occurrence& occurrence);
+    const std::vector<Occurrence>& all();
+
+    // Declarações de locais, parâmetros e membros da compilação, para completar os usos.
+    void declare(const STEntry* entry, const Occurrence& declaration);
+    const Occurrence* declarationOf(const STEntry* entry); // `nullptr` se não foi registrada.
+
+private:
+    std::vector<Occurrence> occurrences;
+    std::unordered_map<const STEntry*, size_t> declarations; // Entrada -> posição em `occurrences`.
+};
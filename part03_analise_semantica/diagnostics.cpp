@@ -0,0 +1,200 @@
+#include "superheader.h"
+#include <charconv>
+
+// Erros de análise: "\n[ERRO FASE] Linha N: mensagem\n"; erros do driver: a mensagem.
+static void appendHuman(string& out, const Diagnostic& d) {
+    if (d.phase != PHASE_DRIVER) {
+        out += "\n[ERRO ";
+        out += DiagnosticWriter::phaseName(d.phase);
+        out += "] Linha ";
+        out += to_string(d.line);
+        out += ": ";
+    }
+    out += d.message;
+    out += '\n';
+}
+
+// `what()`: a mensagem de sempre, sem a quebra de linha final.
+static string errorText(const Diagnostic& d) {
+    string text;
+    appendHuman(text, d);
+    text.pop_back();
+    return text;
+}
+
+CompileError::CompileError(const Diagnostic& diagnostic) : runtime_error(errorText(diagnostic)), d(diagnostic) {}
+
+const Diagnostic& CompileError::diagnostic() const {
+    return d;
+}
+
+DiagnosticWriter::DiagnosticWriter(DiagnosticFormat f) {
+    format = f;
+}
+
+bool DiagnosticWriter::parseFormat(const string& name, DiagnosticFormat* f) {
+    if (name == "human")
+        *f = FORMAT_HUMAN;
+    else if (name == "json")
+        *f = FORMAT_JSON;
+    else if (name == "sarif")
+        *f = FORMAT_SARIF;
+    else
+        return false;
+    return true;
+}
+
+const char* DiagnosticWriter::phaseName(DiagnosticPhase phase) {
+    switch (phase) {
+    case PHASE_LEXICAL: return "LEXICO";
+    case PHASE_SYNTAX: return "SINTATICO";
+    case PHASE_SEMANTIC: return "SEMANTICO";
+    default: return "";
+    }
+}
+
+static const char* jsonPhase(DiagnosticPhase phase) {
+    switch (phase) {
+    case PHASE_LEXICAL: return "lexical";
+    case PHASE_SYNTAX: return "syntax";
+    case PHASE_SEMANTIC: return "semantic";
+    default: return "driver";
+    }
+}
+
+static const char* jsonSeverity(DiagnosticSeverity severity) {
+    switch (severity) {
+    case SEVERITY_WARNING: return "warning";
+    case SEVERITY_NOTE: return "note";
+    default: return "error";
+    }
+}
+
+// Escreve a string entre aspas, com os escapes do JSON, no fim de `out`. Os trechos sem
+// caracteres especiais (quase sempre a mensagem inteira) são copiados de uma vez.
+void appendJson(string& out, std::string_view s) {
+    static const char* hex = "0123456789abcdef";
+    out += '"';
+    size_t run = 0;
+    for (size_t i = 0; i < s.size(); i++) {
+        unsigned char c = (unsigned char) s[i];
+        if (c >= 0x20 && c != '"' && c != '\\')
+            continue;
+        out.append(s.data() + run, i - run);
+        run = i + 1;
+        switch (c) {
+        case '"': out += "\\\""; break;
+        case '\\': out += "\\\\"; break;
+        case '\n': out += "\\n"; break;
+        case '\r': out += "\\r"; break;
+        case '\t': out += "\\t"; break;
+        default:
+            out += "\\u00";
+            out += hex[c >> 4];
+            out += hex[c & 15];
+        }
+    }
+    out.append(s.data() + run, s.size() - run);
+    out += '"';
+}
+
+static void appendUnsigned(string& out, size_t value) {
+    char buf[24];
+    out.append(buf, std::to_chars(buf, buf + sizeof(buf), value).ptr - buf);
+}
+
+static void appendNumber(string& out, const char* key, size_t value) {
+    out += ",\"";
+    out += key;
+    out += "\":";
+    appendUnsigned(out, value);
+}
+
+string DiagnosticWriter::human(const Diagnostic& d) {
+    string text;
+    appendHuman(text, d);
+    return text;
+}
+
+void DiagnosticWriter::write(const Diagnostic& d) {
+    AllocationScope allocations(ALLOC_DIAGNOSTICS);
+    switch (format) {
+    case FORMAT_HUMAN:
+        appendHuman(buffer, d);
+        break;
+
+    case FORMAT_JSON:
+        buffer += "{\"severity\":\"";
+        buffer += jsonSeverity(d.severity);
+        buffer += "\",\"phase\":\"";
+        buffer += jsonPhase(d.phase);
+        buffer += "\",\"file\":";
+        appendJson(buffer, d.file);
+        appendNumber(buffer, "line", d.line);
+        appendNumber(buffer, "column", d.column);
+        appendNumber(buffer, "offset", d.offset);
+        appendNumber(buffer, "length", d.length);
+        buffer += ",\"message\":";
+        appendJson(buffer, d.message);
+        buffer += "}\n";
+        break;
+
+    case FORMAT_SARIF:
+        // Um `result` por diagnóstico; a região só tem os campos conhecidos.
+        if (!buffer.empty())
+            buffer += ",";
+        buffer += "{\"ruleId\":\"";
+        buffer += jsonPhase(d.phase);
+        buffer += "\",\"level\":\"";
+        buffer += jsonSeverity(d.severity);
+        buffer += "\",\"message\":{\"text\":";
+        appendJson(buffer, d.message);
+        buffer += "}";
+        if (!d.file.empty()) {
+            buffer += ",\"locations\":[{\"physicalLocation\":{\"artifactLocation\":{\"uri\":";
+            appendJson(buffer, d.file);
+            buffer += "}";
+            if (d.line > 0) {
+                buffer += ",\"region\":{\"startLine\":";
+                appendUnsigned(buffer, d.line);
+                if (d.column > 0)
+                    appendNumber(buffer, "startColumn", d.column);
+                if (d.length > 0) {
+                    appendNumber(buffer, "charOffset", d.offset);
+                    appendNumber(buffer, "charLength", d.length);
+                }
+                buffer += "}";
+            }
+            buffer += "}}]";
+        }
+        buffer += "}";
+        break;
+    }
+}
+
+void DiagnosticWriter::text(std::string_view t) {
+    if (format == FORMAT_HUMAN)
+        buffer.append(t.data(), t.size());
+}
+
+void DiagnosticWriter::append(const string& body) {
+    if (format == FORMAT_SARIF && !buffer.empty() && !body.empty())
+        buffer += ",";
+    buffer += body;
+}
+
+const string& DiagnosticWriter::body() {
+    return buffer;
+}
+
+string DiagnosticWriter::finish() {
+    if (format != FORMAT_SARIF)
+        return buffer;
+    string doc = "{\"version\":\"2.1.0\",\"$schema\":\"https://json.schemastore.org/sarif-2.1.0.json\","
+                 "\"runs\":[{\"tool\":{\"driver\":{\"name\":\"xpp_compiler\",\"fullName\":";
+    appendJson(doc, COMPILER_VERSION);
+    doc += "}},\"results\":[";
+    doc += buffer;
+    doc += "]}]}\n";
+    return doc;
+}
@@ -0,0 +1,74 @@
+#include "superheader.h"
+
+enum DiagnosticSeverity : uint8_t {
+    SEVERITY_ERROR,
+    SEVERITY_WARNING,
+    SEVERITY_NOTE
+};
+
+enum DiagnosticPhase : uint8_t {
+    PHASE_LEXICAL,
+    PHASE_SYNTAX,
+    PHASE_SEMANTIC,
+    PHASE_DRIVER        // Entradas e saídas do compilador (interfaces, índice, arquivos).
+};
+
+// Mensagem do compilador com a sua posição no fonte.
+struct Diagnostic {
+    DiagnosticSeverity severity;
+    DiagnosticPhase phase;
+    string file;        // Vazio: o arquivo da compilação.
+    int line;           // Linha e coluna a partir de 1; coluna 0 quando a posição é só a linha.
+    int column;
+    size_t offset;      // Intervalo em bytes no texto analisado (`length` 0: desconhecido).
+    size_t length;
+    string message;
+
+    Diagnostic() : severity(SEVERITY_ERROR), phase(PHASE_DRIVER), line(0), column(0), offset(0), length(0) {}
+};
+
+// Erro que interrompe a análise (léxico, sintático ou semântico). `what()` é a mensagem no
+// formato de sempre, então quem só trata `runtime_error` continua funcionando.
+class CompileError : public runtime_error {
+public:
+    explicit CompileError(const Diagnostic& diagnostic);
+    const Diagnostic& diagnostic() const;
+
+private:
+    Diagnostic d;
+};
+
+enum DiagnosticFormat : uint8_t {
+    FORMAT_HUMAN,       // "[ERRO SEMANTICO] Linha N: ..." (a saída de sempre)
+    FORMAT_JSON,        // Um objeto JSON por linha.
+    FORMAT_SARIF        // Um documento SARIF 2.1.0.
+};
+
+// Escreve `s` entre aspas, com os escapes do JSON, no fim de `out`.
+void appendJson(string& out, std::string_view s);
+
+// A classe `DiagnosticWriter` escreve diagnósticos em um único buffer, no formato pedido,
+// que é entregue de uma vez (`finish`) em vez de uma escrita com flush por mensagem. O texto
+// de cada diagnóstico é montado direto no buffer, sem streams intermediários, para que um
+// lote com milhares de mensagens custe apenas o tamanho da saída.
+//
+// O corpo (`body`) pode ser guardado, por exemplo no cache de resultados, e retomado por
+// outro escritor do mesmo formato (`append`), que completa o documento.
+class DiagnosticWriter {
+public:
+    explicit DiagnosticWriter(DiagnosticFormat format = FORMAT_HUMAN);
+
+    static bool parseFormat(const string& name, DiagnosticFormat* format);
+    static string human(const Diagnostic& diagnostic);  // Texto do formato humano.
+    static const char* phaseName(DiagnosticPhase phase); // "LEXICO", "SINTATICO", ...
+
+    void write(const Diagnostic& diagnostic);
+    void text(std::string_view text);   // Só no formato humano (mensagens de sucesso, `--stats`).
+    void append(const string& body);    // Corpo já escrito no mesmo formato.
+    const string& body();
+    string finish();                    // Corpo com o início e o fim do documento (SARIF).
+
+private:
+    DiagnosticFormat format;
+    string buffer;
+};
@@ -0,0 +1,413 @@
+#include "superheader.h"
+
+// Primeiro erro da análise. Erros em outro arquivo (importado) aparecem na linha 1, com a
+// posição original na mensagem.
+static bool firstError(const std::vector<Diagnostic>& diagnostics, const string& path, DocumentDiagnostic* d) {
+    if (diagnostics.empty())
+        return false;
+
+    const Diagnostic& e = diagnostics[0];
+    d->phase = DiagnosticWriter::phaseName(e.phase);
+    d->line = e.line;
+    d->message = e.message;
+    if (!e.file.empty() && e.file != path) {
+        d->message = e.file + ", linha " + to_string(e.line) + ": " + e.message;
+        d->line = 1;
+    }
+    return true;
+}
+
+DocumentAnalysis::DocumentAnalysis(SymbolTable* p) {
+    ownsPrelude = p == nullptr;
+    prelude = ownsPrelude ? Compilation::createPrelude() : p;
+    outlined = false;
+    analyzing = 0;
+    wholeDirty = true;
+    whole.line = whole.analyzedLine = 1;
+    whole.failed = false;
+}
+
+DocumentAnalysis::~DocumentAnalysis() {
+    units.clear();
+    if (ownsPrelude)
+        delete prelude;
+}
+
+void DocumentAnalysis::setPath(const string& p) {
+    path = p;
+}
+
+void DocumentAnalysis::setText(const string& text) {
+    source = text;
+    outline();
+}
+
+const string& DocumentAnalysis::text() {
+    return source;
+}
+
+size_t DocumentAnalysis::classCount() {
+    return units.size();
+}
+
+// A busca começa na classe mais próxima antes da linha pedida, e não no início do texto.
+size_t DocumentAnalysis::offsetOf(int line, int column) {
+    size_t offset = 0;
+    int current = 1;
+    Unit* unit = outlined ? unitAt(line) : nullptr;
+    if (unit != nullptr) {
+        offset = unit->start;
+        while (offset > 0 && source[offset - 1] != '\n')
+            offset--;
+        current = unit->line;
+    }
+    while (current < line && offset < source.size()) {
+        const char* next = (const char*) memchr(source.data() + offset, '\n', source.size() - offset);
+        if (next == nullptr)
+            return source.size();
+        offset = next - source.data() + 1;
+        current++;
+    }
+    for (int c = 1; c < column && offset < source.size() && source[offset] != '\n'; c++)
+        offset++;
+    return offset;
+}
+
+// Uma edição estritamente dentro de uma classe reesboça só o trecho até a classe seguinte;
+// se o trecho continuar sendo exatamente essa classe, as seguintes apenas se deslocam.
+void DocumentAnalysis::replace(size_t offset, size_t length, const string& text) {
+    offset = std::min(offset, source.size());
+    length = std::min(length, source.size() - offset);
+    int lines = (int) std::count(text.begin(), text.end(), '\n')
+              - (int) std::count(source.begin() + offset, source.begin() + offset + length, '\n');
+    size_t oldSize = source.size();
+    long delta = (long) text.size() - (long) length;
+    source.replace(offset, length, text);
+
+    if (!outlined) {
+        outline();
+        return;
+    }
+
+    size_t k = std::upper_bound(units.begin(), units.end(), offset,
+                                [](size_t o, const Unit& u) { return o < u.start; }) - units.begin();
+    if (k > 0 && offset > units[k - 1].start && offset + length < units[k - 1].end) {
+        Unit& u = units[k - 1];
+        size_t regionEnd = (k < units.size() ? units[k].start : oldSize) + delta;
+        Outline region;
+        if (region.scan(source.substr(u.start, regionEnd - u.start)) && region.imports.empty()
+            && region.classes.size() == 1 && region.classes[0].name == u.name) {
+            const OutlineClass& c = region.classes[0];
+            u.end = u.start + c.end;
+            u.parent = c.parent;
+            u.deps = c.deps;
+            indexDependents(k - 1);
+            if (c.hash != u.hash) {
+                u.hash = c.hash;
+                u.dirty = true;
+            }
+            for (size_t j = k; j < units.size(); j++) {
+                units[j].start += delta;
+                units[j].end += delta;
+                units[j].line += lines;
+            }
+            return;
+        }
+    }
+    outline();
+}
+
+// Reesboço completo. Classes com o mesmo nome e o mesmo texto mantêm o resultado anterior;
+// as que surgiram ou sumiram afetam as que dependem do nome delas.
+void DocumentAnalysis::outline() {
+    Outline o;
+    bool ok = o.scan(source);
+    if (!ok || !o.imports.empty() || o.classes.empty()) {
+        outlined = false;
+        wholeDirty = true;
+        units.clear();
+        byName.clear();
+        dependents.clear();
+        changedNames.clear();
+        return;
+    }
+
+    std::unordered_map<string, std::vector<size_t>> previous;
+    for (size_t i = units.size(); i-- > 0; )
+        previous[units[i].name + '\0' + to_string(units[i].hash)].push_back(i);
+    std::vector<bool> reused(units.size(), false);
+
+    std::vector<Unit> next;
+    next.reserve(o.classes.size());
+    size_t last = 0;
+    bool reordered = false;
+    for (OutlineClass& c : o.classes) {
+        auto found = previous.find(c.name + '\0' + to_string(c.hash));
+        if (found != previous.end() && !found->second.empty()) {
+            size_t i = found->second.back();
+            found->second.pop_back();
+            reordered = reordered || (!next.empty() && i < last);
+            last = i;
+            reused[i] = true;
+            next.push_back(std::move(units[i]));
+        } else {
+            next.push_back(Unit());
+            Unit& u = next.back();
+            u.hash = c.hash;
+            u.name = c.name;
+            u.dirty = true;
+            u.parentChanged = false;
+            u.failed = false;
+            u.analyzedLine = c.line;
+            changedNames.push_back(c.name);
+        }
+        Unit& u = next.back();
+        u.start = c.start;
+        u.end = c.end;
+        u.line = c.line;
+        u.parent = c.parent;
+        u.deps.swap(c.deps);
+    }
+    for (size_t i = 0; i < units.size(); i++)
+        if (!reused[i])
+            changedNames.push_back(units[i].name);
+
+    units.swap(next);
+    outlined = true;
+    byName.clear();
+    dependents.clear();
+    for (size_t i = 0; i < units.size(); i++) {
+        byName[units[i].name].push_back(i);
+        indexDependents(i);
+        units[i].dirty = units[i].dirty || reordered;
+    }
+}
+
+// As listas ficam em ordem crescente; uma classe reesboçada só acrescenta os nomes novos.
+void DocumentAnalysis::indexDependents(size_t index) {
+    const Unit& u = units[index];
+    auto add = [&](const string& name) {
+        std::vector<size_t>& list = dependents[name];
+        auto at = std::lower_bound(list.begin(), list.end(), index);
+        if (at == list.end() || *at != index)
+            list.insert(at, index);
+    };
+    add(u.name);
+    for (const string& dep : u.deps)
+        add(dep);
+}
+
+// Classes a partir de `from` que dependem de `name` ou que têm o mesmo nome.
+void DocumentAnalysis::markDependents(const string& name, size_t from) {
+    auto found = dependents.find(name);
+    if (found == dependents.end())
+        return;
+    for (auto j = std::lower_bound(found->second.begin(), found->second.end(), from); j != found->second.end(); ++j) {
+        Unit& d = units[*j];
+        if (d.name == name || std::binary_search(d.deps.begin(), d.deps.end(), name)) {
+            d.dirty = true;
+            d.parentChanged = d.parentChanged || d.parent == name;
+        }
+    }
+}
+
+size_t DocumentAnalysis::analyze() {
+    if (!outlined) {
+        if (!wholeDirty)
+            return 0;
+        analyzeWhole();
+        return 1;
+    }
+
+    // Uma passada só, mesmo quando todas as classes são novas (documento recém-aberto).
+    if (!changedNames.empty()) {
+        std::unordered_set<string> changed(changedNames.begin(), changedNames.end());
+        for (Unit& d : units) {
+            bool depends = changed.count(d.name) > 0;
+            for (size_t k = 0; k < d.deps.size() && !depends; k++)
+                depends = changed.count(d.deps[k]) > 0;
+            d.dirty = d.dirty || depends;
+            d.parentChanged = d.parentChanged || (!d.parent.empty() && changed.count(d.parent) > 0);
+        }
+        changedNames.clear();
+    }
+
+    size_t count = 0;
+    for (size_t i = 0; i < units.size(); i++) {
+        if (units[i].dirty) {
+            analyzeUnit(i);
+            count++;
+        }
+    }
+    return count;
+}
+
+// A classe é compilada sozinha, numerada a partir da sua linha para que as mensagens e as
+// ocorrências tenham as linhas do documento.
+void DocumentAnalysis::analyzeUnit(size_t index) {
+    Unit& u = units[index];
+    string text = source.substr(u.start, u.end - u.start);
+
+    CrossReference xref;
+    std::ostringstream out;
+    string interface;
+    std::vector<Diagnostic> errors;
+    bool ok;
+    analyzing = index;
+    {
+        Compilation compilation(out, prelude);
+        compilation.import(this);
+        compilation.setCrossReference(&xref);
+        ok = compilation.compileSource(text, u.line);
+        if (ok)
+            interface = compilation.interfaceData();
+        else
+            errors = compilation.diagnostics();
+    }
+
+    u.dirty = false;
+    u.failed = firstError(errors, path, &u.error);
+    u.analyzedLine = u.line;
+    u.occurrences = xref.all();
+
+    // Uma classe com erro mantém a última interface válida para as seguintes.
+    bool changed = u.parentChanged;
+    u.parentChanged = false;
+    if (ok) {
+        std::shared_ptr<ModuleInterface> module = std::make_shared<ModuleInterface>();
+        module->openBuffer(u.name, interface);
+        string signature = module->signatureOf(u.name);
+        changed = changed || u.module == nullptr || signature != u.signature;
+        u.module = module;
+        u.signature = signature;
+    }
+    if (changed)
+        markDependents(u.name, index + 1);
+}
+
+void DocumentAnalysis::analyzeWhole() {
+    CrossReference xref;
+    std::ostringstream out;
+    Outline imports;
+    imports.scanImports(source);
+    std::vector<Diagnostic> errors;
+    if (!imports.imports.empty() && !path.empty()) {
+        ProgramBuild build(1, prelude);
+        if (!build.compile(path, source, out))
+            errors = build.diagnostics();
+    } else {
+        Compilation compilation(out, prelude);
+        compilation.setCrossReference(&xref);
+        if (!compilation.compileSource(source))
+            errors = compilation.diagnostics();
+    }
+    wholeDirty = false;
+    whole.failed = firstError(errors, path, &whole.error);
+    whole.occurrences = xref.all();
+}
+
+std::vector<DocumentDiagnostic> DocumentAnalysis::diagnostics() {
+    std::vector<DocumentDiagnostic> all;
+    if (!outlined) {
+        if (whole.failed)
+            all.push_back(whole.error);
+        return all;
+    }
+    for (const Unit& u : units) {
+        if (u.failed) {
+            all.push_back(u.error);
+            all.back().line += u.line - u.analyzedLine;
+        }
+    }
+    return all;
+}
+
+// Última classe que começa na linha `line` ou antes dela.
+DocumentAnalysis::Unit* DocumentAnalysis::unitAt(int line) {
+    size_t k = std::upper_bound(units.begin(), units.end(), line,
+                                [](int l, const Unit& u) { return l < u.line; }) - units.begin();
+    return k > 0 ? &units[k - 1] : nullptr;
+}
+
+Occurrence DocumentAnalysis::shifted(const Unit& unit, const Occurrence& occurrence) {
+    Occurrence o = occurrence;
+    int delta = unit.line - unit.analyzedLine;
+    o.line += delta;
+    if (o.declLine != 0)
+        o.declLine += delta;
+    return o;
+}
+
+bool DocumentAnalysis::occurrenceAt(int line, int column, Occurrence* out) {
+    Unit* unit = outlined ? unitAt(line) : &whole;
+    if (unit == nullptr)
+        return false;
+    int delta = unit->line - unit->analyzedLine;
+    for (const Occurrence& o : unit->occurrences) {
+        if (o.line + delta == line && column >= o.column && column < o.column + o.length) {
+            *out = shifted(*unit, o);
+            return true;
+        }
+    }
+    return false;
+}
+
+// Locais e parâmetros já trazem a posição; classes e membros são procurados entre as
+// declarações da classe dona.
+bool DocumentAnalysis::definitionOf(const Occurrence& occurrence, int* line, int* column) {
+    if (occurrence.declLine != 0) {
+        *line = occurrence.declLine;
+        *column = occurrence.declColumn;
+        return true;
+    }
+
+    std::vector<Unit*> owners;
+    if (!outlined) {
+        owners.push_back(&whole);
+    } else {
+        auto found = byName.find(occurrence.owner);
+        if (found != byName.end())
+            owners.push_back(&units[found->second.front()]);
+    }
+    for (Unit* unit : owners) {
+        for (const Occurrence& d : unit->occurrences) {
+            if (!d.declaration || d.name != occurrence.name || d.owner != occurrence.owner)
+                continue;
+            bool same = occurrence.kind == CLASS_NAME ? d.kind == CLASS_NAME
+                      : occurrence.kind == METHOD ? d.kind == METHOD
+                      : d.field;
+            if (same) {
+                *line = d.line + unit->line - unit->analyzedLine;
+                *column = d.column;
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+// Cada classe vê apenas as declaradas antes dela. Uma classe que ainda não teve uma análise
+// válida aparece só com o nome e a classe pai, para não repetir o erro dela nas seguintes.
+bool DocumentAnalysis::findClass(std::string_view name, InterfaceClass* out) {
+    auto found = byName.find(string(name));
+    if (found == byName.end())
+        return false;
+    for (size_t j : found->second) {
+        if (j >= analyzing)
+            break;
+        Unit& d = units[j];
+        if (d.module != nullptr && d.module->findClass(name, out)) {
+            int delta = d.line - d.analyzedLine;
+            out->line += delta;
+            for (InterfaceMember& m : out->members)
+                m.line += delta;
+        } else {
+            out->name = d.name;
+            out->parent = d.parent;
+            out->line = d.line;
+            out->members.clear();
+        }
+        return true;
+    }
+    return false;
+}
@@ -0,0 +1,90 @@
+#include "superheader.h"
+
+// Erro de uma análise (cada análise para no primeiro erro, como o compilador).
+struct DocumentDiagnostic {
+    int line;
+    string phase;             // "LEXICO", "SINTATICO" ou "SEMANTICO".
+    string message;
+};
+
+// A classe `DocumentAnalysis` mantém a análise de um documento aberto no editor (servidor de
+// linguagem, `tools/xpp_lsp.cpp`), refeita a cada edição apenas onde o texto mudou.
+//
+// O documento é dividido pelo `Outline` em classes, e cada classe é analisada sozinha, como
+// uma compilação que vê as classes anteriores do documento (uma classe só pode ser usada
+// depois de declarada) através da última interface válida de cada uma (`ClassSource`). O
+// resultado de cada classe (erro, ocorrências dos identificadores e interface) fica guardado
+// com a linha em que a classe estava; quando uma edição desloca a classe, as linhas são
+// corrigidas na consulta, sem reanalisar.
+//
+// Uma edição dentro de uma classe reesboça apenas o trecho dela. A classe é reanalisada se o
+// texto mudou; as classes seguintes que dependem dela (mesmas dependências do `Outline`, ou
+// o mesmo nome) só são reanalisadas se a interface dela mudou (ignorando as linhas), o que
+// não acontece em edições no corpo de um método. Edições que alteram a divisão em classes
+// reesboçam o documento inteiro, reaproveitando as classes cujo texto não mudou.
+//
+// Documentos que o `Outline` não consegue dividir, ou que importam outros arquivos, são
+// analisados inteiros a cada alteração.
+class DocumentAnalysis : public ClassSource {
+public:
+    DocumentAnalysis(SymbolTable* prelude = nullptr);
+    ~DocumentAnalysis();
+
+    void setPath(const string& path);   // Caminho do documento (resolve as importações).
+    void setText(const string& text);
+    void replace(size_t offset, size_t length, const string& text);
+    size_t offsetOf(int line, int column); // Linha e coluna a partir de 1.
+    const string& text();
+
+    size_t analyze();                   // Reanalisa o que mudou; retorna o nº de análises.
+    std::vector<DocumentDiagnostic> diagnostics();
+    bool occurrenceAt(int line, int column, Occurrence* out); // Linhas atuais do documento.
+    bool definitionOf(const Occurrence& occurrence, int* line, int* column);
+    size_t classCount();
+
+    // Classes declaradas antes da classe em análise.
+    bool findClass(std::string_view name, InterfaceClass* out) override;
+
+private:
+    struct Unit {
+        size_t start, end;            // Intervalo da classe no texto.
+        int line;                     // Linha atual da palavra `class`.
+        string name;
+        string parent;
+        uint64_t hash;
+        std::vector<string> deps;
+        bool dirty;
+        bool parentChanged;           // A classe pai mudou de interface.
+
+        bool failed;                  // Resultado da última análise.
+        int analyzedLine;             // Linha da classe na última análise.
+        DocumentDiagnostic error;
+        std::vector<Occurrence> occurrences;
+        std::shared_ptr<ModuleInterface> module; // Última interface válida.
+        string signature;             // Interface sem as linhas.
+    };
+
+    SymbolTable* prelude;
+    bool ownsPrelude;
+    string path;
+    string source;
+    bool outlined;                    // `false`: o documento é analisado inteiro.
+    std::vector<Unit> units;
+    std::unordered_map<string, std::vector<size_t>> byName;
+    std::unordered_map<string, std::vector<size_t>> dependents; // Nome -> classes que o usam.
+    std::vector<string> changedNames; // Classes que surgiram ou sumiram desde a última análise.
+    size_t analyzing;                 // Classe em análise (só as anteriores são visíveis).
+    Unit whole;                       // Resultado do documento inteiro (sem `outlined`).
+    bool wholeDirty;
+
+    void outline();
+    void analyzeUnit(size_t index);
+    void analyzeWhole();
+    void markDependents(const string& name, size_t from);
+    void indexDependents(size_t index);
+    Unit* unitAt(int line);
+    Occurrence shifted(const Unit& unit, const Occurrence& occurrence);
+
+    DocumentAnalysis(const DocumentAnalysis&);
+    DocumentAnalysis& operator=(const DocumentAnalysis&);
+};
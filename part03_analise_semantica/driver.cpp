@@ -0,0 +1,390 @@
+#include "superheader.h"
+
+bool parseOptions(const std::vector<string>& args, CompilerOptions* options) {
+    for (size_t i = 0; i < args.size(); i++) {
+        const string& arg = args[i];
+        if (arg == "--stats")
+            options->showStats = true;
+        else if (arg == "--time-report")
+            options->timeReport = true;
+        else if (arg == "--trace" && i + 1 < args.size())
+            options->traceOut = args[++i];
+        else if (arg == "--perf-counters")
+            options->perfCounters = true;
+        else if (arg == "--alloc-report")
+            options->allocReport = true;
+        else if (arg == "--perf-counters-json" && i + 1 < args.size())
+            options->perfJson = args[++i];
+        else if (arg == "--import" && i + 1 < args.size())
+            options->imports.push_back(args[++i]);
+        else if (arg == "--emit-interface" && i + 1 < args.size())
+            options->interfaceOut = args[++i];
+        else if (arg == "--emit-xref" && i + 1 < args.size())
+            options->xrefOut = args[++i];
+        else if (arg == "--diagnostics-format" && i + 1 < args.size()) {
+            if (!DiagnosticWriter::parseFormat(args[++i], &options->format))
+                return false;
+        }
+        else if (arg == "-j" && i + 1 < args.size())
+            options->jobs = strtoul(args[++i].c_str(), nullptr, 10);
+        else if (arg == "--incremental" && i + 1 < args.size())
+            options->incrementalState = args[++i];
+        else if (arg == "--cache-dir" && i + 1 < args.size())
+            options->cacheDir = args[++i];
+        else if (arg == "--cache-max-mb" && i + 1 < args.size())
+            options->cacheMaxMB = strtoull(args[++i].c_str(), nullptr, 10);
+        else if (arg.rfind("--", 0) == 0 || !options->fileName.empty())
+            return false; // Opcao desconhecida ou mais de um arquivo.
+        else
+            options->fileName = arg;
+    }
+    return !options->fileName.empty();
+}
+
+void printUsage(ostream& out) {
+    out << "Uso: ./xpp_compiler [--stats] [--time-report] [--trace saida.json] [--perf-counters] [--perf-counters-json saida.json] [--alloc-report] [--import arquivo.xpi]... [--emit-interface saida.xpi]"
+           " [--emit-xref indice.xpx] [--diagnostics-format human|json|sarif] [--incremental estado] [--cache-dir diretorio [--cache-max-mb N]] [-j threads] nome_arquivo.xpp\n";
+}
+
+static bool readFile(const string& path, string* data) {
+    PhaseTimer timer(TIME_READ);
+    TraceSpan span("fase", "leitura");
+    ifstream in(path, ios::in | ios::binary);
+    XPP_PROBE2(file__open, path.c_str(), in.is_open());
+    if (!in.is_open())
+        return false;
+    data->assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    return !in.bad();
+}
+
+// Tudo o que, além do fonte, determina o resultado: versões do compilador e da análise e
+// conteúdo das interfaces importadas. `false` se alguma interface não puder ser lida.
+static bool environmentParts(const CompilerOptions& options, std::vector<string>* parts) {
+    parts->push_back(COMPILER_VERSION);
+    parts->push_back(to_string(ANALYSIS_VERSION));
+    for (const string& path : options.imports) {
+        parts->push_back(string());
+        if (!readFile(path, &parts->back()))
+            return false;
+    }
+    return true;
+}
+
+// Erro de entrada ou saída do compilador; no formato humano, só a mensagem.
+static Diagnostic driverError(const string& message, const string& path) {
+    Diagnostic d;
+    d.phase = PHASE_DRIVER;
+    d.file = path;
+    d.message = message + ": " + path;
+    return d;
+}
+
+// Saída de uma compilação: no formato humano, o texto das mensagens (com `--stats`); nos
+// outros, apenas os diagnósticos, com o arquivo da compilação quando não têm outro.
+static string render(const CompilerOptions& options, const string& text, const std::vector<Diagnostic>& diagnostics) {
+    if (options.format == FORMAT_HUMAN)
+        return text;
+    DiagnosticWriter writer(options.format);
+    for (const Diagnostic& d : diagnostics) {
+        if (!d.file.empty()) {
+            writer.write(d);
+            continue;
+        }
+        Diagnostic located = d;
+        located.file = options.fileName;
+        writer.write(located);
+    }
+    return writer.body();
+}
+
+// Abre as interfaces de `--import`; `false` (com o erro em `error`) se alguma for inválida.
+static bool openModules(const CompilerOptions& options, const ModuleOpener& openModule,
+                        std::vector<std::shared_ptr<ModuleInterface>>* modules, Diagnostic* error) {
+    for (const string& path : options.imports)
+    {
+        std::shared_ptr<ModuleInterface> module;
+        if (openModule)
+            module = openModule(path);
+        else
+        {
+            module = std::make_shared<ModuleInterface>();
+            if (!module->open(path))
+                module = nullptr;
+        }
+
+        if (module == nullptr)
+        {
+            *error = driverError("Interface invalida ou inexistente", path);
+            return false;
+        }
+        modules->push_back(module);
+    }
+    return true;
+}
+
+// Programa com `import`: os arquivos são analisados por `ProgramBuild`, em paralelo.
+static void compileProgram(const CompilerOptions& options, SymbolTable* prelude,
+                           const std::vector<std::shared_ptr<ModuleInterface>>& modules, CacheEntry* entry,
+                           std::vector<XrefFile>* xref) {
+    std::ostringstream out;
+    ProgramBuild program(options.jobs, prelude);
+    for (auto& m : modules)
+        program.import(m);
+    if (xref != nullptr)
+        program.recordCrossReferences();
+
+    bool ok = program.compile(options.fileName, options.source, out, !options.interfaceOut.empty());
+    entry->status = ok ? 0 : EXIT_FAILURE;
+
+    if (ok && !options.interfaceOut.empty())
+    {
+        entry->hasInterface = true;
+        entry->interfaceData = program.interfaceData();
+    }
+
+    if (ok && xref != nullptr)
+        program.crossReferences(xref);
+
+    if (ok && options.showStats)
+    {
+        out << "\n[STATS] Arquivos analisados:      " << program.fileCount() << "\n";
+        out << "[STATS] Threads:                  " << program.threadCount() << "\n";
+        CompilerStats stats = program.stats();
+        out << "[STATS] Simbolos declarados:      " << stats.symbols << "\n";
+        printCounters(out, stats);
+    }
+
+    entry->output = render(options, out.str(), program.diagnostics());
+}
+
+// Executa a análise e, se pedida, serializa a interface em `entry` (sem gravá-la): o
+// resultado depende apenas das entradas e pode ser guardado no cache. Com `xref`, guarda
+// também as declarações e os usos de cada arquivo analisado (só se não houve erro).
+static void compile(const CompilerOptions& options, SymbolTable* prelude, const ModuleOpener& openModule,
+                    CacheEntry* entry, std::vector<XrefFile>* xref = nullptr) {
+    std::ostringstream out;
+
+    std::vector<std::shared_ptr<ModuleInterface>> modules;
+    Diagnostic error;
+    if (!openModules(options, openModule, &modules, &error))
+    {
+        entry->status = 1;
+        entry->output = render(options, DiagnosticWriter::human(error), { error });
+        return;
+    }
+
+    // O fonte é lido aqui para que as importações sejam vistas antes da análise; se o arquivo
+    // não puder ser lido, o parser reporta o erro como antes.
+    CompilerOptions input = options;
+    if (!input.hasSource)
+        input.hasSource = readFile(options.fileName, &input.source);
+
+    Outline header;
+    if (input.hasSource)
+        header.scanImports(input.source);
+    if (!header.imports.empty())
+    {
+        compileProgram(input, prelude, modules, entry, xref);
+        return;
+    }
+
+    TraceSpan span("arquivo", options.fileName);
+
+    // Compilação incremental: precisa do fonte e das interfaces importadas para comparar
+    // com o estado anterior; sem eles, a compilação é completa. O índice de referências
+    // precisa das ocorrências de todas as classes, então também força a compilação completa.
+    std::unique_ptr<IncrementalBuild> build;
+    CompilerOptions partial = input;
+    std::vector<string> environment;
+    if (!options.incrementalState.empty() && xref == nullptr && input.hasSource &&
+        environmentParts(options, &environment))
+    {
+        build.reset(new IncrementalBuild(options.incrementalState));
+        build->plan(input.source, CompilationCache::key(environment));
+        partial.source = build->partialSource();
+    }
+
+    // A compilacao e dona da tabela de simbolos (com as palavras reservadas do X++),
+    // das interfaces importadas e do parser; tudo e liberado ao sair do escopo. Na
+    // compilação incremental pode haver mais de uma rodada (`IncrementalBuild::extend`):
+    // cada uma recomeça a análise, e só as mensagens da última são mantidas.
+    std::unique_ptr<Compilation> compilation;
+    CrossReference occurrences;
+    bool ok;
+    string analyzed;
+    for (;;)
+    {
+        compilation.reset();
+        out.str("");
+        compilation.reset(new Compilation(out, prelude));
+        for (auto& m : modules)
+            compilation->import(m);
+        if (xref != nullptr)
+            compilation->setCrossReference(&occurrences);
+
+        if (build != nullptr && build->cleanInterface() != nullptr)
+            compilation->import(build->cleanInterface());
+        if (build != nullptr && !build->hasWork())
+        {
+            ok = true; // Nada mudou: mesma mensagem de `Parser::run`.
+            out << "\n[SUCESSO] Compilacao finalizada com sucesso.\n";
+            break;
+        }
+        else if (partial.hasSource)
+            ok = compilation->compileSource(partial.source);
+        else
+            ok = compilation->compile(options.fileName);
+
+        if (!ok || build == nullptr)
+            break;
+        analyzed = compilation->interfaceData();
+        if (!build->extend(analyzed))
+            break;
+        partial.source = build->partialSource();
+    }
+    entry->status = ok ? 0 : EXIT_FAILURE;
+
+    string interface;
+    if (ok && build != nullptr)
+        interface = build->commit(build->hasWork() ? analyzed : compilation->interfaceData());
+    else if (ok && !options.interfaceOut.empty())
+        interface = compilation->interfaceData();
+
+    if (ok && !options.interfaceOut.empty())
+    {
+        entry->hasInterface = true;
+        entry->interfaceData = interface;
+    }
+
+    if (ok && xref != nullptr)
+        xref->push_back({ options.fileName, occurrences.all() });
+
+    if (ok && options.showStats)
+    {
+        printStats(out, compilation->getSymbolTable());
+        if (build != nullptr)
+            out << "[STATS] Classes reanalisadas:     " << build->dirtyCount() << " de " << build->classCount() << "\n";
+    }
+
+    entry->output = render(options, out.str(), compilation->diagnostics());
+}
+
+// Com `--cache-dir`, o resultado é buscado pelo hash do fonte, das interfaces importadas, das
+// opções e da versão do compilador. Em um acerto nada é analisado: as mensagens gravadas são
+// repetidas e a interface gerada é restaurada. Se algum arquivo não puder ser lido, a
+// compilação segue sem cache (e reporta o erro normalmente).
+int runCompiler(const CompilerOptions& options, ostream& out, SymbolTable* prelude, const ModuleOpener& openModule) {
+    CacheEntry entry;
+    CompilerOptions loaded = options;
+    std::vector<string> parts;
+
+    // O índice de referências, os relatórios de tempo, de contadores e de alocações e o trace
+    // vêm da análise, então não há atalho pelo cache. O mesmo vale para `--stats` com
+    // `--incremental`: as classes reanalisadas são as desta execução, não as da que gravou a
+    // entrada.
+    bool counting = options.perfCounters || !options.perfJson.empty();
+    bool cacheable = !options.cacheDir.empty() && options.xrefOut.empty() && !options.timeReport &&
+                     options.traceOut.empty() && !counting && !options.allocReport &&
+                     !(options.showStats && !options.incrementalState.empty());
+    if (cacheable && !loaded.hasSource)
+        loaded.hasSource = cacheable = readFile(options.fileName, &loaded.source);
+
+    // Programas de vários arquivos não passam pelo cache: a chave teria de cobrir cada
+    // arquivo importado.
+    if (cacheable) {
+        Outline header;
+        header.scanImports(loaded.source);
+        cacheable = header.imports.empty();
+    }
+
+    if (cacheable) {
+        // No formato humano as mensagens não citam o nome do arquivo, então o mesmo fonte em
+        // outro caminho reaproveita a entrada; em json e sarif cada diagnóstico leva o caminho
+        // da compilação (`render`), que entra na chave.
+        parts = { options.showStats ? "stats" : "", options.interfaceOut.empty() ? "" : "interface",
+                  options.incrementalState.empty() ? "" : "incremental", to_string((int) options.format),
+                  options.format == FORMAT_HUMAN ? "" : options.fileName };
+        cacheable = environmentParts(options, &parts);
+        parts.push_back(loaded.source);
+    }
+
+    std::vector<XrefFile> xref;
+    TimeReport time;
+    if (counting)
+        time.countEvents();
+    if (options.timeReport || counting)
+        time.start();
+    Trace trace;
+    if (!options.traceOut.empty())
+        trace.start();
+    AllocationStats allocations[ALLOC_SUBSYSTEMS];
+    if (options.allocReport) {
+        resetAllocationPeaks();
+        for (int s = 0; s < ALLOC_SUBSYSTEMS; s++)
+            allocations[s] = allocationStats((AllocSubsystem) s);
+    }
+    if (!cacheable) {
+        TraceSpan span("fase", "compilacao");
+        compile(options, prelude, openModule, &entry, options.xrefOut.empty() ? nullptr : &xref);
+    } else {
+        CompilationCache cache(options.cacheDir, options.cacheMaxMB << 20);
+        string key = CompilationCache::key(parts);
+        if (!cache.lookup(key, &entry)) {
+            compile(loaded, prelude, openModule, &entry);
+            cache.store(key, entry);
+        }
+    }
+
+    // Toda a saída (as mensagens da compilação e os erros de gravação) é escrita de uma vez.
+    DiagnosticWriter writer(options.format);
+    writer.append(entry.output);
+    if (options.timeReport || counting) {
+        time.stop();
+        std::ostringstream report;
+        if (options.timeReport)
+            time.print(report);
+        if (options.perfCounters)
+            time.printEvents(report);
+        writer.text(report.str());
+    }
+    if (options.allocReport) {
+        std::ostringstream report;
+        printAllocations(report, allocations);
+        writer.text(report.str());
+    }
+    int status = entry.status;
+    {
+        TraceSpan span("fase", "gravacao");
+        if (entry.hasInterface && !CompilationCache::writeAtomically(options.interfaceOut, entry.interfaceData))
+        {
+            writer.write(driverError("Nao foi possivel gravar a interface", options.interfaceOut));
+            status = 1;
+        }
+        else if (!xref.empty() && !XrefIndex::update(options.xrefOut, xref))
+        {
+            writer.write(driverError("Nao foi possivel gravar o indice de referencias", options.xrefOut));
+            status = 1;
+        }
+    }
+
+    if (!options.perfJson.empty() && !CompilationCache::writeAtomically(options.perfJson, time.eventsJson()))
+    {
+        writer.write(driverError("Nao foi possivel gravar os contadores", options.perfJson));
+        status = 1;
+    }
+
+    // Os buffers das threads só são lidos depois que a compilação termina.
+    if (!options.traceOut.empty())
+    {
+        trace.stop();
+        if (!CompilationCache::writeAtomically(options.traceOut, trace.json()))
+        {
+            writer.write(driverError("Nao foi possivel gravar o trace", options.traceOut));
+            status = 1;
+        }
+    }
+
+    out << writer.finish();
+    out.flush();
+    return status;
+}
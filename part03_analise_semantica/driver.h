@@ -0,0 +1,46 @@
+#include "superheader.h"
+
+// Versão do compilador; faz parte da chave do cache de resultados.
+const char* const COMPILER_VERSION = "xpp_compiler 0.5";
+
+// Versão das regras da análise e do texto das mensagens. Faz parte da chave do cache e do
+// estado incremental, então deve ser incrementada a cada mudança no scanner, no parser, nas
+// verificações semânticas ou nas mensagens que altere o resultado de algum programa.
+const uint32_t ANALYSIS_VERSION = 1;
+
+// Opções da linha de comando do compilador, compartilhadas pelo executável (`principal.cpp`)
+// e pelo daemon (`tools/xppd.cpp`), que recebe os mesmos argumentos do cliente.
+struct CompilerOptions {
+    string fileName;
+    string interfaceOut;           // --emit-interface
+    std::vector<string> imports;   // --import (pode repetir)
+    bool showStats;                // --stats
+    bool timeReport;               // --time-report
+    string traceOut;               // --trace (vazio: sem trace)
+    bool perfCounters;             // --perf-counters
+    bool allocReport;              // --alloc-report
+    string perfJson;               // --perf-counters-json (vazio: sem arquivo)
+    bool hasSource;                // O texto veio junto com a requisição (daemon); `fileName` é só o rótulo.
+    string source;
+    string incrementalState;       // --incremental (vazio: compilação completa)
+    size_t jobs;                   // -j: threads para programas de vários arquivos (0: uma por núcleo)
+    string cacheDir;               // --cache-dir (vazio: sem cache)
+    uint64_t cacheMaxMB;           // --cache-max-mb
+    string xrefOut;                // --emit-xref (vazio: sem índice de referências)
+    DiagnosticFormat format;       // --diagnostics-format (json e sarif: só os diagnósticos, sem `--stats`)
+
+    CompilerOptions() : showStats(false), timeReport(false), perfCounters(false), allocReport(false), hasSource(false), jobs(0), cacheMaxMB(256), format(FORMAT_HUMAN) {}
+};
+
+// Abre uma interface binária; o daemon usa uma versão que mantém as interfaces em cache.
+typedef std::function<std::shared_ptr<ModuleInterface>(const string& path)> ModuleOpener;
+
+// Interpreta os argumentos (sem o nome do programa); `false` se forem inválidos.
+bool parseOptions(const std::vector<string>& args, CompilerOptions* options);
+
+void printUsage(ostream& out);
+
+// Executa a compilação descrita por `options`, escrevendo as mensagens em `out`, e retorna
+// o código de saída do processo.
+int runCompiler(const CompilerOptions& options, ostream& out, SymbolTable* prelude = nullptr,
+                const ModuleOpener& openModule = ModuleOpener());
@@ -0,0 +1,250 @@
+#include "superheader.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define FLATHASHMAP_SSE2 1
+#endif
+
+// Funcoes de hash usadas pelas tabelas do compilador.
+// `mixHash` espalha os bits de um inteiro; `hashBytes` processa 8 bytes por vez.
+inline uint64_t mixHash(uint64_t h) {
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
+inline uint64_t hashBytes(const char* data, size_t len) {
+    uint64_t h = 0x9e3779b97f4a7c15ULL ^ (len * 0x100000001b3ULL);
+    size_t i = 0;
+    for (; i + 8 <= len; i += 8) {
+        uint64_t w;
+        memcpy(&w, data + i, 8);
+        h = (h ^ mixHash(w)) * 0x100000001b3ULL;
+    }
+    uint64_t tail = 0;
+    memcpy(&tail, data + i, len - i);
+    return mixHash(h ^ tail);
+}
+
+// Funtor de hash padrao: strings pelo conteudo, inteiros pelo valor.
+template <typename K> struct FlatHash {
+    uint64_t operator()(const K& key) const { return mixHash((uint64_t) key); }
+};
+
+template <> struct FlatHash<string> {
+    uint64_t operator()(const string& key) const { return hashBytes(key.data(), key.size()); }
+};
+
+// A classe `FlatHashMap` e uma tabela hash de enderecamento aberto no estilo "Swiss table".
+// Os slots ficam em um unico vetor contiguo e cada slot tem um byte de controle:
+// - EMPTY (0x80) marca um slot livre, DELETED (0xFE) marca uma remocao;
+// - um slot ocupado guarda os 7 bits altos do hash (h2).
+// A busca compara 16 bytes de controle de uma vez (SSE2, com alternativa escalar) e so
+// compara chaves quando h2 coincide. O hash completo fica salvo no slot, entao o
+// redimensionamento nunca recalcula hashes e a comparacao de chaves e filtrada por ele.
+template <typename K, typename V, typename Hash = FlatHash<K>>
+class FlatHashMap {
+public:
+    struct Slot {
+        uint64_t hash;
+        K key;
+        V value;
+    };
+
+    FlatHashMap() {
+        capacity = 0;
+        count = 0;
+        tombstones = 0;
+    }
+
+    // Busca a chave e retorna ponteiro para o valor, ou `nullptr` se ausente.
+    V* find(const K& key) {
+        return findHashed(key, hasher(key));
+    }
+
+    V* findHashed(const K& key, uint64_t hash) {
+        if (capacity == 0)
+            return nullptr;
+        long idx = probe(key, hash);
+        return idx < 0 ? nullptr : &slots[idx].value;
+    }
+
+    // Insere o par se a chave ainda nao existir; retorna `false` caso ja exista.
+    bool insert(const K& key, const V& value) {
+        return insertHashed(key, hash(key), value);
+    }
+
+    bool insertHashed(const K& key, uint64_t hash, const V& value) {
+        if (capacity != 0 && probe(key, hash) >= 0)
+            return false;
+        if ((count + tombstones + 1) * 8 > capacity * 7)
+            rehash(capacity == 0 ? GROUP_WIDTH : ((count + 1) * 8 > capacity * 4 ? capacity * 2 : capacity));
+        size_t idx = findFree(hash);
+        if (ctrl[idx] == DELETED)
+            tombstones--;
+        ctrl[idx] = h2(hash);
+        slots[idx].hash = hash;
+        slots[idx].key = key;
+        slots[idx].value = value;
+        count++;
+        return true;
+    }
+
+    // Remove a chave; retorna `true` se ela existia.
+    bool erase(const K& key) {
+        if (capacity == 0)
+            return false;
+        long idx = probe(key, hash(key));
+        if (idx < 0)
+            return false;
+        ctrl[idx] = DELETED;
+        slots[idx].key = K();
+        slots[idx].value = V();
+        count--;
+        tombstones++;
+        return true;
+    }
+
+    // Esvazia a tabela mantendo a capacidade alocada (escopos sao recriados com frequencia).
+    void clear() {
+        if (count == 0 && tombstones == 0)
+            return;
+        for (size_t i = 0; i < capacity; i++) {
+            if (ctrl[i] != EMPTY) {
+                ctrl[i] = EMPTY;
+                slots[i].key = K();
+                slots[i].value = V();
+            }
+        }
+        count = 0;
+        tombstones = 0;
+    }
+
+    void reserve(size_t n) {
+        size_t need = GROUP_WIDTH;
+        while (need * 7 < n * 8)
+            need *= 2;
+        if (need > capacity)
+            rehash(need);
+    }
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+
+    // Percorre todos os pares ocupados (ordem nao especificada).
+    template <typename F> void forEach(F f) const {
+        for (size_t i = 0; i < capacity; i++)
+            if (isFull(ctrl[i]))
+                f(slots[i].key, slots[i].value);
+    }
+
+    uint64_t hash(const K& key) const { return hasher(key); }
+
+private:
+    enum : size_t { GROUP_WIDTH = 16 };
+    enum : int8_t { EMPTY = -128, DELETED = -2 }; // 0x80 e 0xFE
+
+    std::vector<int8_t> ctrl; // Bytes de controle, um por slot.
+    std::vector<Slot> slots;  // Slots contiguos (chave, valor e hash completo).
+    size_t capacity;          // Numero de slots (potencia de 2, multiplo de GROUP_WIDTH).
+    size_t count;             // Slots ocupados.
+    size_t tombstones;        // Slots marcados como DELETED.
+    Hash hasher;
+
+    static int8_t h2(uint64_t hash) { return (int8_t) (hash >> 57); }
+    static bool isFull(int8_t c) { return c >= 0; }
+
+    // Mascaras de 16 bits: slots do grupo cujo controle e igual a `c` / que estao livres.
+    static uint32_t matchByte(const int8_t* group, int8_t c) {
+#ifdef FLATHASHMAP_SSE2
+        __m128i g = _mm_loadu_si128((const __m128i*) group);
+        return (uint32_t) _mm_movemask_epi8(_mm_cmpeq_epi8(g, _mm_set1_epi8(c)));
+#else
+        uint32_t mask = 0;
+        for (size_t i = 0; i < GROUP_WIDTH; i++)
+            if (group[i] == c)
+                mask |= 1u << i;
+        return mask;
+#endif
+    }
+
+    static uint32_t matchFree(const int8_t* group) {
+#ifdef FLATHASHMAP_SSE2
+        // EMPTY e DELETED tem o bit mais alto ligado; slots ocupados nao.
+        return (uint32_t) _mm_movemask_epi8(_mm_loadu_si128((const __m128i*) group));
+#else
+        uint32_t mask = 0;
+        for (size_t i = 0; i < GROUP_WIDTH; i++)
+            if (!isFull(group[i]))
+                mask |= 1u << i;
+        return mask;
+#endif
+    }
+
+    static int lowestBit(uint32_t mask) {
+#if defined(__GNUC__)
+        return __builtin_ctz(mask);
+#else
+        int i = 0;
+        while (!(mask & 1)) { mask >>= 1; i++; }
+        return i;
+#endif
+    }
+
+    // Sondagem triangular sobre grupos: visita todos os grupos quando o numero e potencia de 2.
+    long probe(const K& key, uint64_t hash) const {
+        size_t groupMask = capacity / GROUP_WIDTH - 1;
+        size_t group = (size_t) hash & groupMask;
+        int8_t tag = h2(hash);
+        for (size_t step = 1; ; step++) {
+            const int8_t* g = &ctrl[group * GROUP_WIDTH];
+            uint32_t mask = matchByte(g, tag);
+            while (mask) {
+                size_t idx = group * GROUP_WIDTH + lowestBit(mask);
+                if (slots[idx].hash == hash && slots[idx].key == key)
+                    return (long) idx;
+                mask &= mask - 1;
+            }
+            if (matchByte(g, EMPTY))
+                return -1; // Um slot vazio encerra a cadeia de sondagem.
+            if (step > groupMask)
+                return -1;
+            group = (group + step) & groupMask;
+        }
+    }
+
+    size_t findFree(uint64_t hash) const {
+        size_t groupMask = capacity / GROUP_WIDTH - 1;
+        size_t group = (size_t) hash & groupMask;
+        for (size_t step = 1; ; step++) {
+            uint32_t mask = matchFree(&ctrl[group * GROUP_WIDTH]);
+            if (mask)
+                return group * GROUP_WIDTH + lowestBit(mask);
+            group = (group + step) & groupMask;
+        }
+    }
+
+    void rehash(size_t newCapacity) {
+        std::vector<int8_t> oldCtrl;
+        std::vector<Slot> oldSlots;
+        oldCtrl.swap(ctrl);
+        oldSlots.swap(slots);
+        size_t oldCapacity = capacity;
+
+        capacity = newCapacity;
+        ctrl.assign(capacity, EMPTY);
+        slots.resize(capacity);
+        tombstones = 0;
+
+        for (size_t i = 0; i < oldCapacity; i++) {
+            if (isFull(oldCtrl[i])) {
+                size_t idx = findFree(oldSlots[i].hash);
+                ctrl[idx] = oldCtrl[i];
+                slots[idx] = std::move(oldSlots[i]);
+            }
+        }
+    }
+};
@@ -0,0 +1,242 @@
+#include "superheader.h"
+
+static const char* STATE_HEADER = "XPPSTATE 1";
+
+static string hex(uint64_t v) {
+    char buf[17];
+    snprintf(buf, sizeof(buf), "%016llx", (unsigned long long) v);
+    return buf;
+}
+
+static bool readFile(const string& path, string* data) {
+    ifstream in(path, ios::in | ios::binary);
+    if (!in.is_open())
+        return false;
+    data->assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    return !in.bad();
+}
+
+IncrementalBuild::IncrementalBuild(const string& path) {
+    statePath = path;
+    outlined = false;
+    unchanged = false;
+    dirtyClasses = 0;
+}
+
+// Lê o estado anterior; `false` se ele não existe, é de outro ambiente ou não corresponde
+// à interface guardada (por exemplo, se a gravação foi interrompida).
+bool IncrementalBuild::loadState(string* interfaceBytes) {
+    ifstream in(statePath);
+    string header, env, interfaceHash;
+    if (!in.is_open() || !getline(in, header) || header != STATE_HEADER)
+        return false;
+    if (!(in >> env >> interfaceHash) || env != environmentKey)
+        return false;
+
+    if (!readFile(statePath + ".xpi", interfaceBytes) ||
+        hex(hashBytes(interfaceBytes->data(), interfaceBytes->size())) != interfaceHash)
+        return false;
+
+    string hash, name;
+    int line;
+    while (in >> hash >> line >> name)
+        stored[name] = { strtoull(hash.c_str(), nullptr, 16), line };
+    return true;
+}
+
+void IncrementalBuild::plan(const string& text, const string& environment) {
+    environmentKey = hex(hashBytes(environment.data(), environment.size()));
+    outlined = outline.scan(text);
+
+    string interfaceBytes;
+    if (!outlined || !loadState(&interfaceBytes)) {
+        // Sem estado utilizável (ou fonte fora da forma esperada): tudo é reanalisado.
+        partial = text;
+        dirtyClasses = outlined ? outline.classes.size() : 0;
+        dirty.assign(outline.classes.size(), true);
+        return;
+    }
+    source = text;
+
+    // Classes novas, com texto diferente ou duplicadas são analisadas primeiro. A interface
+    // guardada contém exatamente as classes do estado.
+    std::vector<OutlineClass>& classes = outline.classes;
+    std::unordered_map<string, size_t> count;
+    for (const OutlineClass& c : classes)
+        count[c.name]++;
+
+    std::vector<string> changed;
+    bool edited = false;
+    dirty.assign(classes.size(), false);
+    compared.assign(classes.size(), false);
+    changedClass.assign(classes.size(), false);
+    for (size_t i = 0; i < classes.size(); i++) {
+        const OutlineClass& c = classes[i];
+        auto s = stored.find(c.name);
+        if (count[c.name] > 1 || s == stored.end() || s->second.hash != c.hash) {
+            dirty[i] = true;
+            edited = true;
+        }
+        if (count[c.name] > 1)
+            changed.push_back(c.name); // Qual das declarações vale só a análise decide.
+    }
+
+    previous = std::make_shared<ModuleInterface>();
+    previous->openBuffer(statePath + ".xpi", interfaceBytes);
+    clean = std::make_shared<ModuleInterface>();
+    clean->openBuffer(statePath + ".xpi", interfaceBytes);
+    for (auto& s : stored)
+        if (!count.count(s.first)) {
+            changed.push_back(s.first); // Removida: a interface "mudou" para nenhuma.
+            clean->hideClass(s.first);
+        }
+    unchanged = !edited && changed.empty();
+
+    for (size_t i = 0; i < classes.size(); i++)
+        for (const string& d : classes[i].deps)
+            dependents[d].push_back(i);
+    propagate(changed);
+
+    buildPartial();
+    if (unchanged)
+        previousInterface.swap(interfaceBytes);
+}
+
+// As classes que usam uma classe alterada são sujas. As subclasses também têm a interface
+// herdada alterada, então os dependentes delas também são sujos (transitivamente pela
+// cadeia de `extends`).
+size_t IncrementalBuild::propagate(std::vector<string> changed) {
+    std::vector<OutlineClass>& classes = outline.classes;
+    size_t marked = 0;
+    while (!changed.empty()) {
+        string name = changed.back();
+        changed.pop_back();
+        auto d = dependents.find(name);
+        if (d == dependents.end())
+            continue;
+        for (size_t i : d->second) {
+            if (!dirty[i]) {
+                dirty[i] = true;
+                marked++;
+            }
+            if (classes[i].parent == name && !changedClass[i]) {
+                changedClass[i] = true;
+                changed.push_back(classes[i].name);
+            }
+        }
+    }
+    return marked;
+}
+
+bool IncrementalBuild::extend(const string& partialInterface) {
+    if (previous == nullptr)
+        return false; // Compilação completa: não há o que comparar.
+
+    ModuleInterface analyzed;
+    if (!analyzed.openBuffer(statePath + ".xpi", partialInterface))
+        return false;
+
+    std::vector<string> changed;
+    for (size_t i = 0; i < outline.classes.size(); i++) {
+        if (!dirty[i] || compared[i])
+            continue;
+        compared[i] = true;
+        const string& name = outline.classes[i].name;
+        if (!changedClass[i] && analyzed.signatureOf(name) != previous->signatureOf(name)) {
+            changedClass[i] = true;
+            changed.push_back(name);
+        }
+    }
+    if (propagate(changed) == 0)
+        return false;
+    buildPartial();
+    return true;
+}
+
+// Fonte parcial: classes limpas viram apenas as suas quebras de linha e são lidas da
+// interface guardada; as sujas são ocultadas nela, pois serão declaradas de novo.
+void IncrementalBuild::buildPartial() {
+    std::vector<OutlineClass>& classes = outline.classes;
+    partial.clear();
+    partial.reserve(source.size());
+    size_t last = 0;
+    dirtyClasses = 0;
+    for (size_t i = 0; i < classes.size(); i++) {
+        const OutlineClass& c = classes[i];
+        partial.append(source, last, c.start - last);
+        if (dirty[i]) {
+            partial.append(source, c.start, c.end - c.start);
+            clean->hideClass(c.name);
+            dirtyClasses++;
+        } else {
+            partial.append(std::count(source.begin() + c.start, source.begin() + c.end, '\n'), '\n');
+            if (c.line != stored[c.name].line) {
+                clean->shiftClass(c.name, c.line - stored[c.name].line);
+                unchanged = false;
+            }
+        }
+        last = c.end;
+    }
+    partial.append(source, last, string::npos);
+}
+
+bool IncrementalBuild::hasWork() {
+    return !outlined || dirtyClasses > 0;
+}
+
+const string& IncrementalBuild::partialSource() {
+    return partial;
+}
+
+std::shared_ptr<ModuleInterface> IncrementalBuild::cleanInterface() {
+    return clean;
+}
+
+size_t IncrementalBuild::classCount() {
+    return outline.classes.size();
+}
+
+size_t IncrementalBuild::dirtyCount() {
+    return dirtyClasses;
+}
+
+string IncrementalBuild::commit(const string& partialInterface) {
+    // Fonte fora da forma esperada: a compilação foi completa e não há esboço para guardar.
+    if (!outlined)
+        return partialInterface;
+    // Nenhuma classe alterada nem deslocada: o estado guardado continua válido.
+    if (unchanged)
+        return previousInterface;
+
+    std::vector<InterfaceClass> found;
+    if (clean != nullptr)
+        clean->readAll(&found);
+    ModuleInterface analyzed;
+    if (analyzed.openBuffer(statePath + ".xpi", partialInterface))
+        analyzed.readAll(&found);
+
+    // Classes na ordem do fonte, como numa compilação completa: a interface resultante é
+    // idêntica byte a byte.
+    std::unordered_map<std::string_view, InterfaceClass*> byName;
+    for (InterfaceClass& c : found)
+        byName[c.name] = &c;
+    std::vector<InterfaceClass> all;
+    for (const OutlineClass& c : outline.classes) {
+        auto f = byName.find(c.name);
+        if (f != byName.end()) {
+            all.push_back(std::move(*f->second));
+            byName.erase(f);
+        }
+    }
+    string full = ModuleInterface::serialize(all);
+
+    string state = string(STATE_HEADER) + "\n" + environmentKey + " " + hex(hashBytes(full.data(), full.size())) + "\n";
+    for (const OutlineClass& c : outline.classes)
+        state += hex(c.hash) + " " + to_string(c.line) + " " + c.name + "\n";
+
+    // A interface é gravada antes do estado; o estado cita o hash dela, então uma gravação
+    // interrompida entre os dois é detectada na próxima compilação.
+    if (CompilationCache::writeAtomically(statePath + ".xpi", full))
+        CompilationCache::writeAtomically(statePath, state);
+    return full;
+}
@@ -0,0 +1,72 @@
+#include "superheader.h"
+
+// A classe `IncrementalBuild` implementa a compilação incremental por classe (`--incremental`).
+//
+// O estado de uma compilação bem-sucedida fica em dois arquivos:
+//   <estado>      texto: versão, chave do ambiente (compilador e interfaces importadas), hash
+//                 da interface e, por classe, hash do texto, linha e nome
+//   <estado>.xpi  interface binária de todas as classes do programa
+//
+// Na recompilação, o `Outline` do fonte é comparado ao estado: classes novas, alteradas ou
+// duplicadas são "sujas" e são analisadas primeiro. Apenas as classes sujas são analisadas:
+// o fonte parcial mantém as demais como linhas em branco (preservando os números de linha
+// das mensagens) e elas são lidas da interface guardada, com as linhas deslocadas se a
+// classe mudou de posição.
+//
+// As classes que dependem de uma classe suja só são reanalisadas se a interface dela (sem
+// as linhas, como no servidor de linguagem) mudou: depois de cada análise, `extend` compara
+// as interfaces e, se alguma mudou, suja os dependentes diretos e as subclasses (cuja
+// interface herdada também mudou) para uma nova rodada. Editar o corpo de um método custa
+// uma rodada com uma classe; classes removidas ou duplicadas sujam os seus dependentes
+// desde o início.
+class IncrementalBuild {
+public:
+    IncrementalBuild(const string& statePath);
+
+    // Decide o que reanalisar. `environment` identifica tudo o que, além do fonte, afeta o
+    // resultado; se mudar, todas as classes são reanalisadas.
+    void plan(const string& source, const string& environment);
+
+    // Após uma análise bem-sucedida de `partialSource()`, com a interface das classes
+    // analisadas: `true` se a interface de alguma mudou e há dependentes a analisar; nesse
+    // caso `partialSource()` passa a conter também eles (todas as classes sujas são
+    // analisadas de novo juntas).
+    bool extend(const string& partialInterface);
+
+    bool hasWork();                     // Se há classes a reanalisar.
+    const string& partialSource();      // Fonte apenas com as classes a reanalisar.
+    std::shared_ptr<ModuleInterface> cleanInterface(); // Classes reaproveitadas (nullptr sem estado anterior).
+    size_t classCount();
+    size_t dirtyCount();
+
+    // Após uma análise bem-sucedida do fonte parcial: combina a interface das classes
+    // reanalisadas com a das reaproveitadas, grava o novo estado e retorna a interface completa.
+    string commit(const string& partialInterface);
+
+private:
+    string statePath;
+    string environmentKey;
+    Outline outline;
+    bool outlined;
+    bool unchanged;           // Fonte idêntico ao do estado (exceto fora das classes).
+    string previousInterface; // Interface guardada, se `unchanged`.
+    std::vector<bool> dirty;
+    std::vector<bool> compared;     // Classes sujas cuja interface já foi comparada.
+    std::vector<bool> changedClass; // Classes cuja interface mudou (já propagadas).
+    size_t dirtyClasses;
+    string source;
+    string partial;
+    std::shared_ptr<ModuleInterface> clean;
+    std::shared_ptr<ModuleInterface> previous; // Interface guardada, sem classes ocultas.
+    std::unordered_map<string, std::vector<size_t>> dependents; // Índice reverso das dependências.
+
+    struct StoredClass {
+        uint64_t hash;
+        int line;
+    };
+    std::unordered_map<string, StoredClass> stored;
+
+    bool loadState(string* interfaceBytes);
+    size_t propagate(std::vector<string> changed); // Suja os dependentes; retorna quantas classes sujou.
+    void buildPartial();
+};
@@ -0,0 +1,45 @@
+#include "superheader.h"
+
+// Com uma base, os atomos locais continuam a numeracao dela; o texto dos atomos da base e
+// copiado (sao poucos nomes), mas o indice da base e consultado diretamente.
+Interner::Interner(Arena* a, Interner* b) {
+    arena = a;
+    base = b;
+    if (base != nullptr) {
+        names = base->names;
+        return;
+    }
+    names.push_back(std::string_view()); // Atomo 0: string vazia.
+    index.insert(std::string_view(), NO_ATOM);
+}
+
+Atom Interner::intern(std::string_view name) {
+    uint64_t hash = index.hash(name);
+    Atom* found = base != nullptr ? base->index.findHashed(name, hash) : nullptr;
+    if (found == nullptr)
+        found = index.findHashed(name, hash);
+    if (found != nullptr)
+        return *found;
+
+    Atom atom = (Atom) names.size();
+    std::string_view stored(arena->copyString(name.data(), name.size()), name.size());
+    names.push_back(stored);
+    index.insertHashed(stored, hash, atom);
+    return atom;
+}
+
+Atom Interner::find(std::string_view name) {
+    uint64_t hash = index.hash(name);
+    Atom* found = base != nullptr ? base->index.findHashed(name, hash) : nullptr;
+    if (found == nullptr)
+        found = index.findHashed(name, hash);
+    return found != nullptr ? *found : NO_ATOM;
+}
+
+std::string_view Interner::str(Atom atom) {
+    return names[atom];
+}
+
+size_t Interner::size() {
+    return names.size();
+}
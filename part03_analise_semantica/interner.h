@@ -0,0 +1,30 @@
+#include "superheader.h"
+
+// Identificador de um nome internalizado. O atomo 0 e sempre a string vazia.
+typedef uint32_t Atom;
+const Atom NO_ATOM = 0;
+
+template <> struct FlatHash<std::string_view> {
+    uint64_t operator()(std::string_view key) const { return hashBytes(key.data(), key.size()); }
+};
+
+// A classe `Interner` guarda uma unica copia de cada nome (lexema) visto na compilacao
+// e associa a ele um inteiro (`Atom`). Os caracteres ficam na arena da compilacao, de modo
+// que comparar ou usar nomes como chave passa a ser uma operacao sobre inteiros.
+// Um `Interner` pode estender uma base congelada (o prelúdio compartilhado do daemon): os
+// atomos da base sao preservados, consultados sem alteracao e, portanto, sem locks.
+class Interner {
+public:
+    Interner(Arena*, Interner* base = nullptr);
+
+    Atom intern(std::string_view);      // Retorna o atomo do nome, criando-o se necessario.
+    Atom find(std::string_view);        // Retorna o atomo ou NO_ATOM se o nome nunca foi visto.
+    std::string_view str(Atom);         // Texto associado ao atomo.
+    size_t size();                      // Numero de nomes distintos.
+
+private:
+    Arena* arena;
+    Interner* base;                               // Nomes compartilhados (somente leitura).
+    std::vector<std::string_view> names;          // Texto de cada atomo (aponta para a arena).
+    FlatHashMap<std::string_view, Atom> index;    // Texto -> atomo.
+};
@@ -0,0 +1,350 @@
+#include "superheader.h"
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+static const char MAGIC[4] = { 'X', 'P', 'P', 'I' };
+static const uint32_t VERSION = 1;
+static const size_t HEADER_SIZE = 32;
+
+ModuleInterface::ModuleInterface() {
+    data = nullptr;
+    size = 0;
+    mapped = false;
+}
+
+ModuleInterface::~ModuleInterface() {
+#ifndef _WIN32
+    if (mapped)
+        munmap((void*) data, size);
+#endif
+}
+
+uint32_t ModuleInterface::u32(size_t offset) {
+    uint32_t v;
+    memcpy(&v, data + offset, 4);
+    return v;
+}
+
+// O arquivo vem de fora do compilador: cada string precisa caber na tabela de strings.
+bool ModuleInterface::str(uint32_t offset, std::string_view* out) {
+    size_t base = u32(20) + (size_t) offset;
+    size_t end = (size_t) u32(20) + u32(24);
+    if ((size_t) offset + 4 > u32(24) || base + 4 + u32(base) > end)
+        return false;
+    *out = std::string_view((const char*) data + base + 4, u32(base));
+    return true;
+}
+
+bool ModuleInterface::open(const string& fileName) {
+    path = fileName;
+
+#ifndef _WIN32
+    int fd = ::open(fileName.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    struct stat st;
+    if (fstat(fd, &st) == 0 && st.st_size >= (off_t) HEADER_SIZE) {
+        void* p = mmap(nullptr, (size_t) st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p != MAP_FAILED) {
+            data = (const uint8_t*) p;
+            size = (size_t) st.st_size;
+            mapped = true;
+        }
+    }
+    close(fd);
+#else
+    ifstream in(fileName, ios::in | ios::binary);
+    if (in.is_open()) {
+        buffer.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+        data = buffer.data();
+        size = buffer.size();
+    }
+#endif
+
+    return validate();
+}
+
+// Interface mantida em memória (por exemplo, a das classes não alteradas em uma compilação
+// incremental); o conteúdo é copiado.
+bool ModuleInterface::openBuffer(const string& name, const string& bytes) {
+    path = name;
+    buffer.assign(bytes.begin(), bytes.end());
+    data = buffer.data();
+    size = buffer.size();
+    return validate();
+}
+
+// Validação do cabeçalho e dos limites das seções, na ordem em que são gravadas. Os
+// registros e as strings são verificados a cada leitura (`fits` e `str`).
+bool ModuleInterface::validate() {
+    if (data == nullptr || size < HEADER_SIZE || memcmp(data, MAGIC, 4) != 0 || u32(4) != VERSION)
+        return false;
+
+    uint32_t slots = u32(12);
+    return u32(28) == size && (slots & (slots - 1)) == 0 && u32(16) >= HEADER_SIZE
+        && (size_t) u32(16) + (size_t) slots * 8 <= u32(20)
+        && (size_t) u32(20) + u32(24) <= size;
+}
+
+// Sondagem linear no índice: o hash de 32 bits filtra as entradas antes de comparar nomes.
+// A sondagem para depois de uma volta completa, mesmo que um arquivo corrompido não tenha
+// nenhum slot vazio.
+bool ModuleInterface::findClass(std::string_view name, InterfaceClass* out) {
+    uint32_t slots = u32(12);
+    uint32_t hash = (uint32_t) hashBytes(name.data(), name.size());
+    for (uint32_t n = 0, i = hash & (slots - 1); n < slots; n++, i = (i + 1) & (slots - 1)) {
+        size_t entry = u32(16) + (size_t) i * 8;
+        uint32_t record = u32(entry + 4);
+        std::string_view recordName;
+        if (record == 0)
+            return false;
+        if (u32(entry) != hash || !fits(record, 16) || !str(u32(record), &recordName) || recordName != name)
+            continue;
+
+        return decode(record, out);
+    }
+    return false;
+}
+
+// Os registros ficam entre o índice e a tabela de strings.
+bool ModuleInterface::fits(size_t offset, size_t bytes) {
+    return offset >= (size_t) u32(16) + (size_t) u32(12) * 8 && offset + bytes <= u32(20);
+}
+
+// `false` se a classe está oculta ou se o registro é inválido (contagens ou strings fora
+// do arquivo); nos dois casos a classe não é encontrada.
+bool ModuleInterface::decode(uint32_t record, InterfaceClass* out) {
+    std::string_view parent;
+    if (!fits(record, 16) || !str(u32(record), &out->name) || !str(u32(record + 4), &parent))
+        return false;
+    int delta = 0;
+    if (!hidden.empty() || !shifted.empty()) {
+        string name(out->name);
+        if (hidden.find(name) != nullptr)
+            return false;
+        int* d = shifted.find(name);
+        delta = d != nullptr ? *d : 0;
+    }
+
+    out->parent = parent;
+    out->line = (int) u32(record + 8) + delta;
+    out->members.clear();
+
+    size_t p = record + 16;
+    for (uint32_t m = u32(record + 12); m > 0; m--) {
+        InterfaceMember member;
+        if (!fits(p, 16))
+            return false;
+        uint32_t flags = u32(p + 12);
+        uint32_t params = flags >> 16;
+        member.kind = (SymbolKind) (flags & 0xFF);
+        if (!str(u32(p), &member.name) || !str(u32(p + 4), &member.type) || !fits(p + 16, (size_t) params * 4) ||
+            (member.kind != VARIABLE && member.kind != METHOD))
+            return false;
+        member.line = (int) u32(p + 8) + delta;
+        member.isArray = ((flags >> 8) & 0xFF) != 0;
+        p += 16;
+        member.params.resize(params);
+        for (uint32_t k = 0; k < params; k++, p += 4)
+            if (!str(u32(p), &member.params[k]))
+                return false;
+        out->members.push_back(member);
+    }
+    return true;
+}
+
+// Decodifica todas as classes (na ordem do índice).
+void ModuleInterface::readAll(std::vector<InterfaceClass>* out) {
+    uint32_t slots = data != nullptr ? u32(12) : 0;
+    for (uint32_t i = 0; i < slots; i++) {
+        uint32_t record = u32(u32(16) + (size_t) i * 8 + 4);
+        if (record == 0)
+            continue;
+        out->push_back(InterfaceClass());
+        if (!decode(record, &out->back()))
+            out->pop_back();
+    }
+}
+
+void ModuleInterface::hideClass(const string& name) {
+    hidden.insert(name, true);
+}
+
+void ModuleInterface::shiftClass(const string& name, int delta) {
+    shifted.insert(name, delta);
+}
+
+size_t ModuleInterface::classCount() {
+    return data != nullptr ? u32(8) : 0;
+}
+
+string ModuleInterface::getPath() {
+    return path;
+}
+
+// Interface de uma classe sem as linhas: decide se as classes que dependem dela mudam
+// (análise incremental do servidor de linguagem e de `--incremental`).
+string ModuleInterface::signatureOf(std::string_view name) {
+    InterfaceClass ic;
+    if (!findClass(name, &ic))
+        return "";
+    ic.line = 0;
+    for (InterfaceMember& m : ic.members)
+        m.line = 0;
+    return serialize(std::vector<InterfaceClass>(1, ic));
+}
+
+// Auxiliares de escrita: anexam inteiros e strings deduplicadas aos buffers.
+static void put32(string& buf, uint32_t v) {
+    buf.append((const char*) &v, 4);
+}
+
+static void set32(string& buf, size_t offset, uint32_t v) {
+    memcpy(&buf[offset], &v, 4);
+}
+
+StringSection::StringSection() {
+    ref("");
+}
+
+// As chaves ficam na arena, como no `Interner`: consultar um nome já visto (o caso comum
+// ao recombinar interfaces) não aloca.
+uint32_t StringSection::ref(std::string_view s) {
+    uint64_t hash = hashBytes(s.data(), s.size());
+    uint32_t* found = offsets.findHashed(s, hash);
+    if (found != nullptr)
+        return *found;
+    uint32_t offset = (uint32_t) bytes.size();
+    put32(bytes, (uint32_t) s.size());
+    bytes.append(s.data(), s.size());
+    bytes.append((4 - bytes.size() % 4) % 4, '\0');
+    offsets.insertHashed(std::string_view(keys.copyString(s.data(), s.size()), s.size()), hash, offset);
+    return offset;
+}
+
+bool ModuleInterface::write(const string& fileName, SymbolTable* global) {
+    // Escrita atômica: um processo que esteja mapeando a interface anterior (como o daemon)
+    // nunca vê um arquivo truncado.
+    return CompilationCache::writeAtomically(fileName, serialize(global));
+}
+
+// Monta o arquivo de interface classe a classe; usado tanto para as classes de uma
+// compilação quanto para combinar registros já decodificados.
+class InterfaceWriter {
+public:
+    void beginClass(std::string_view name, std::string_view parent, int line, size_t memberCount) {
+        uint32_t offset = (uint32_t) records.size();
+        entries.push_back({ (uint32_t) hashBytes(name.data(), name.size()), offset });
+        put32(records, strings.ref(name));
+        put32(records, strings.ref(parent));
+        put32(records, (uint32_t) line);
+        put32(records, (uint32_t) memberCount);
+    }
+
+    template <typename Names>
+    void member(std::string_view name, std::string_view type, int line, SymbolKind kind, bool isArray,
+                const Names& params) {
+        put32(records, strings.ref(name));
+        put32(records, strings.ref(type));
+        put32(records, (uint32_t) line);
+        put32(records, (uint32_t) kind | (isArray ? 1u << 8 : 0) | ((uint32_t) params.size() << 16));
+        for (auto& p : params)
+            put32(records, strings.ref(p));
+    }
+
+    string finish();
+
+private:
+    StringSection strings;
+    string records;
+    std::vector<std::pair<uint32_t, uint32_t>> entries; // {hash, offset relativo do registro}
+};
+
+string InterfaceWriter::finish() {
+    uint32_t slots = 1;
+    while (slots < entries.size() * 2)
+        slots *= 2;
+
+    uint32_t indexOffset = (uint32_t) HEADER_SIZE;
+    uint32_t recordsOffset = indexOffset + slots * 8;
+    uint32_t stringsOffset = recordsOffset + (uint32_t) records.size();
+    uint32_t fileSize = stringsOffset + (uint32_t) strings.bytes.size();
+
+    string index(slots * 8, '\0');
+    for (auto& e : entries) {
+        uint32_t i = e.first & (slots - 1);
+        while (index[i * 8 + 4] || index[i * 8 + 5] || index[i * 8 + 6] || index[i * 8 + 7])
+            i = (i + 1) & (slots - 1);
+        set32(index, i * 8, e.first);
+        set32(index, i * 8 + 4, recordsOffset + e.second);
+    }
+
+    // Offsets de seções e registros são absolutos; referências a strings são relativas à tabela de strings.
+    string header(MAGIC, 4);
+    put32(header, VERSION);
+    put32(header, (uint32_t) entries.size());
+    put32(header, slots);
+    put32(header, indexOffset);
+    put32(header, stringsOffset);
+    put32(header, (uint32_t) strings.bytes.size());
+    put32(header, fileSize);
+
+    return header + index + records + strings.bytes;
+}
+
+string ModuleInterface::serialize(SymbolTable* global) {
+    ClassHierarchy* classes = global->classes;
+    TypeTable* types = global->types;
+    InterfaceWriter writer;
+    std::vector<string> paramNames;
+
+    for (size_t i = 0; i < classes->size(); i++) {
+        TypeId cls = classes->classAt(i);
+        if (classes->isImported(cls))
+            continue;
+
+        // Membros próprios, em ordem de slot, para que a importação reproduza a mesma numeração.
+        std::vector<std::pair<Atom, const ClassHierarchy::Member*>> own;
+        classes->forEachMember(cls, [&](Atom name, const ClassHierarchy::Member& m) {
+            if (m.owner == cls)
+                own.push_back({ name, &m });
+        });
+        std::sort(own.begin(), own.end(), [](const std::pair<Atom, const ClassHierarchy::Member*>& x,
+                                             const std::pair<Atom, const ClassHierarchy::Member*>& y) {
+            if (x.second->kind != y.second->kind)
+                return x.second->kind < y.second->kind;
+            return x.second->slot < y.second->slot;
+        });
+
+        TypeId parent = classes->parentOf(cls);
+        writer.beginClass(types->name(cls), parent == NO_TYPE ? "" : types->name(parent), classes->lineOf(cls), own.size());
+
+        const std::vector<TypeId>& params = classes->params(cls);
+        for (auto& o : own) {
+            const ClassHierarchy::Member* m = o.second;
+            paramNames.clear();
+            for (int k = 0; k < m->paramCount; k++)
+                paramNames.push_back(types->name(params[m->firstParam + k]));
+            writer.member(global->nameOf(o.first), types->name(m->type), m->line, m->kind, m->isArray, paramNames);
+        }
+    }
+    return writer.finish();
+}
+
+// Combina classes decodificadas (de uma ou mais interfaces) em um novo arquivo.
+string ModuleInterface::serialize(const std::vector<InterfaceClass>& classes) {
+    InterfaceWriter writer;
+
+    for (const InterfaceClass& c : classes) {
+        writer.beginClass(c.name, c.parent, c.line, c.members.size());
+        for (const InterfaceMember& m : c.members)
+            writer.member(m.name, m.type, m.line, m.kind, m.isArray, m.params);
+    }
+    return writer.finish();
+}
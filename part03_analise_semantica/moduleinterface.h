@@ -0,0 +1,71 @@
+#include "superheader.h"
+
+class SymbolTable;
+
+// Tabela de strings dos arquivos binários: {tamanho, bytes} alinhados em 4 bytes,
+// referenciados por offset (o offset 0 é a string vazia). Cada string é gravada uma vez.
+// Usada também pelo índice de referências (`XrefIndex`).
+struct StringSection {
+    string bytes;
+    Arena keys;
+    FlatHashMap<std::string_view, uint32_t> offsets;
+
+    StringSection();
+    uint32_t ref(std::string_view s);
+};
+
+// A classe `ModuleInterface` lê e escreve arquivos de interface (.xpi) com as classes de uma
+// compilação: nome, classe pai, campos (tipo e flag de array) e assinaturas de métodos.
+//
+// Formato (inteiros de 32 bits little-endian, alinhados em 4 bytes):
+//   cabeçalho  "XPPI", versão, nº de classes, nº de slots do índice, offset do índice,
+//              offset e tamanho da tabela de strings, tamanho do arquivo
+//   índice     tabela hash aberta de {hash do nome, offset do registro} (0 = vazio)
+//   registros  {nome, pai, linha, nº de membros} seguidos dos membros
+//              {nome, tipo, linha, tipo(8)|array(8)|nº de parâmetros(16), parâmetros...}
+//   strings    {tamanho, bytes} referenciadas por offset; o offset 0 é a string vazia
+//
+// O arquivo é mapeado em memória (mmap) e nada é decodificado na abertura: cada busca
+// consulta o índice e decodifica apenas o registro da classe pedida.
+class ModuleInterface : public ClassSource {
+public:
+    ModuleInterface();
+    ~ModuleInterface();
+
+    bool open(const string& path);                              // Mapeia e valida o arquivo.
+    bool openBuffer(const string& name, const string& bytes);   // Usa uma interface em memória.
+    bool findClass(std::string_view name, InterfaceClass* out) override; // Busca e decodifica uma classe.
+    void readAll(std::vector<InterfaceClass>* out);             // Decodifica todas as classes.
+    size_t classCount();
+    string getPath();
+    string signatureOf(std::string_view name); // Interface da classe sem as linhas (vazia se ausente).
+
+    // Ajustes aplicados na leitura, para reaproveitar a interface de uma compilação anterior
+    // (compilação incremental): uma classe oculta não é encontrada e uma classe deslocada tem
+    // as suas linhas somadas a `delta`. O arquivo não é alterado.
+    void hideClass(const string& name);
+    void shiftClass(const string& name, int delta);
+
+    // Escreve a interface das classes declaradas (não importadas) na compilação de `global`.
+    static bool write(const string& path, SymbolTable* global);
+    static string serialize(SymbolTable* global); // Conteúdo do arquivo, sem gravá-lo.
+    static string serialize(const std::vector<InterfaceClass>& classes); // Combina classes decodificadas.
+
+private:
+    string path;
+    const uint8_t* data;      // Conteúdo do arquivo.
+    size_t size;
+    std::vector<uint8_t> buffer; // Usado quando não há mmap (Windows).
+    bool mapped;
+    FlatHashMap<string, bool> hidden;
+    FlatHashMap<string, int> shifted;
+
+    bool validate();
+    bool decode(uint32_t record, InterfaceClass* out); // `false` se a classe está oculta ou o registro é inválido.
+    bool fits(size_t offset, size_t bytes);            // [offset, offset + bytes) dentro da seção de registros.
+    uint32_t u32(size_t offset);
+    bool str(uint32_t offset, std::string_view* out);  // `false` se a string sai da tabela de strings.
+
+    ModuleInterface(const ModuleInterface&);
+    ModuleInterface& operator=(const ModuleInterface&);
+};
@@ -0,0 +1,206 @@
+#include "superheader.h"
+
+namespace {
+
+enum OutlineTokenKind { OT_ID, OT_STRING, OT_LBRACE, OT_RBRACE, OT_LSQUARE, OT_RSQUARE, OT_OTHER, OT_END };
+
+struct OutlineToken {
+    OutlineTokenKind kind;
+    std::string_view text;
+    size_t start;
+    int line;
+};
+
+// Classes de caractere por byte: a varredura percorre o arquivo inteiro a cada compilação
+// incremental, então evita as funções de <cctype>, que consultam o locale.
+enum { CH_SPACE = 1, CH_ALPHA = 2, CH_DIGIT = 4 };
+
+struct CharClasses {
+    unsigned char table[256];
+
+    CharClasses() {
+        memset(table, 0, sizeof(table));
+        for (const char* c = " \t\n\v\f\r"; *c; c++)
+            table[(unsigned char) *c] = CH_SPACE;
+        for (int c = 'a'; c <= 'z'; c++)
+            table[c] = table[c - 'a' + 'A'] = CH_ALPHA;
+        table['_'] = CH_ALPHA;
+        for (int c = '0'; c <= '9'; c++)
+            table[c] = CH_DIGIT;
+    }
+};
+
+const CharClasses charClasses;
+
+inline bool isSpace(char c) { return charClasses.table[(unsigned char) c] & CH_SPACE; }
+inline bool isIdentifierStart(char c) { return charClasses.table[(unsigned char) c] & CH_ALPHA; }
+inline bool isIdentifierPart(char c) { return charClasses.table[(unsigned char) c] & (CH_ALPHA | CH_DIGIT); }
+
+// Lexer mínimo: identificadores, strings, chaves e colchetes; o resto vira OT_OTHER (com o
+// caractere em `text`). Comentários são pulados e strings viram um único token, para que
+// chaves dentro deles não sejam contadas.
+struct OutlineLexer {
+    const string& src;
+    size_t pos;
+    int line;
+
+    OutlineToken next() {
+        for (;;) {
+            while (pos < src.size() && isSpace(src[pos])) {
+                if (src[pos] == '\n')
+                    line++;
+                pos++;
+            }
+            if (pos + 1 < src.size() && src[pos] == '/' && src[pos + 1] == '/') {
+                while (pos < src.size() && src[pos] != '\n')
+                    pos++;
+                continue;
+            }
+            if (pos + 1 < src.size() && src[pos] == '/' && src[pos + 1] == '*') {
+                pos += 2;
+                while (pos + 1 < src.size() && !(src[pos] == '*' && src[pos + 1] == '/')) {
+                    if (src[pos] == '\n')
+                        line++;
+                    pos++;
+                }
+                pos = std::min(pos + 2, src.size());
+                continue;
+            }
+            break;
+        }
+
+        OutlineToken t = { OT_END, std::string_view(), pos, line };
+        if (pos >= src.size())
+            return t;
+
+        char c = src[pos];
+        if (isIdentifierStart(c)) {
+            size_t begin = pos;
+            while (pos < src.size() && isIdentifierPart(src[pos]))
+                pos++;
+            t.kind = OT_ID;
+            t.text = std::string_view(src.data() + begin, pos - begin);
+            return t;
+        }
+
+        if (c == '"') {
+            size_t begin = ++pos;
+            while (pos < src.size() && src[pos] != '"' && src[pos] != '\n')
+                pos++;
+            t.kind = OT_STRING;
+            t.text = std::string_view(src.data() + begin, pos - begin);
+            if (pos < src.size() && src[pos] == '"')
+                pos++;
+            return t;
+        }
+
+        t.text = std::string_view(src.data() + pos, 1);
+        pos++;
+        t.kind = c == '{' ? OT_LBRACE : c == '}' ? OT_RBRACE : c == '[' ? OT_LSQUARE : c == ']' ? OT_RSQUARE : OT_OTHER;
+        return t;
+    }
+};
+
+bool isKeyword(std::string_view s) {
+    static const std::string_view keywords[] = { "class", "extends", "int", "string", "break", "print", "read",
+                                                 "return", "super", "if", "else", "for", "new", "constructor",
+                                                 "import" };
+    for (std::string_view k : keywords)
+        if (s == k)
+            return true;
+    return false;
+}
+
+// Importações do início do arquivo. Para no primeiro token que não inicia uma importação
+// (o lexer fica antes dele); `false` se uma importação está incompleta.
+bool readImports(OutlineLexer& lexer, std::vector<OutlineImport>* imports) {
+    for (;;) {
+        size_t pos = lexer.pos;
+        int line = lexer.line;
+        OutlineToken t = lexer.next();
+        if (t.kind != OT_ID || t.text != "import") {
+            lexer.pos = pos;
+            lexer.line = line;
+            return true;
+        }
+        OutlineToken path = lexer.next();
+        OutlineToken semicolon = lexer.next();
+        if (path.kind != OT_STRING || semicolon.kind != OT_OTHER || semicolon.text != ";")
+            return false;
+        imports->push_back({ string(path.text), t.line });
+    }
+}
+
+} // namespace
+
+void Outline::scanImports(const string& source) {
+    imports.clear();
+    OutlineLexer lexer = { source, 0, 1 };
+    readImports(lexer, &imports);
+}
+
+bool Outline::scan(const string& source) {
+    imports.clear();
+    classes.clear();
+    OutlineLexer lexer = { source, 0, 1 };
+    if (!readImports(lexer, &imports))
+        return false;
+
+    for (OutlineToken t = lexer.next(); t.kind != OT_END; t = lexer.next()) {
+        if (t.kind != OT_ID || t.text != "class")
+            return false;
+
+        OutlineClass c;
+        c.start = t.start;
+        c.line = t.line;
+
+        OutlineToken name = lexer.next();
+        if (name.kind != OT_ID)
+            return false;
+        c.name = string(name.text);
+
+        OutlineToken brace = lexer.next();
+        if (brace.kind == OT_ID && brace.text == "extends") {
+            OutlineToken parent = lexer.next();
+            if (parent.kind != OT_ID)
+                return false;
+            c.parent = string(parent.text);
+            c.deps.push_back(c.parent);
+            brace = lexer.next();
+        }
+        if (brace.kind != OT_LBRACE)
+            return false;
+
+        // Corpo: últimos três tokens bastam para reconhecer as posições de tipo.
+        OutlineToken prev[3] = { brace, brace, brace };
+        int depth = 1;
+        while (depth > 0) {
+            OutlineToken b = lexer.next();
+            if (b.kind == OT_END)
+                return false;
+            if (b.kind == OT_LBRACE)
+                depth++;
+            else if (b.kind == OT_RBRACE)
+                depth--;
+            else if (b.kind == OT_ID) {
+                if (prev[0].kind == OT_ID && prev[0].text == "new")
+                    c.deps.push_back(string(b.text));
+                else if (prev[0].kind == OT_ID && !isKeyword(prev[0].text) && !isKeyword(b.text))
+                    c.deps.push_back(string(prev[0].text));
+                else if (prev[0].kind == OT_RSQUARE && prev[1].kind == OT_LSQUARE && prev[2].kind == OT_ID &&
+                         !isKeyword(prev[2].text))
+                    c.deps.push_back(string(prev[2].text));
+            }
+            prev[2] = prev[1];
+            prev[1] = prev[0];
+            prev[0] = b;
+        }
+
+        c.end = lexer.pos;
+        c.hash = hashBytes(source.data() + c.start, c.end - c.start);
+        std::sort(c.deps.begin(), c.deps.end());
+        c.deps.erase(std::unique(c.deps.begin(), c.deps.end()), c.deps.end());
+        classes.push_back(c);
+    }
+    return true;
+}
@@ -0,0 +1,37 @@
+#include "superheader.h"
+
+// Esboço de uma classe no fonte: posição, hash do texto e nomes dos quais ela depende.
+struct OutlineClass {
+    string name;
+    string parent;            // Vazio se a classe não herda de nenhuma outra.
+    size_t start, end;        // Intervalo [start, end) no fonte, de `class` até o `}` final.
+    int line;                 // Linha da palavra `class`.
+    uint64_t hash;            // Hash do texto da classe.
+    std::vector<string> deps; // Classe pai, tipos de campos/parâmetros/retornos e alvos de `new`.
+};
+
+// Importação no início do arquivo: `import "caminho";`.
+struct OutlineImport {
+    string path;              // Como escrito, relativo ao arquivo que importa.
+    int line;
+};
+
+// A classe `Outline` faz uma varredura leve do fonte, sem análise sintática, para localizar
+// as classes e as suas dependências. Ela reconhece identificadores, comentários, strings e
+// chaves; o conteúdo das classes não é validado (isso fica para o parser).
+//
+// Dependências de uma classe: o `extends`, todo identificador em posição de tipo
+// (`Tipo nome`, `Tipo [] nome`) e todo alvo de `new Tipo`. A lista pode conter nomes que
+// não são classes do arquivo; quem a usa só considera os nomes relevantes.
+class Outline {
+public:
+    std::vector<OutlineImport> imports;
+    std::vector<OutlineClass> classes;
+
+    // Retorna `false` se o fonte não tem a forma "import ...; class ... { ... }" em nível
+    // superior; nesse caso o chamador deve tratar o arquivo inteiro como alterado.
+    bool scan(const string& source);
+
+    // Lê apenas as importações do início do arquivo, parando no primeiro outro token.
+    void scanImports(const string& source);
+};
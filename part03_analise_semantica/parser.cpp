@@ -6,22 +6,66 @@
 *
 ***********************************************************/
 
-Parser::Parser(string input, SymbolTable* st) {
+Parser::Parser(string input, SymbolTable* st, ostream& o) {
+    init(new Scanner(input, st, o), st, o);
+}
+
+Parser::Parser(Scanner* s, SymbolTable* st, ostream& o) {
+    init(s, st, o);
+}
+
+void Parser::init(Scanner* s, SymbolTable* st, ostream& o) {
+    scanner = s;
+    out = &o;
     symbolTable = st;
     currentScope = st;
     currentClass = "";
-    currentType = "";
+    currentClassType = NO_TYPE;
+    classScope = nullptr;
+    currentType = NO_TYPE;
     currentIsArray = false;
-    scanner = new Scanner(input, symbolTable);
-    advance();
+    lToken = nullptr;
+    xref = nullptr;
+}
+
+void Parser::setCrossReference(CrossReference* x) {
+    xref = x;
+}
+
+const std::vector<Diagnostic>& Parser::getDiagnostics() {
+    return diagnostics;
 }
 
-void Parser::run() {
+// O parser é dono do scanner e dos escopos que criou; as entradas ficam na arena da
+// compilação e são liberadas junto com a tabela raiz.
+Parser::~Parser() {
+    while (currentScope != symbolTable)
+        exitScope();
+    for (SymbolTable* scope : scopePool)
+        delete scope;
+    delete scanner;
+}
+
+// Erros léxicos, sintáticos e semânticos interrompem a análise lançando `CompileError`;
+// o diagnóstico é guardado e exibido aqui (sem flush: quem fornece `out` decide quando
+// escrever) e o resultado indica se a compilação teve sucesso.
+bool Parser::run() {
+    PhaseTimer timer(TIME_SYNTAX);
+    TraceSpan span("fase", "analise");
+    AllocationScope allocations(ALLOC_PARSER);
     try {
+        advance();
         Program();
-        cout << "\n[SUCESSO] Compilacao finalizada com sucesso." << endl;
-    } catch (const runtime_error& e) {
-        cout << e.what() << endl;
+        *out << "\n[SUCESSO] Compilacao finalizada com sucesso.\n";
+        return true;
+    } catch (const CompileError& e) {
+        AllocationScope allocations(ALLOC_DIAGNOSTICS);
+        // Erros sem linha vêm de fora do parser (interfaces importadas): ficam no token atual.
+        Diagnostic d = e.diagnostic().line > 0 ? e.diagnostic()
+                                               : diagnosticAt(e.diagnostic().phase, e.diagnostic().message, scanner->getLine());
+        diagnostics.push_back(d);
+        *out << DiagnosticWriter::human(d);
+        return false;
     }
 }
 
@@ -33,10 +77,8 @@ void Parser::match(int t) {
     if (lToken->type == t) {
         advance();
     } else {
-        cout << "\n[ERRO SINTATICO] Linha " << scanner->getLine() << ": esperava '" 
-             << Token::getTokenTypeName(t) << "' mas encontrou '" 
-             << Token::getTokenTypeName(lToken->type) << "'" << endl;
-        exit(EXIT_FAILURE);
+        error("esperava '" + Token::getTokenTypeName(t) + "' mas encontrou '"
+              + Token::getTokenTypeName(lToken->type) + "'");
     }
 }
 
@@ -46,10 +88,31 @@ void Parser::match(int t) {
 *
 ***********************************************************/
 
-// Regra 1: Program → ClassList
+// Regra 1: Program → ImportListOpt ClassList
 void Parser::Program() {
+    ImportListOpt();
     ClassList();
     match(END_OF_FILE);
+    
+    // ANÁLISE SEMÂNTICA: Todas as classes foram declaradas; constrói o índice de herança.
+    checkHierarchy();
+}
+
+/**********************************************************
+*
+*                       IMPORT LIST
+*
+***********************************************************/
+
+// Regra 1.1: ImportListOpt → import STRING_LITERAL ; ImportListOpt | ε
+// Os arquivos importados são resolvidos antes da análise (ver `ProgramBuild`): as suas
+// classes chegam a este parser como interfaces importadas.
+void Parser::ImportListOpt() {
+    while (lToken->type == IMPORT) {
+        advance();
+        match(STRING_LITERAL);
+        match(SEMICOLON);
+    }
 }
 
 /**********************************************************
@@ -80,7 +143,13 @@ void Parser::ClassDecl() {
         error("Nome da classe esperado");
     }
     string className = lToken->lexeme;
+    TraceSpan span("classe", className);
     currentClass = className;
+    Occurrence declaration;
+    if (xref != nullptr) {
+        declaration = tokenOccurrence(CLASS_NAME, true);
+        declaration.owner = className;
+    }
     match(ID);
     
     string parentClass = "";
@@ -90,18 +159,30 @@ void Parser::ClassDecl() {
             error("Nome da classe pai esperado");
         }
         parentClass = lToken->lexeme;
+        if (xref != nullptr) {
+            recordClassUse();
+        }
         match(ID); // Espera o identificador da classe pai.
     }
+    if (xref != nullptr) {
+        declaration.type = parentClass;
+        xref->add(declaration);
+    }
     
     // ANÁLISE SEMÂNTICA: Declara a classe na tabela de símbolos.
     declareClass(className, parentClass);
+    currentClassType = symbolTable->types->classType(symbolTable->intern(className));
     
     enterScope();
+    classScope = currentScope;
     
     ClassBody(); // Analisa o corpo da classe.
+    checkPendingMembers();
     
     exitScope();
     currentClass = "";
+    currentClassType = NO_TYPE;
+    classScope = nullptr;
 }
 
 /**********************************************************
@@ -136,12 +217,12 @@ void Parser::VarDeclListOpt() {
 
 // Regra VarDecl → Type ID VarDeclOpt ; | Type [] ID VarDeclOpt ;
 void Parser::VarDecl() {
-    currentType = lToken->lexeme;
-    Type(); // Analisa o tipo da variavel.
+    currentType = Type(); // Analisa o tipo da variavel.
     
     currentIsArray = false;
     if (lToken->type == LEFT_SQUARE_BRACKET) {
         currentIsArray = true;
+        currentType = symbolTable->types->arrayOf(currentType);
         advance();
         match(RIGHT_SQUARE_BRACKET);
     }
@@ -153,6 +234,9 @@ void Parser::VarDecl() {
     // ANÁLISE SEMÂNTICA: Declara a primeira variável.
     string varName = lToken->lexeme;
     declareVariable(varName, currentType, currentIsArray);
+    if (xref != nullptr) {
+        recordDeclaration(VARIABLE);
+    }
     
     advance(); // Consome o ID.
     
@@ -172,6 +256,9 @@ void Parser::VarDeclOpt() {
         // ANÁLISE SEMÂNTICA: Declara variável adicional com o mesmo tipo.
         string varName = lToken->lexeme;
         declareVariable(varName, currentType, currentIsArray);
+        if (xref != nullptr) {
+            recordDeclaration(VARIABLE);
+        }
         
         match(ID); // Espera o proximo identificador.
         VarDeclOpt(); // Verifica se ha mais variaveis.
@@ -179,11 +266,18 @@ void Parser::VarDeclOpt() {
 }
 
 // Regra Type → int | string | ID
-void Parser::Type() {
+// Retorna o `TypeId` internalizado do tipo reconhecido.
+TypeId Parser::Type() {
     if (lToken->type == INT || lToken->type == STRING || lToken->type == ID) {
+        TypeId type = symbolTable->types->fromToken(lToken);
+        if (xref != nullptr && lToken->type == ID) {
+            recordClassUse();
+        }
         advance(); // Avanca se o tipo for valido.
+        return type;
     } else {
         error("Tipo esperado (int, string ou ID)");
+        return NO_TYPE;
     }
 }
 
@@ -244,12 +338,12 @@ void Parser::MethodDeclList() {
 
 // Regra MethodDecl → Type ID MethodBody | Type [] ID MethodBody
 void Parser::MethodDecl() {
-    currentType = lToken->lexeme;
-    Type(); // Analisa o tipo de retorno.
+    currentType = Type(); // Analisa o tipo de retorno.
     
     currentIsArray = false;
     if (lToken->type == LEFT_SQUARE_BRACKET) {
         currentIsArray = true;
+        currentType = symbolTable->types->arrayOf(currentType);
         advance();
         match(RIGHT_SQUARE_BRACKET);
     }
@@ -258,9 +352,13 @@ void Parser::MethodDecl() {
         error("Nome do metodo esperado");
     }
     string methodName = lToken->lexeme;
+    TraceSpan span("metodo", methodName);
     
     // ANÁLISE SEMÂNTICA: Declara o método.
     declareMethod(methodName, currentType, currentIsArray);
+    if (xref != nullptr) {
+        recordDeclaration(METHOD);
+    }
     
     match(ID); // Espera o identificador (nome do metodo).
     
@@ -268,10 +366,15 @@ void Parser::MethodDecl() {
     enterScope();
     MethodBody(); // Analisa o corpo do metodo.
     exitScope();
+    
+    // ANÁLISE SEMÂNTICA: Registra a assinatura do método na tabela de membros da classe.
+    AllocationScope allocations(ALLOC_SYMBOLS);
+    symbolTable->classes->setParams(currentClassType, symbolTable->intern(methodName), currentParams);
 }
 
 // Regra MethodBody → ( ParamListOpt ) { StatementsOpt }
 void Parser::MethodBody() {
+    currentParams.clear();
     match(LEFT_BRACKET); // Abre lista de parametros.
     ParamListOpt(); // Analisa parametros (opcional).
     match(RIGHT_BRACKET); // Fecha lista de parametros.
@@ -304,12 +407,12 @@ void Parser::ParamList() {
 
 // Regra Param → Type ID | Type [] ID
 void Parser::Param() {
-    currentType = lToken->lexeme;
-    Type(); // Analisa o tipo do parametro.
+    currentType = Type(); // Analisa o tipo do parametro.
     
     currentIsArray = false;
     if (lToken->type == LEFT_SQUARE_BRACKET) {
         currentIsArray = true;
+        currentType = symbolTable->types->arrayOf(currentType);
         advance();
         match(RIGHT_SQUARE_BRACKET);
     }
@@ -320,12 +423,16 @@ void Parser::Param() {
     string paramName = lToken->lexeme;
     
     // ANÁLISE SEMÂNTICA: Declara o parâmetro como variável no escopo do método.
-    Token* paramToken = new Token(ID, paramName);
-    STEntry* paramEntry = new STEntry(paramToken, PARAMETER, currentType, currentIsArray, scanner->getLine());
+    STEntry* paramEntry = new (symbolTable->arena) STEntry(symbolTable->intern(paramName), PARAMETER,
+                                                           currentType, currentIsArray, scanner->getLine());
     
     if (!currentScope->add(paramEntry)) {
         semanticError("Parametro '" + paramName + "' ja foi declarado");
     }
+    currentParams.push_back(currentType);
+    if (xref != nullptr) {
+        recordDeclaration(PARAMETER);
+    }
     
     // cout << "[SEMANTICO] Parametro '" << paramName << "' do tipo '" << currentType;
     // if (currentIsArray) cout << "[]";
@@ -407,11 +514,12 @@ void Parser::Statement() {
 
 // Regra AtribStat → LValue = Expression | LValue = AllocExpression
 void Parser::AtribStat() {
-    LValue(); // Lado esquerdo da atribuicao (variavel, array, ou membro).
+    TypeId target = LValue(); // Lado esquerdo da atribuicao (variavel, array, ou membro).
     match(ASSIGNMENT); // Espera o operador de atribuicao '='.
     
     if (lToken->type == NEW || lToken->type == INT || lToken->type == STRING) {
-        AllocExpression(); // Alocacao de objeto ou array.
+        // ANÁLISE SEMÂNTICA: O tipo alocado deve ser compatível com o lado esquerdo.
+        checkAssignable(target, AllocExpression()); // Alocacao de objeto ou array.
     } else {
         Expression(); // Expressao comum.
     }
@@ -437,6 +545,11 @@ void Parser::ReturnStat() {
 
 // Regra SuperStat → super ( ArgListOpt )
 void Parser::SuperStat() {
+    // ANÁLISE SEMÂNTICA: super só faz sentido em classes que herdam de outra.
+    if (symbolTable->classes->parentOf(currentClassType) == NO_TYPE) {
+        semanticError("'super' usado na classe '" + currentClass + "', que nao possui superclasse");
+    }
+    
     match(SUPER); // Espera a palavra reservada 'super'.
     match(LEFT_BRACKET); // Abre lista de argumentos.
     ArgListOpt(); // Argumentos para o construtor pai (opcional).
@@ -522,7 +635,8 @@ void Parser::ExpressionOpt() {
 ***********************************************************/
 
 // Regra LValue → ID LValueComp
-void Parser::LValue() {
+// Retorna o tipo do LValue, ou NO_TYPE quando ele não pode ser determinado.
+TypeId Parser::LValue() {
     if (lToken->type != ID) {
         error("Identificador esperado");
     }
@@ -530,10 +644,10 @@ void Parser::LValue() {
     string varName = lToken->lexeme;
     
     // ANÁLISE SEMÂNTICA: Verifica se a variável foi declarada.
-    checkVariableDeclared(varName);
+    TypeId type = checkVariableDeclared(varName);
     
     match(ID); // Identificador inicial.
-    LValueComp(); // Complemento opcional (acesso a membro, array, ou metodo).
+    return LValueComp(type); // Complemento opcional (acesso a membro, array, ou metodo).
 }
 
 // Regra LValueComp → . ID LValueComp 
@@ -541,16 +655,39 @@ void Parser::LValue() {
 //                      | . ID ( ArgListOpt ) LValueComp 
 //                      | [ Expression ] LValueComp 
 //                      | ε
-void Parser::LValueComp() {
+// Recebe o tipo acumulado até aqui e retorna o tipo do LValue completo.
+TypeId Parser::LValueComp(TypeId type) {
     if (lToken->type == DOT) {
         advance(); // Consome o ponto (acesso a membro).
+        
+        string memberName = lToken->lexeme;
+        Occurrence use;
+        if (xref != nullptr) {
+            use = tokenOccurrence(VARIABLE, false);
+        }
         match(ID); // Identificador do membro.
         
+        // ANÁLISE SEMÂNTICA: Resolve o membro na tabela achatada da classe do objeto.
+        SymbolKind kind = lToken->type == LEFT_BRACKET ? METHOD : VARIABLE;
+        const ClassHierarchy::Member* member = resolveMember(type, memberName, kind);
+        TypeId memberType = member != nullptr ? member->type : NO_TYPE;
+        if (xref != nullptr && (member != nullptr || type == currentClassType)) {
+            use.kind = kind; // Membro da própria classe ainda não declarado: resolvido pelo nome.
+            use.field = kind == VARIABLE;
+            use.owner = currentClass;
+            recordMemberUse(use, member);
+        }
+        
         if (lToken->type == LEFT_SQUARE_BRACKET) {
             // Acesso a array: .ID[expr]
             advance();
             Expression(); // Indice do array.
             match(RIGHT_SQUARE_BRACKET);
+            
+            if (member != nullptr && !symbolTable->types->isArray(memberType)) {
+                semanticError("Membro '" + memberName + "' nao e um array");
+            }
+            memberType = memberType != NO_TYPE ? symbolTable->types->elementOf(memberType) : NO_TYPE;
         } else if (lToken->type == LEFT_BRACKET) {
             // Chamada de metodo: .ID(args)
             advance();
@@ -558,16 +695,19 @@ void Parser::LValueComp() {
             match(RIGHT_BRACKET);
         }
         
-        LValueComp(); // Permite encadeamento: obj.member.method()
+        return LValueComp(memberType); // Permite encadeamento: obj.member.method()
     }
     else if (lToken->type == LEFT_SQUARE_BRACKET) {
         // Acesso a array: [expr]
         advance();
         Expression(); // Indice do array.
         match(RIGHT_SQUARE_BRACKET);
-        LValueComp(); // Permite encadeamento: array[i].member
+        
+        TypeId element = symbolTable->types->isArray(type) ? symbolTable->types->elementOf(type) : NO_TYPE;
+        return LValueComp(element); // Permite encadeamento: array[i].member
     }
     // ε (epsilon - nada a fazer, fim do LValue)
+    return type;
 }
 
 /**********************************************************
@@ -589,7 +729,8 @@ void Parser::Expression() {
 }
 
 // Regra AllocExpression → new ID ( ArgListOpt ) | Type [ Expression ]
-void Parser::AllocExpression() {
+// Retorna o tipo alocado (a classe ou o array de elementos).
+TypeId Parser::AllocExpression() {
     if (lToken->type == NEW) {
         // Alocacao de objeto: new ID(args)
         advance(); // Consome 'new'.
@@ -602,6 +743,9 @@ void Parser::AllocExpression() {
         
         // ANÁLISE SEMÂNTICA: Verifica se a classe foi declarada.
         checkClassDeclared(className);
+        if (xref != nullptr) {
+            recordClassUse();
+        }
         
         // cout << "[SEMANTICO] Alocacao de objeto da classe '" << className 
         //     << "' na linha " << scanner->getLine() << endl;
@@ -610,6 +754,8 @@ void Parser::AllocExpression() {
         match(LEFT_BRACKET); // Abre argumentos do construtor.
         ArgListOpt(); // Argumentos (opcional).
         match(RIGHT_BRACKET); // Fecha argumentos do construtor.
+        
+        return symbolTable->types->classType(symbolTable->intern(className));
     }
     else if (lToken->type == INT || lToken->type == STRING || lToken->type == ID) {
         // Alocacao de array: Type[expr]
@@ -620,16 +766,19 @@ void Parser::AllocExpression() {
             checkClassDeclared(arrayType);
         }
         
-        Type(); // Tipo dos elementos.
+        TypeId elementType = Type(); // Tipo dos elementos.
         match(LEFT_SQUARE_BRACKET); // Abre tamanho do array.
         Expression(); // Tamanho do array.
         match(RIGHT_SQUARE_BRACKET); // Fecha tamanho do array.
         
         // cout << "[SEMANTICO] Alocacao de array do tipo '" << arrayType 
         //     << "' na linha " << scanner->getLine() << endl;
+        
+        return symbolTable->types->arrayOf(elementType);
     }
     else {
         error("AllocExpression esperada (new ID(...) ou Type[...])");
+        return NO_TYPE;
     }
 }
 
@@ -742,8 +891,8 @@ bool Parser::isStatement() {
 
 // Funcao para exibir mensagens de erro detalhadas.
 void Parser::error(string str) {
-    cout << "\n[ERRO SINTATICO] Linha " << scanner->getLine() << ": " << str << endl;
-    exit(EXIT_FAILURE);
+    AllocationScope allocations(ALLOC_DIAGNOSTICS);
+    throw CompileError(diagnosticAt(PHASE_SYNTAX, str, scanner->getLine()));
 }
 
 /**********************************************************
@@ -752,19 +901,44 @@ void Parser::error(string str) {
 *
 ***********************************************************/
 
+// Escopos são reaproveitados: ao sair, a tabela volta para `scopePool` e mantém a
+// capacidade alocada para o próximo método ou bloco.
 void Parser::enterScope() {
-    currentScope = new SymbolTable(currentScope);
+    PhaseTimer timer(TIME_SEMANTIC);
+    AllocationScope allocations(ALLOC_SYMBOLS);
+    XPP_STAT(scopes++);
+    XPP_STAT(scopeDepth++);
+    XPP_STAT(scopeDepthSum += compilerStats.scopeDepth);
+    XPP_STAT(scopeDepthMax = std::max(compilerStats.scopeDepthMax, compilerStats.scopeDepth));
+    if (scopePool.empty()) {
+        currentScope = new SymbolTable(currentScope);
+    } else {
+        SymbolTable* scope = scopePool.back();
+        scopePool.pop_back();
+        scope->parent = currentScope;
+        currentScope = scope;
+    }
+    XPP_PROBE2(scope__enter, currentScope, scanner->getLine());
 }
 
 void Parser::exitScope() {
+    PhaseTimer timer(TIME_SEMANTIC);
+    AllocationScope allocations(ALLOC_SYMBOLS);
     if (currentScope->getParent() != nullptr) {
+        XPP_PROBE2(scope__exit, currentScope, scanner->getLine());
+        XPP_STAT(scopeDepth--);
+        SymbolTable* scope = currentScope;
         currentScope = currentScope->getParent();
+        scope->clear();
+        scopePool.push_back(scope);
     }
 }
 
 // Declara uma classe na tabela de símbolos.
-void Parser::declareClass(string className, string parentClass) {
-    STEntry* existing = symbolTable->get(className);
+void Parser::declareClass(const string& className, const string& parentClass) {
+    PhaseTimer timer(TIME_SEMANTIC);
+    AllocationScope allocations(ALLOC_SYMBOLS);
+    STEntry* existing = symbolTable->getClass(className);
     
     // Verifica se já existe uma classe com esse nome.
     if (existing != nullptr && existing->kind == CLASS_NAME) {
@@ -773,20 +947,24 @@ void Parser::declareClass(string className, string parentClass) {
     
     // Se há classe pai, verifica se ela existe.
     if (!parentClass.empty()) {
-        STEntry* parent = symbolTable->get(parentClass);
+        STEntry* parent = symbolTable->getClass(parentClass);
         if (parent == nullptr || parent->kind != CLASS_NAME) {
             semanticError("Classe pai '" + parentClass + "' nao foi declarada");
         }
     }
     
-    // Cria entrada para a classe.
-    Token* classToken = new Token(ID, className);
-    STEntry* classEntry = new STEntry(classToken, CLASS_NAME, "class", false, scanner->getLine());
-    classEntry->parentClass = parentClass;
+    // Cria entrada para a classe e registra a classe no índice de herança.
+    Atom classAtom = symbolTable->intern(className);
+    TypeId parentType = parentClass.empty() ? NO_TYPE : symbolTable->types->classType(symbolTable->intern(parentClass));
+    symbolTable->classes->addClass(symbolTable->types->classType(classAtom), parentType, scanner->getLine());
+    STEntry* classEntry = new (symbolTable->arena) STEntry(classAtom, CLASS_NAME,
+                                                           symbolTable->types->classType(classAtom), false, scanner->getLine());
+    classEntry->parentClass = symbolTable->intern(parentClass);
     
     if (!symbolTable->add(classEntry)) {
         semanticError("Erro ao adicionar classe '" + className + "' na tabela de simbolos");
     }
+    XPP_PROBE3(class__declared, className.c_str(), parentClass.c_str(), scanner->getLine());
     
     // cout << "[SEMANTICO] Classe '" << className << "' declarada";
     // if (!parentClass.empty()) {
@@ -796,61 +974,78 @@ void Parser::declareClass(string className, string parentClass) {
 }
 
 // Declara uma variável na tabela de símbolos do escopo atual.
-void Parser::declareVariable(string varName, string varType, bool isArray) {
+void Parser::declareVariable(const string& varName, TypeId varType, bool isArray) {
+    PhaseTimer timer(TIME_SEMANTIC);
+    AllocationScope allocations(ALLOC_SYMBOLS);
     
     // Verifica se já existe no escopo ATUAL (não nos pais).
-    if (currentScope->symbols.find(varName) != currentScope->symbols.end()) {
-        STEntry* existing = currentScope->symbols[varName];
+    STEntry* existing = currentScope->getLocal(varName);
+    if (existing != nullptr) {
         semanticError("Variavel '" + varName + "' ja foi declarada na linha " + to_string(existing->line));
     }
     
     // Se o tipo é uma classe (ID), verifica se a classe existe.
-    if (varType != "int" && varType != "string") {
-        checkClassDeclared(varType);
-    }
+    checkTypeDeclared(varType);
     
     // Cria entrada para a variável.
-    Token* varToken = new Token(ID, varName);
-    STEntry* varEntry = new STEntry(varToken, VARIABLE, varType, isArray, scanner->getLine());
+    STEntry* varEntry = new (symbolTable->arena) STEntry(symbolTable->intern(varName), VARIABLE,
+                                                         varType, isArray, scanner->getLine());
     
     if (!currentScope->add(varEntry)) {
         semanticError("Erro ao adicionar variavel '" + varName + "' na tabela de simbolos");
     }
     
+    // Variáveis do corpo da classe também são campos na tabela de membros da classe.
+    if (currentScope == classScope) {
+        symbolTable->classes->addField(currentClassType, varEntry->name, varType, isArray, varEntry->line);
+    }
+    
     // cout << "[SEMANTICO] Variavel '" << varName << "' do tipo '" << varType;
     // if (isArray) cout << "[]";
     // cout << "' declarada na linha " << scanner->getLine() << endl;
 }
 
 // Declara um método na tabela de símbolos.
-void Parser::declareMethod(string methodName, string returnType, bool isArray) {
-    if (currentScope->symbols.find(methodName) != currentScope->symbols.end()) {
-        STEntry* existing = currentScope->symbols[methodName];
+void Parser::declareMethod(const string& methodName, TypeId returnType, bool isArray) {
+    PhaseTimer timer(TIME_SEMANTIC);
+    AllocationScope allocations(ALLOC_SYMBOLS);
+    STEntry* existing = currentScope->getLocal(methodName);
+    if (existing != nullptr) {
         semanticError("Metodo '" + methodName + "' ja foi declarado na linha " + to_string(existing->line));
     }
     
     // Se o tipo de retorno é uma classe, verifica se existe.
-    if (returnType != "int" && returnType != "string" && returnType != "void") {
-        checkClassDeclared(returnType);
-    }
+    checkTypeDeclared(returnType);
     
     // Cria entrada para o método.
-    Token* methodToken = new Token(ID, methodName);
-    STEntry* methodEntry = new STEntry(methodToken, METHOD, returnType, isArray, scanner->getLine());
+    STEntry* methodEntry = new (symbolTable->arena) STEntry(symbolTable->intern(methodName), METHOD,
+                                                            returnType, isArray, scanner->getLine());
     
     if (!currentScope->add(methodEntry)) {
         semanticError("Erro ao adicionar metodo '" + methodName + "' na tabela de simbolos");
     }
     
+    symbolTable->classes->addMethod(currentClassType, methodEntry->name, returnType, isArray, methodEntry->line);
+    XPP_PROBE3(method__declared, currentClass.c_str(), methodName.c_str(), methodEntry->line);
+    
     // cout << "[SEMANTICO] Metodo '" << methodName << "' com retorno '" << returnType;
     // if (isArray) cout << "[]";
     // cout << "' declarado na linha " << scanner->getLine() << endl;
 }
 
-void Parser::checkVariableDeclared(string varName) {
+TypeId Parser::checkVariableDeclared(const string& varName) {
+    PhaseTimer timer(TIME_SEMANTIC);
     STEntry* entry = currentScope->get(varName);
     
     if (entry == nullptr) {
+        // Membros herdados não estão nos escopos léxicos, mas sim na tabela achatada da classe.
+        const ClassHierarchy::Member* member = symbolTable->classes->findMember(currentClassType, symbolTable->intern(varName));
+        if (member != nullptr) {
+            if (xref != nullptr) {
+                recordMemberUse(tokenOccurrence(member->kind, false), member);
+            }
+            return member->type;
+        }
         semanticError("Variavel '" + varName + "' nao foi declarada");
     }
     
@@ -860,18 +1055,223 @@ void Parser::checkVariableDeclared(string varName) {
     
     // cout << "[SEMANTICO] Variavel '" << varName << "' usada na linha " << scanner->getLine() 
     //     << " (declarada na linha " << entry->line << ")" << endl;
+    
+    if (xref != nullptr) {
+        recordUse(entry);
+    }
+    return entry->type;
 }
 
-void Parser::checkClassDeclared(string className) {
-    STEntry* entry = symbolTable->get(className);
+void Parser::checkClassDeclared(const string& className) {
+    PhaseTimer timer(TIME_SEMANTIC);
+    STEntry* entry = symbolTable->getClass(className);
     
     if (entry == nullptr || entry->kind != CLASS_NAME) {
         semanticError("Classe '" + className + "' nao foi declarada");
     }
 }
 
+// Verifica a classe base de um tipo (removendo arrays); int e string são sempre válidos.
+void Parser::checkTypeDeclared(TypeId type) {
+    PhaseTimer timer(TIME_SEMANTIC);
+    TypeId base = symbolTable->types->baseOf(type);
+    
+    if (symbolTable->types->isClass(base)) {
+        STEntry* entry = symbolTable->getClass(symbolTable->types->name(base));
+        if (entry == nullptr || entry->kind != CLASS_NAME) {
+            semanticError("Classe '" + symbolTable->types->name(base) + "' nao foi declarada");
+        }
+    }
+}
+
+// Resolve o membro `memberName` em um objeto do tipo `type` (`kind` indica se o acesso é
+// uma chamada de método ou um campo). Retorna `nullptr` quando o tipo do objeto não é
+// conhecido, ou quando o membro pertence à classe atual e ainda não foi declarado; nesse
+// último caso a verificação fica para o fim da classe.
+const ClassHierarchy::Member* Parser::resolveMember(TypeId type, const string& memberName, SymbolKind kind) {
+    PhaseTimer timer(TIME_SEMANTIC);
+    TypeTable* types = symbolTable->types;
+    
+    if (type == NO_TYPE) {
+        return nullptr;
+    }
+    if (!types->isClass(type)) {
+        semanticError("Tipo '" + types->name(type) + "' nao possui membros (acesso a '" + memberName + "')");
+    }
+    if (!symbolTable->classes->contains(type) && symbolTable->getClass(types->name(type)) == nullptr) {
+        return nullptr; // Classe não declarada: reportada por checkClassDeclared/checkTypeDeclared.
+    }
+    
+    Atom name = symbolTable->intern(memberName);
+    const ClassHierarchy::Member* member = symbolTable->classes->findMember(type, name);
+    
+    if (member == nullptr) {
+        if (type == currentClassType) {
+            pendingMembers.push_back({ name, kind, scanner->getLine() });
+            return nullptr;
+        }
+        semanticError("Membro '" + memberName + "' nao existe na classe '" + types->name(type) + "'");
+    }
+    if (kind == METHOD && member->kind != METHOD) {
+        semanticError("'" + memberName + "' nao e um metodo da classe '" + types->name(type) + "'");
+    }
+    if (kind != METHOD && member->kind == METHOD) {
+        semanticError("Metodo '" + memberName + "' da classe '" + types->name(type) + "' usado sem chamada");
+    }
+    
+    return member;
+}
+
+// Ao final da classe todos os seus membros já foram declarados.
+void Parser::checkPendingMembers() {
+    PhaseTimer timer(TIME_SEMANTIC);
+    for (const PendingMember& p : pendingMembers) {
+        const ClassHierarchy::Member* member = symbolTable->classes->findMember(currentClassType, p.name);
+        string memberName = symbolTable->nameOf(p.name);
+        
+        if (member == nullptr) {
+            semanticError("Membro '" + memberName + "' nao existe na classe '" + currentClass + "'", p.line);
+        }
+        if (member->kind != p.kind) {
+            semanticError("Uso invalido do membro '" + memberName + "' da classe '" + currentClass + "'", p.line);
+        }
+    }
+    pendingMembers.clear();
+}
+
+// Verifica se um valor de tipo `value` pode ser atribuído a um LValue de tipo `target`.
+// Tipos desconhecidos (NO_TYPE) não são verificados. Entre classes a compatibilidade depende
+// do índice de herança, então a verificação é adiada até o fim do programa.
+void Parser::checkAssignable(TypeId target, TypeId value) {
+    PhaseTimer timer(TIME_SEMANTIC);
+    TypeTable* types = symbolTable->types;
+    
+    if (target == NO_TYPE || value == NO_TYPE) {
+        return;
+    }
+    
+    if (types->isClass(types->baseOf(target)) && types->isClass(types->baseOf(value))) {
+        pendingAssignments.push_back({ target, value, scanner->getLine() });
+    }
+    else if (!symbolTable->classes->isAssignable(target, value)) {
+        semanticError("Tipos incompativeis na atribuicao: '" + types->name(target) + "' recebe '" + types->name(value) + "'");
+    }
+}
+
+// Constrói o índice de herança (detectando ciclos de extends) e verifica as atribuições
+// entre classes que foram adiadas durante a análise.
+void Parser::checkHierarchy() {
+    PhaseTimer timer(TIME_SEMANTIC);
+    AllocationScope allocations(ALLOC_SYMBOLS);
+    std::vector<TypeId> cycle;
+    
+    if (!symbolTable->classes->build(&cycle)) {
+        string names;
+        for (TypeId t : cycle) {
+            names += (names.empty() ? "'" : " -> '") + symbolTable->types->name(t) + "'";
+        }
+        semanticError("Heranca ciclica entre as classes " + names, symbolTable->classes->lineOf(cycle[0]));
+    }
+    
+    for (const PendingAssignment& a : pendingAssignments) {
+        if (!symbolTable->classes->isAssignable(a.target, a.value)) {
+            semanticError("Tipos incompativeis na atribuicao: '" + symbolTable->types->name(a.target)
+                          + "' recebe '" + symbolTable->types->name(a.value) + "'", a.line);
+        }
+    }
+    pendingAssignments.clear();
+}
+
+/**********************************************************
+*
+*                   CROSS REFERENCES
+*
+***********************************************************/
+
+// Ocorrência do identificador no token atual, ainda sem o dono e o tipo.
+Occurrence Parser::tokenOccurrence(SymbolKind kind, bool declaration) {
+    Occurrence o;
+    o.line = scanner->getTokenLine();
+    o.column = scanner->getTokenColumn();
+    o.length = (int) lToken->lexeme.size();
+    o.declaration = declaration;
+    o.kind = kind;
+    o.field = false;
+    o.name = lToken->lexeme;
+    o.declLine = 0;
+    o.declColumn = 0;
+    return o;
+}
+
+// Campos e métodos são localizados pelo dono e pelo nome; locais e parâmetros, pela posição.
+void Parser::recordDeclaration(SymbolKind kind) {
+    Occurrence o = tokenOccurrence(kind, true);
+    o.owner = currentClass;
+    o.type = symbolTable->types->name(currentType);
+    o.field = kind == VARIABLE && currentScope == classScope;
+    if (kind == PARAMETER || (kind == VARIABLE && !o.field)) {
+        o.declLine = o.line;
+        o.declColumn = o.column;
+    }
+    xref->declare(currentScope->getLocal(o.name), o);
+}
+
+void Parser::recordUse(const STEntry* entry) {
+    Occurrence o = tokenOccurrence(entry->kind, false);
+    const Occurrence* d = xref->declarationOf(entry);
+    if (d != nullptr) {
+        o.kind = d->kind;
+        o.field = d->field;
+        o.owner = d->owner;
+        o.type = d->type;
+        o.declLine = d->declLine;
+        o.declColumn = d->declColumn;
+    } else {
+        o.owner = currentClass;
+        o.type = symbolTable->types->name(entry->type);
+    }
+    xref->add(o);
+}
+
+// `member` é `nullptr` quando o membro da classe atual ainda não foi declarado.
+void Parser::recordMemberUse(Occurrence o, const ClassHierarchy::Member* member) {
+    if (member != nullptr) {
+        o.kind = member->kind;
+        o.field = member->kind == VARIABLE;
+        o.owner = symbolTable->types->name(member->owner);
+        o.type = symbolTable->types->name(member->type);
+    }
+    xref->add(o);
+}
+
+void Parser::recordClassUse() {
+    Occurrence o = tokenOccurrence(CLASS_NAME, false);
+    o.owner = o.name;
+    xref->add(o);
+}
+
 // Lança um erro semântico com mensagem detalhada.
 void Parser::semanticError(string message) {
-    cout << "\n[ERRO SEMANTICO] Linha " << scanner->getLine() << ": " << message << endl;
-    exit(EXIT_FAILURE);
+    semanticError(message, scanner->getLine());
+}
+
+void Parser::semanticError(string message, int line) {
+    XPP_PROBE2(semantic__error, message.c_str(), line);
+    AllocationScope allocations(ALLOC_DIAGNOSTICS);
+    throw CompileError(diagnosticAt(PHASE_SEMANTIC, message, line));
+}
+
+// Erros na linha do token atual apontam para ele; erros em outra linha (por exemplo, na
+// declaração de uma classe) só têm a linha.
+Diagnostic Parser::diagnosticAt(DiagnosticPhase phase, const string& message, int line) {
+    Diagnostic d;
+    d.phase = phase;
+    d.line = line;
+    d.message = message;
+    if (lToken != nullptr && line == scanner->getTokenLine()) {
+        d.column = scanner->getTokenColumn();
+        d.offset = scanner->getTokenOffset();
+        d.length = scanner->getTokenLength();
+    }
+    return d;
 }
@@ -5,19 +5,54 @@ using namespace std;
 class Parser {
 public:
     // Construtor que inicializa o scanner com o arquivo de entrada e a tabela de símbolos
-    Parser(string input, SymbolTable* st);
+    Parser(string input, SymbolTable* st, ostream& out = cout);
+    Parser(Scanner* scanner, SymbolTable* st, ostream& out = cout); // Assume a posse do scanner
+    ~Parser();
 
-    // Método para iniciar o processo de parsing
-    void run();
+    // Método para iniciar o processo de parsing; retorna `false` se houve erro
+    bool run();
+
+    // Liga um registro de declarações e usos de identificadores (sem posse; `nullptr` desliga)
+    void setCrossReference(CrossReference* xref);
+
+    // Erros da análise (no máximo um: a análise para no primeiro erro)
+    const std::vector<Diagnostic>& getDiagnostics();
 
 private:
     Scanner* scanner;         // Objeto Scanner para tokenizar a entrada
+    ostream* out;             // Saída das mensagens de sucesso e de erro
     Token* lToken;            // Token atual
     SymbolTable* symbolTable; // Tabela de símbolos para análise semântica
     SymbolTable* currentScope; // Escopo atual (para escopos aninhados)
+    std::vector<SymbolTable*> scopePool; // Escopos liberados, reutilizados por enterScope
     string currentClass;      // Nome da classe atual sendo processada
-    string currentType;       // Tipo atual sendo processado
+    TypeId currentClassType;  // Tipo da classe atual (NO_TYPE fora de classes)
+    SymbolTable* classScope;  // Escopo dos membros da classe atual
+    TypeId currentType;       // Tipo atual sendo processado
     bool currentIsArray;      // Se o tipo atual é array
+    std::vector<TypeId> currentParams; // Tipos dos parâmetros do método atual
+
+    // Atribuições entre tipos de classe, verificadas depois que o índice de herança é construído.
+    struct PendingAssignment {
+        TypeId target;
+        TypeId value;
+        int line;
+    };
+    std::vector<PendingAssignment> pendingAssignments;
+
+    // Acessos a membros da própria classe que ainda não foram declarados (métodos podem ser
+    // usados antes da declaração); verificados ao final da classe.
+    struct PendingMember {
+        Atom name;
+        SymbolKind kind;
+        int line;
+    };
+    std::vector<PendingMember> pendingMembers;
+
+    CrossReference* xref;     // Registro de referências cruzadas (`nullptr` se desligado)
+    std::vector<Diagnostic> diagnostics;
+
+    void init(Scanner* s, SymbolTable* st, ostream& o);
 
     // Avança para o próximo token
     void advance();
@@ -26,14 +61,15 @@ private:
     void match(int t);
 
     // Métodos das produções gramaticais para a linguagem X++
-    void Program();              // Program → ClassList
+    void Program();              // Program → ImportListOpt ClassList
+    void ImportListOpt();        // ImportListOpt → import STRING_LITERAL ; ImportListOpt | ε
     void ClassList();            // ClassList → ClassDecl ClassList | ClassDecl
     void ClassDecl();            // ClassDecl → class ID ClassBody | class ID extends ID ClassBody
     void ClassBody();            // ClassBody → { VarDeclListOpt ConstructDeclListOpt MethodDeclListOpt }
     void VarDeclListOpt();       // VarDeclListOpt → VarDeclList | ε
     void VarDecl();              // VarDecl → Type ID VarDeclOpt ; | Type [] ID VarDeclOpt ;
     void VarDeclOpt();           // VarDeclOpt → , ID VarDeclOpt | ε
-    void Type();                 // Type → int | string | ID
+    TypeId Type();               // Type → int | string | ID
     void ConstructDeclListOpt(); // ConstructDeclListOpt → ConstructDeclList | ε
     void ConstructDeclList();    // ConstructDeclList → ConstructDeclList ConstructDecl | ConstructDecl
     void ConstructDecl();        // ConstructDecl → constructor MethodBody
@@ -56,10 +92,10 @@ private:
     void ForStat();              // ForStat → for ( AtribStatOpt ; ExpressionOpt ; AtribStatOpt ) { Statements }
     void AtribStatOpt();         // AtribStatOpt → AtribStat | ε
     void ExpressionOpt();        // ExpressionOpt → Expression | ε
-    void LValue();               // LValue → ID LValueComp
-    void LValueComp();           // LValueComp → . ID LValueComp | . ID [ Expression ] LValueComp | . ID ( ArgListOpt ) LValueComp | [ Expression ] LValueComp | ε
+    TypeId LValue();             // LValue → ID LValueComp
+    TypeId LValueComp(TypeId);   // LValueComp → . ID LValueComp | . ID [ Expression ] LValueComp | . ID ( ArgListOpt ) LValueComp | [ Expression ] LValueComp | ε
     void Expression();           // Expression → NumExpression | NumExpression RelOp NumExpression
-    void AllocExpression();      // AllocExpression → new ID ( ArgListOpt ) | Type [ Expression ]
+    TypeId AllocExpression();    // AllocExpression → new ID ( ArgListOpt ) | Type [ Expression ]
     void NumExpression();        // NumExpression → Term + Term | Term - Term | Term
     void Term();                 // Term → UnaryExpression * UnaryExpression | UnaryExpression / UnaryExpression | UnaryExpression % UnaryExpression | UnaryExpression
     void UnaryExpression();      // UnaryExpression → + Factor | - Factor | Factor
@@ -74,15 +110,32 @@ private:
     // Semantic analysis helper methods
     void enterScope();           // Cria um novo escopo (tabela filha)
     void exitScope();            // Retorna ao escopo pai
-    void declareClass(string className, string parentClass = ""); // Declara uma classe
-    void declareVariable(string varName, string varType, bool isArray); // Declara uma variável
-    void declareMethod(string methodName, string returnType, bool isArray); // Declara um método
-    void checkVariableDeclared(string varName); // Verifica se variável foi declarada
-    void checkClassDeclared(string className);  // Verifica se classe foi declarada
+    void declareClass(const string& className, const string& parentClass = ""); // Declara uma classe
+    void declareVariable(const string& varName, TypeId varType, bool isArray); // Declara uma variável
+    void declareMethod(const string& methodName, TypeId returnType, bool isArray); // Declara um método
+    TypeId checkVariableDeclared(const string& varName); // Verifica se variável foi declarada e retorna seu tipo
+    void checkClassDeclared(const string& className);  // Verifica se classe foi declarada
+    void checkTypeDeclared(TypeId type);        // Verifica se a classe base de um tipo foi declarada
+    void checkAssignable(TypeId target, TypeId value); // Verifica a compatibilidade de uma atribuição
+    const ClassHierarchy::Member* resolveMember(TypeId type, const string& memberName, SymbolKind kind); // Resolve `.ID`
+    void checkPendingMembers();  // Verifica os acessos adiados a membros da classe atual
+    void checkHierarchy();       // Constrói o índice de herança e verifica as atribuições pendentes
+    // Referências cruzadas: chamados apenas quando `xref` está ligado
+    Occurrence tokenOccurrence(SymbolKind kind, bool declaration); // Ocorrência no token atual
+    void recordDeclaration(SymbolKind kind);     // Declaração do token atual no escopo atual
+    void recordUse(const STEntry* entry);        // Uso do token atual resolvido em um escopo
+    void recordMemberUse(Occurrence occurrence, const ClassHierarchy::Member* member);
+    void recordClassUse();                       // Uso do token atual como nome de classe
+
     void semanticError(string message); // Lança erro semântico
+    void semanticError(string message, int line); // Lança erro semântico em uma linha específica
+    Diagnostic diagnosticAt(DiagnosticPhase phase, const string& message, int line);
 
     // Method to throw a syntax error with a message
     void error(string str);
+
+    Parser(const Parser&);
+    Parser& operator=(const Parser&);
 };
 // Comentários:
 // - A classe Parser é responsável por analisar (parsear) a string de entrada de acordo com a gramática especificada.
@@ -91,4 +144,7 @@ private:
 // - O método match() verifica se o token atual corresponde ao tipo de token e, quando aplicável, ao lexema esperado, avançando em caso positivo.
 // - Os métodos das produções gramaticais (Program, Function, VarDeclaration, etc.) implementam as regras de parsing para cada não-terminal da gramática.
 // - Os métodos auxiliares (isType, isStatement, isExpression) verificam se o token atual atende a critérios específicos.
-// - O método error() lança um runtime_error com uma mensagem de erro de sintaxe, incluindo o número da linha.
+// - O método error() lança um CompileError (um runtime_error com o Diagnostic do erro) de sintaxe,
+//   com a linha e a posição do token atual.
+// - Erros léxicos e semânticos também são lançados como CompileError e tratados em run(), de modo
+//   que um erro não encerra o processo (necessário para compilar várias vezes no mesmo processo).
@@ -0,0 +1,91 @@
+#include "superheader.h"
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+
+PerfCounters::PerfCounters() {
+    for (int& fd : fds)
+        fd = -1;
+}
+
+PerfCounters::~PerfCounters() {
+#ifdef __linux__
+    for (int fd : fds)
+        if (fd >= 0)
+            close(fd);
+#endif
+}
+
+const char* PerfCounters::eventName(PerfEvent event) {
+    static const char* const NAMES[PERF_EVENTS] = {
+        "cycles", "instructions", "branch_misses", "l1d_misses", "llc_misses"
+    };
+    return NAMES[event];
+}
+
+#ifdef __linux__
+static bool configure(PerfEvent event, struct perf_event_attr* attr) {
+    const uint64_t READ_MISS = (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+    attr->type = PERF_TYPE_HARDWARE;
+    switch (event) {
+    case PERF_CYCLES: attr->config = PERF_COUNT_HW_CPU_CYCLES; return true;
+    case PERF_INSTRUCTIONS: attr->config = PERF_COUNT_HW_INSTRUCTIONS; return true;
+    case PERF_BRANCH_MISSES: attr->config = PERF_COUNT_HW_BRANCH_MISSES; return true;
+    case PERF_L1D_MISSES: attr->type = PERF_TYPE_HW_CACHE; attr->config = PERF_COUNT_HW_CACHE_L1D | READ_MISS; return true;
+    case PERF_LLC_MISSES: attr->type = PERF_TYPE_HW_CACHE; attr->config = PERF_COUNT_HW_CACHE_LL | READ_MISS; return true;
+    default: return false;
+    }
+}
+#endif
+
+// Os contadores começam ativos e contam só esta thread (pid 0, qualquer CPU).
+bool PerfCounters::open() {
+#ifdef __linux__
+    bool any = false;
+    for (int e = 0; e < PERF_EVENTS; e++) {
+        struct perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        if (!configure((PerfEvent) e, &attr))
+            continue;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        fds[e] = (int) syscall(SYS_perf_event_open, &attr, 0, -1, -1, PERF_FLAG_FD_CLOEXEC);
+        if (fds[e] >= 0)
+            any = true;
+        else if (message.empty())
+            message = string(eventName((PerfEvent) e)) + ": " + strerror(errno);
+    }
+    if (any)
+        message.clear();
+    return any;
+#else
+    message = "perf_event_open so existe no Linux";
+    return false;
+#endif
+}
+
+bool PerfCounters::available(PerfEvent event) {
+    return fds[event] >= 0;
+}
+
+const string& PerfCounters::error() {
+    return message;
+}
+
+void PerfCounters::read(uint64_t values[PERF_EVENTS]) {
+    for (int e = 0; e < PERF_EVENTS; e++) {
+        values[e] = 0;
+#ifdef __linux__
+        uint64_t data[3]; // valor, tempo habilitado, tempo em execução
+        if (fds[e] < 0 || ::read(fds[e], data, sizeof(data)) != (ssize_t) sizeof(data))
+            continue;
+        values[e] = data[2] > 0 && data[2] < data[1] ? (uint64_t) ((double) data[0] * data[1] / data[2]) : data[0];
+#endif
+    }
+}
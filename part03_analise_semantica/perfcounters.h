@@ -0,0 +1,39 @@
+#include "superheader.h"
+
+// Eventos medidos por `--perf-counters`.
+enum PerfEvent : uint8_t {
+    PERF_CYCLES,
+    PERF_INSTRUCTIONS,
+    PERF_BRANCH_MISSES,
+    PERF_L1D_MISSES,        // Leituras que faltaram no cache L1 de dados.
+    PERF_LLC_MISSES,        // Leituras que faltaram no último nível de cache.
+    PERF_EVENTS
+};
+
+// A classe `PerfCounters` abre os contadores de hardware da thread atual com
+// `perf_event_open` (Linux), só no espaço de usuário. Cada evento é aberto separadamente:
+// um evento que o processador ou o hipervisor não oferece fica indisponível sem impedir os
+// outros. Quando o núcleo multiplexa os contadores, os valores lidos são escalados pelo
+// tempo em que cada um esteve ativo.
+//
+// Em hosts que negam os eventos (`perf_event_paranoid`, contêineres, máquinas virtuais)
+// ou fora do Linux, `open` retorna `false` e `error` diz o motivo; a compilação segue.
+class PerfCounters {
+public:
+    PerfCounters();
+    ~PerfCounters();
+
+    bool open();                            // `false` se nenhum evento pôde ser aberto.
+    bool available(PerfEvent event);
+    const string& error();
+    void read(uint64_t values[PERF_EVENTS]); // Contagens acumuladas desde `open` (0 se indisponível).
+
+    static const char* eventName(PerfEvent event); // "cycles", "instructions", ...
+
+private:
+    int fds[PERF_EVENTS];
+    string message;
+
+    PerfCounters(const PerfCounters&);
+    PerfCounters& operator=(const PerfCounters&);
+};
@@ -0,0 +1,402 @@
+#include "superheader.h"
+
+typedef PersistentSymbolTable::Node Node;
+
+static const int BITS = 5;
+static const int HASH_BITS = 64;
+
+PersistentSymbol PersistentSymbol::fromEntry(SymbolTable* global, STEntry* entry) {
+    PersistentSymbol s;
+    s.name = global->nameOf(entry->name);
+    s.type = entry->type != NO_TYPE ? global->types->name(entry->type) : "";
+    s.parentClass = global->nameOf(entry->parentClass);
+    s.kind = entry->kind;
+    s.isArray = entry->isArray;
+    s.line = entry->line;
+    return s;
+}
+
+static uint64_t hashName(const string& name) {
+    return hashBytes(name.data(), name.size());
+}
+
+static int popcount(uint32_t x) {
+#if defined(__GNUC__)
+    return __builtin_popcount(x);
+#else
+    int n = 0;
+    for (; x; x &= x - 1) n++;
+    return n;
+#endif
+}
+
+/**********************************************************
+*
+*               CONTAGEM DE REFERÊNCIAS
+*
+***********************************************************/
+
+static void release(Node* n);
+
+static void release(PersistentLeaf* leaf) {
+    if (--leaf->refs == 0)
+        delete leaf;
+}
+
+static void retain(Node::Entry& e) {
+    if (e.leaf != nullptr)
+        e.leaf->refs++;
+    else
+        e.child->refs++;
+}
+
+static void release(Node::Entry& e) {
+    if (e.leaf != nullptr)
+        release(e.leaf);
+    else
+        release(e.child);
+}
+
+static void release(Node* n) {
+    if (n == nullptr || --n->refs > 0)
+        return;
+    for (Node::Entry& e : n->entries)
+        release(e);
+    delete n;
+}
+
+static Node* newNode(uint64_t owner) {
+    Node* n = new Node();
+    n->refs = 1;
+    n->bitmap = 0;
+    n->owner = owner;
+    n->collision = false;
+    return n;
+}
+
+// Retorna uma versão alterável de `slot`: o próprio nó se ele pertence à transação, ou uma
+// cópia (que passa a compartilhar os filhos) colocada no lugar dele.
+static Node* editable(Node*& slot, uint64_t owner) {
+    if (slot->owner == owner)
+        return slot;
+
+    Node* copy = newNode(owner);
+    copy->bitmap = slot->bitmap;
+    copy->collision = slot->collision;
+    copy->entries = slot->entries;
+    for (Node::Entry& e : copy->entries)
+        retain(e);
+
+    release(slot);
+    slot = copy;
+    return copy;
+}
+
+/**********************************************************
+*
+*                   OPERAÇÕES NA HAMT
+*
+***********************************************************/
+
+static const PersistentSymbol* find(const Node* n, uint64_t hash, const string& name) {
+    for (int shift = 0; n != nullptr; shift += BITS) {
+        if (n->collision) {
+            for (const Node::Entry& e : n->entries)
+                if (e.leaf->symbol.name == name)
+                    return &e.leaf->symbol;
+            return nullptr;
+        }
+
+        uint32_t bit = 1u << ((hash >> shift) & 31);
+        if (!(n->bitmap & bit))
+            return nullptr;
+
+        const Node::Entry& e = n->entries[popcount(n->bitmap & (bit - 1))];
+        if (e.leaf != nullptr)
+            return e.leaf->hash == hash && e.leaf->symbol.name == name ? &e.leaf->symbol : nullptr;
+        n = e.child;
+    }
+    return nullptr;
+}
+
+// Cria a subárvore que separa duas folhas cujos hashes coincidem até `shift`.
+static Node* split(PersistentLeaf* a, PersistentLeaf* b, int shift, uint64_t owner) {
+    Node* n = newNode(owner);
+
+    if (shift >= HASH_BITS || a->hash == b->hash) {
+        n->collision = true;
+        n->entries.push_back({ nullptr, a });
+        n->entries.push_back({ nullptr, b });
+        return n;
+    }
+
+    uint32_t ia = (a->hash >> shift) & 31;
+    uint32_t ib = (b->hash >> shift) & 31;
+    if (ia == ib) {
+        n->bitmap = 1u << ia;
+        n->entries.push_back({ split(a, b, shift + BITS, owner), nullptr });
+    } else {
+        n->bitmap = (1u << ia) | (1u << ib);
+        if (ia < ib) {
+            n->entries.push_back({ nullptr, a });
+            n->entries.push_back({ nullptr, b });
+        } else {
+            n->entries.push_back({ nullptr, b });
+            n->entries.push_back({ nullptr, a });
+        }
+    }
+    return n;
+}
+
+// Insere ou substitui `leaf` (que já chega com uma referência). Retorna `true` se o símbolo é novo.
+static bool insert(Node*& slot, PersistentLeaf* leaf, int shift, uint64_t owner) {
+    Node* n = editable(slot, owner);
+
+    if (n->collision) {
+        for (Node::Entry& e : n->entries) {
+            if (e.leaf->symbol.name == leaf->symbol.name) {
+                release(e.leaf);
+                e.leaf = leaf;
+                return false;
+            }
+        }
+        n->entries.push_back({ nullptr, leaf });
+        return true;
+    }
+
+    uint32_t bit = 1u << ((leaf->hash >> shift) & 31);
+    size_t pos = popcount(n->bitmap & (bit - 1));
+
+    if (!(n->bitmap & bit)) {
+        n->bitmap |= bit;
+        n->entries.insert(n->entries.begin() + pos, { nullptr, leaf });
+        return true;
+    }
+
+    Node::Entry& e = n->entries[pos];
+    if (e.child != nullptr)
+        return insert(e.child, leaf, shift + BITS, owner);
+
+    if (e.leaf->hash == leaf->hash && e.leaf->symbol.name == leaf->symbol.name) {
+        release(e.leaf);
+        e.leaf = leaf;
+        return false;
+    }
+
+    e.child = split(e.leaf, leaf, shift + BITS, owner); // A folha antiga muda de nó com sua referência.
+    e.leaf = nullptr;
+    return true;
+}
+
+// Remove um símbolo que o chamador já sabe existir (uma remoção inexistente não copia o caminho).
+static bool erase(Node*& slot, uint64_t hash, const string& name, int shift, uint64_t owner) {
+    Node* n = editable(slot, owner);
+
+    if (n->collision) {
+        for (size_t i = 0; i < n->entries.size(); i++) {
+            if (n->entries[i].leaf->symbol.name == name) {
+                release(n->entries[i].leaf);
+                n->entries.erase(n->entries.begin() + i);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    uint32_t bit = 1u << ((hash >> shift) & 31);
+    size_t pos = popcount(n->bitmap & (bit - 1));
+    Node::Entry& e = n->entries[pos];
+
+    if (e.child != nullptr) {
+        erase(e.child, hash, name, shift + BITS, owner);
+        if (!e.child->entries.empty())
+            return true;
+        release(e.child); // Subárvore ficou vazia.
+    } else {
+        release(e.leaf);
+    }
+
+    n->bitmap &= ~bit;
+    n->entries.erase(n->entries.begin() + pos);
+    return true;
+}
+
+// Após o commit os nós da transação passam a ser imutáveis.
+static void freeze(Node* n, uint64_t owner) {
+    if (n == nullptr || n->owner != owner)
+        return;
+    n->owner = 0;
+    for (Node::Entry& e : n->entries)
+        if (e.child != nullptr)
+            freeze(e.child, owner);
+}
+
+/**********************************************************
+*
+*                   VERSÕES E SNAPSHOTS
+*
+***********************************************************/
+
+const PersistentSymbol* PersistentSymbolTable::Version::get(const string& name) const {
+    return find(root, hashName(name), name);
+}
+
+size_t PersistentSymbolTable::Version::size() const {
+    return count;
+}
+
+uint64_t PersistentSymbolTable::Version::number() const {
+    return sequence;
+}
+
+PersistentSymbolTable::PersistentSymbolTable() {
+    Version* empty = new Version();
+    empty->root = newNode(0);
+    empty->count = 0;
+    empty->sequence = 0;
+    empty->retiredAt = 0;
+    head.store(empty);
+    epoch.store(1);
+    for (int i = 0; i < MAX_READERS; i++)
+        readers[i].store(0);
+    nextTransaction = 1;
+}
+
+PersistentSymbolTable::~PersistentSymbolTable() {
+    for (Version* v : retired) {
+        release(v->root);
+        delete v;
+    }
+    Version* v = head.load();
+    release(v->root);
+    delete v;
+}
+
+// Anuncia a época antes de ler a versão publicada: um escritor que substituir esta versão
+// verá o anúncio e não a liberará enquanto o snapshot existir. Sem slot livre, o anúncio vai
+// para a lista de excedentes; um escritor que a consulte depois da inserção a vê, e um que a
+// consultou antes já tinha publicado a versão que este snapshot vai ler.
+PersistentSymbolTable::Snapshot::Snapshot(PersistentSymbolTable& t) {
+    table = &t;
+    slot = -1;
+    announced = t.epoch.load() + 1;
+
+    for (int i = 0; i < MAX_READERS; i++) {
+        uint64_t idle = 0;
+        if (t.readers[i].load(std::memory_order_relaxed) == 0 &&
+            t.readers[i].compare_exchange_strong(idle, announced)) {
+            slot = i;
+            break;
+        }
+    }
+    if (slot < 0) {
+        std::lock_guard<std::mutex> lock(t.overflowMutex);
+        t.overflow.insert(announced);
+    }
+    version = t.head.load();
+}
+
+PersistentSymbolTable::Snapshot::~Snapshot() {
+    if (slot >= 0) {
+        table->readers[slot].store(0);
+        return;
+    }
+    std::lock_guard<std::mutex> lock(table->overflowMutex);
+    table->overflow.erase(table->overflow.find(announced));
+}
+
+void PersistentSymbolTable::reclaim() {
+    uint64_t oldest = UINT64_MAX;
+    for (int i = 0; i < MAX_READERS; i++) {
+        uint64_t r = readers[i].load();
+        if (r != 0 && r - 1 < oldest)
+            oldest = r - 1;
+    }
+    {
+        std::lock_guard<std::mutex> lock(overflowMutex);
+        if (!overflow.empty() && *overflow.begin() - 1 < oldest)
+            oldest = *overflow.begin() - 1;
+    }
+
+    size_t kept = 0;
+    for (Version* v : retired) {
+        if (v->retiredAt < oldest) {
+            release(v->root);
+            delete v;
+        } else {
+            retired[kept++] = v;
+        }
+    }
+    retired.resize(kept);
+}
+
+size_t PersistentSymbolTable::pendingVersions() {
+    std::lock_guard<std::mutex> lock(writer);
+    return retired.size();
+}
+
+/**********************************************************
+*
+*                       TRANSAÇÕES
+*
+***********************************************************/
+
+PersistentSymbolTable::Transaction::Transaction(PersistentSymbolTable& t) {
+    t.writer.lock();
+    table = &t;
+    Version* base = t.head.load();
+    root = base->root;
+    root->refs++;
+    count = base->count;
+    id = t.nextTransaction++;
+    done = false;
+}
+
+PersistentSymbolTable::Transaction::~Transaction() {
+    if (!done) {
+        release(root);
+        table->writer.unlock();
+    }
+}
+
+void PersistentSymbolTable::Transaction::put(const PersistentSymbol& symbol) {
+    PersistentLeaf* leaf = new PersistentLeaf();
+    leaf->refs = 1;
+    leaf->hash = hashName(symbol.name);
+    leaf->symbol = symbol;
+
+    if (insert(root, leaf, 0, id))
+        count++;
+}
+
+bool PersistentSymbolTable::Transaction::remove(const string& name) {
+    uint64_t hash = hashName(name);
+    if (find(root, hash, name) == nullptr || !erase(root, hash, name, 0, id))
+        return false;
+    count--;
+    return true;
+}
+
+const PersistentSymbol* PersistentSymbolTable::Transaction::get(const string& name) {
+    return find(root, hashName(name), name);
+}
+
+const PersistentSymbolTable::Version* PersistentSymbolTable::Transaction::commit() {
+    freeze(root, id);
+
+    Version* v = new Version();
+    v->root = root;
+    v->count = count;
+    v->retiredAt = 0;
+
+    Version* old = table->head.load();
+    v->sequence = old->sequence + 1;
+    table->head.store(v);
+    old->retiredAt = table->epoch.fetch_add(1);
+    table->retired.push_back(old);
+    table->reclaim();
+
+    done = true;
+    table->writer.unlock();
+    return v;
+}
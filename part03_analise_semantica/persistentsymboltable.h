@@ -0,0 +1,150 @@
+#include "superheader.h"
+
+// Símbolo autocontido guardado nas versões persistentes: ao contrário do `STEntry`, não
+// depende da arena nem do `Interner` da compilação que o produziu, então continua válido
+// depois que essa compilação termina.
+struct PersistentSymbol {
+    string name;
+    string type;          // Tipo escrito como em `TypeTable::name`.
+    string parentClass;   // Para classes: classe pai (vazio se não houver).
+    SymbolKind kind;
+    bool isArray;
+    int line;
+
+    static PersistentSymbol fromEntry(SymbolTable* global, STEntry* entry);
+};
+
+// A classe `PersistentSymbolTable` é uma variante persistente (copy-on-write) da
+// `SymbolTable` para serviços com muitos leitores concorrentes, como um editor/indexador.
+//
+// Cada versão é uma "hash array mapped trie" (HAMT) imutável: nós de 32 posições indexados
+// por 5 bits do hash. Uma atualização copia apenas o caminho da raiz até o símbolo alterado
+// e compartilha todo o resto com a versão anterior, então o custo é O(símbolos alterados).
+// Dentro de uma mesma transação os nós recém-copiados são alterados no lugar.
+//
+// Publicação e leitura:
+// - `Transaction::commit()` publica a nova versão com um store atômico (escritores são
+//   serializados entre si);
+// - `Snapshot` anuncia a época atual em um slot de leitor e carrega a versão publicada:
+//   duas operações atômicas, sem locks. Há `MAX_READERS` slots; com todos ocupados, o
+//   snapshot anuncia a época em uma lista de leitores excedentes protegida por mutex (a
+//   espera é só por outra inserção ou remoção na lista, nunca por um escritor em
+//   andamento). A versão fica válida enquanto o `Snapshot` viver;
+// - versões substituídas só são liberadas quando nenhum leitor anunciou uma época em que
+//   elas ainda eram visíveis (reclamação por épocas).
+class PersistentSymbolTable {
+public:
+    struct Node;
+
+    class Version {
+    public:
+        const PersistentSymbol* get(const string& name) const; // Busca um símbolo.
+        size_t size() const;                                   // Número de símbolos.
+        uint64_t number() const;                               // Número sequencial da versão.
+
+        template <typename F> void forEach(F f) const { visit(root, f); }
+
+    private:
+        friend class PersistentSymbolTable;
+        Node* root;
+        size_t count;
+        uint64_t sequence;
+        uint64_t retiredAt; // Época em que a versão foi substituída.
+
+        template <typename F> static void visit(const Node* n, F& f);
+    };
+
+    // Visão consistente da versão publicada no momento da criação.
+    class Snapshot {
+    public:
+        Snapshot(PersistentSymbolTable&);
+        ~Snapshot();
+        const Version* operator->() const { return version; }
+        const Version& operator*() const { return *version; }
+
+    private:
+        PersistentSymbolTable* table;
+        int slot;               // -1: registrado em `overflow`.
+        uint64_t announced;     // Época anunciada + 1.
+        const Version* version;
+
+        Snapshot(const Snapshot&);
+        Snapshot& operator=(const Snapshot&);
+    };
+
+    // Lote de alterações sobre a versão publicada; nada é visível até `commit()`.
+    class Transaction {
+    public:
+        Transaction(PersistentSymbolTable&);
+        ~Transaction();                                  // Descarta se não houve commit.
+
+        void put(const PersistentSymbol&);               // Adiciona ou substitui um símbolo.
+        bool remove(const string& name);                 // Remove; `false` se não existia.
+        const PersistentSymbol* get(const string& name); // Lê o estado da transação.
+        const Version* commit();                         // Publica atomicamente a nova versão.
+
+    private:
+        PersistentSymbolTable* table;
+        Node* root;
+        size_t count;
+        uint64_t id;      // Nós com este dono podem ser alterados no lugar.
+        bool done;
+
+        Transaction(const Transaction&);
+        Transaction& operator=(const Transaction&);
+    };
+
+    PersistentSymbolTable();
+    ~PersistentSymbolTable();
+
+    size_t pendingVersions(); // Versões substituídas que ainda aguardam leitores.
+
+    static const int MAX_READERS = 64; // Snapshots simultâneos sem lock (os demais usam `overflow`).
+
+private:
+    std::atomic<Version*> head;          // Versão publicada.
+    std::atomic<uint64_t> epoch;         // Incrementada a cada publicação.
+    std::atomic<uint64_t> readers[MAX_READERS]; // Época anunciada + 1 (0 = livre).
+    std::mutex overflowMutex;
+    std::multiset<uint64_t> overflow;    // Anúncios dos leitores além de `MAX_READERS`.
+    std::mutex writer;                   // Serializa transações.
+    std::vector<Version*> retired;       // Versões substituídas ainda não liberadas.
+    uint64_t nextTransaction;
+
+    void reclaim();
+
+    PersistentSymbolTable(const PersistentSymbolTable&);
+    PersistentSymbolTable& operator=(const PersistentSymbolTable&);
+};
+
+// Folha: um símbolo e o hash do seu nome. Folhas e nós são compartilhados entre versões e
+// têm contagem de referências alterada apenas por escritores (sob o mutex).
+struct PersistentLeaf {
+    uint32_t refs;
+    uint64_t hash;
+    PersistentSymbol symbol;
+};
+
+struct PersistentSymbolTable::Node {
+    struct Entry {
+        Node* child;            // Subárvore, ou
+        PersistentLeaf* leaf;   // símbolo armazenado diretamente.
+    };
+
+    uint32_t refs;
+    uint32_t bitmap;            // Posições (5 bits do hash) ocupadas, em ordem.
+    uint64_t owner;             // Transação que pode alterar o nó no lugar (0 = imutável).
+    bool collision;             // Folhas com o mesmo hash completo.
+    std::vector<Entry> entries;
+};
+
+template <typename F> void PersistentSymbolTable::Version::visit(const Node* n, F& f) {
+    if (n == nullptr)
+        return;
+    for (const Node::Entry& e : n->entries) {
+        if (e.leaf != nullptr)
+            f(e.leaf->symbol);
+        else
+            visit(e.child, f);
+    }
+}
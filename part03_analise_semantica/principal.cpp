@@ -2,35 +2,37 @@
 
 int main(int argc, char* argv[]) 
 {
-    // Esta main espera receber o nome do arquivo a ser executado na linha de comando.
-    if (argc != 2)
+    // Esta main espera receber o nome do arquivo a ser executado na linha de comando ("-"
+    // lê o programa da entrada padrão), opcionalmente acompanhado de opções:
+    //   --stats                   relatório de memória da tabela de símbolos
+    //   --time-report             tempo real e de CPU, vazão e RSS de cada fase
+    //   --trace saida.json        trechos de arquivos, fases, classes e métodos (chrome://tracing)
+    //   --perf-counters           ciclos, instruções, IPC e falhas de desvio e de cache por fase
+    //   --perf-counters-json F    os mesmos contadores em JSON
+    //   --alloc-report            alocações por subsistema (com -DXPP_TRACK_ALLOCATIONS)
+    //   --import arquivo.xpi      importa as classes de uma interface binária (pode repetir)
+    //   --emit-interface saida.xpi  grava a interface binária das classes compiladas
+    //   --emit-xref indice.xpx    atualiza o índice de declarações e usos (ver `XrefIndex`)
+    //   --diagnostics-format F    human (padrão), json (um objeto por linha) ou sarif
+    //   --incremental estado      reanalisa só as classes alteradas desde a última compilação
+    //   --cache-dir diretorio     reaproveita resultados de compilações com as mesmas entradas
+    //   --cache-max-mb N          limite de tamanho do cache (padrão: 256 MB)
+    //   -j threads                threads para programas com `import` (padrão: uma por núcleo)
+    CompilerOptions options;
+    std::vector<string> args(argv + 1, argv + argc);
+
+    if (!parseOptions(args, &options))
     {
-        cout << "Uso: ./xpp_compiler nome_arquivo.xpp\n";
+        printUsage(cout);
         return 1;
     }
 
-    // Inicializando tabela de simbolos com palavras reservadas do X++.
-    SymbolTable* symbolTable = new SymbolTable();
-
-    // Palavras reservadas da linguagem X++
-    symbolTable->add(new STEntry(new Token(CLASS, "class"), true));
-    symbolTable->add(new STEntry(new Token(EXTENDS, "extends"), true));
-    symbolTable->add(new STEntry(new Token(INT, "int"), true));
-    symbolTable->add(new STEntry(new Token(STRING, "string"), true));
-    symbolTable->add(new STEntry(new Token(BREAK, "break"), true));
-    symbolTable->add(new STEntry(new Token(PRINT, "print"), true));
-    symbolTable->add(new STEntry(new Token(READ, "read"), true));
-    symbolTable->add(new STEntry(new Token(RETURN, "return"), true));
-    symbolTable->add(new STEntry(new Token(SUPER, "super"), true));
-    symbolTable->add(new STEntry(new Token(IF, "if"), true));
-    symbolTable->add(new STEntry(new Token(ELSE, "else"), true));
-    symbolTable->add(new STEntry(new Token(FOR, "for"), true));
-    symbolTable->add(new STEntry(new Token(NEW, "new"), true));
-    symbolTable->add(new STEntry(new Token(CONSTRUCTOR, "constructor"), true));
-
-    // Cria o parser passando o arquivo de entrada e a tabela de simbolos.
-    Parser* parser = new Parser(argv[1], symbolTable);
-    parser->run();
+    // Como no daemon (`xppc -`), o texto vem junto e "-" é só o rótulo do arquivo.
+    if (options.fileName == "-")
+    {
+        options.source.assign(std::istreambuf_iterator<char>(cin), std::istreambuf_iterator<char>());
+        options.hasSource = true;
+    }
 
-    return 0;
+    return runCompiler(options, cout);
 }
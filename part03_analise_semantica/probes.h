@@ -0,0 +1,69 @@
+#include "superheader.h"
+
+// Pontos de rastreamento estáticos (USDT, no formato do `sys/sdt.h` do SystemTap), para
+// observar um compilador em produção sob demanda com `bpftrace` ou `perf`, sem recompilar:
+//
+//   bpftrace -e 'usdt:./xpp_compiler:xpp:class__declared { printf("%s\n", str(arg0)); }' -c './xpp_compiler prog.xpp'
+//   perf probe -x ./xpp_compiler sdt_xpp:semantic__error && perf record -e sdt_xpp:semantic__error ...
+//
+// Cada ponto é uma instrução `nop` no código e uma nota `.note.stapsdt` no executável com o
+// seu endereço, o provedor (`xpp`), o nome e onde ler cada argumento. Sem ferramenta
+// conectada o `nop` é executado e nada mais acontece; a ferramenta que se conecta troca o
+// `nop` por um ponto de interrupção. Os argumentos são calculados mesmo sem ferramenta
+// (ficam em registradores ou na pilha), então só passamos ponteiros e inteiros já à mão.
+//
+// Pontos (strings são `const char*` terminadas em zero, exceto onde há um comprimento):
+//   span__start, span__end  (categoria, nome, comprimento do nome): início e fim de cada
+//                           `TraceSpan`; a categoria "fase" marca as fronteiras das fases
+//   file__open              (caminho, aberto): leitura de um arquivo fonte
+//   class__declared         (classe, classe pai ou "", linha)
+//   method__declared        (classe, método, linha)
+//   scope__enter, scope__exit (escopo, linha): `Parser::enterScope`/`exitScope`
+//   semantic__error         (mensagem, linha)
+//
+// Só existem no Linux x86-64 com GCC ou Clang; em outros alvos, ou com `-DXPP_NO_PROBES`, as
+// macros não geram código.
+#if defined(__linux__) && defined(__x86_64__) && defined(__GNUC__) && !defined(XPP_NO_PROBES)
+
+// Tamanho do argumento no formato do SystemTap: negativo para tipos com sinal.
+#define XPP_PROBE_SIZE(x) ((std::is_signed<decltype(+(x))>::value ? -1 : 1) * (int) sizeof(+(x)))
+#define XPP_PROBE_OPERAND(x) "n"(XPP_PROBE_SIZE(x)), "nor"(+(x))
+
+// A nota segue a versão 3 do formato: endereço do `nop`, base `_.stapsdt.base` (para
+// corrigir o endereço quando o executável é relocado), semáforo (nenhum), provedor, nome e
+// argumentos ("tamanho@operando" separados por espaço).
+#define XPP_PROBE_ASM(name, args)                                                   \
+    "990: nop\n"                                                                    \
+    ".pushsection .note.stapsdt,\"?\",\"note\"\n"                                   \
+    ".balign 4\n"                                                                   \
+    ".4byte 992f-991f, 994f-993f, 3\n"                                              \
+    "991: .asciz \"stapsdt\"\n"                                                     \
+    "992: .balign 4\n"                                                              \
+    "993: .8byte 990b\n"                                                            \
+    ".8byte _.stapsdt.base\n"                                                       \
+    ".8byte 0\n"                                                                    \
+    ".asciz \"xpp\"\n"                                                              \
+    ".asciz \"" #name "\"\n"                                                        \
+    ".asciz \"" args "\"\n"                                                         \
+    "994: .balign 4\n"                                                              \
+    ".popsection\n"                                                                 \
+    ".ifndef _.stapsdt.base\n"                                                      \
+    ".pushsection .stapsdt.base,\"aG\",\"progbits\",.stapsdt.base,comdat\n"         \
+    ".weak _.stapsdt.base\n"                                                        \
+    ".hidden _.stapsdt.base\n"                                                      \
+    "_.stapsdt.base: .space 1\n"                                                    \
+    ".size _.stapsdt.base, 1\n"                                                     \
+    ".popsection\n"                                                                 \
+    ".endif\n"
+
+#define XPP_PROBE2(name, a, b) \
+    __asm__ __volatile__(XPP_PROBE_ASM(name, "%c0@%1 %c2@%3") :: XPP_PROBE_OPERAND(a), XPP_PROBE_OPERAND(b))
+#define XPP_PROBE3(name, a, b, c) \
+    __asm__ __volatile__(XPP_PROBE_ASM(name, "%c0@%1 %c2@%3 %c4@%5") :: XPP_PROBE_OPERAND(a), XPP_PROBE_OPERAND(b), XPP_PROBE_OPERAND(c))
+
+#else
+
+#define XPP_PROBE2(name, a, b) ((void) 0)
+#define XPP_PROBE3(name, a, b, c) ((void) 0)
+
+#endif
@@ -0,0 +1,321 @@
+#include "superheader.h"
+
+namespace fs = std::filesystem;
+
+static bool readFile(const string& path, string* data) {
+    ifstream in(path, ios::in | ios::binary);
+    XPP_PROBE2(file__open, path.c_str(), in.is_open());
+    if (!in.is_open())
+        return false;
+    data->assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    return !in.bad();
+}
+
+// Identidade de um arquivo: o mesmo arquivo importado por caminhos diferentes é lido uma vez.
+static string fileKey(const string& path) {
+    std::error_code error;
+    fs::path canonical = fs::weakly_canonical(path, error);
+    return error ? path : canonical.string();
+}
+
+// Sem um prelúdio do chamador (o daemon tem o seu), um é criado para o programa: as
+// palavras reservadas são registradas uma vez, e não uma vez por arquivo.
+ProgramBuild::ProgramBuild(size_t jobs, SymbolTable* p) : pool(jobs) {
+    ownsPrelude = p == nullptr;
+    prelude = ownsPrelude ? Compilation::createPrelude() : p;
+    keepInterfaces = false;
+    recordOccurrences = false;
+    timed = false;
+    countingEvents = false;
+    trace = nullptr;
+}
+
+ProgramBuild::~ProgramBuild() {
+    pool.wait();
+    files.clear();
+    if (ownsPrelude)
+        delete prelude;
+}
+
+void ProgramBuild::import(std::shared_ptr<ModuleInterface> module) {
+    modules.push_back(module);
+}
+
+void ProgramBuild::recordCrossReferences() {
+    recordOccurrences = true;
+}
+
+void ProgramBuild::crossReferences(std::vector<XrefFile>* out) {
+    for (size_t u : order)
+        if (files[u]->analyzed)
+            out->push_back({ files[u]->path, files[u]->occurrences.all() });
+}
+
+size_t ProgramBuild::fileCount() {
+    return files.size();
+}
+
+size_t ProgramBuild::threadCount() {
+    return pool.size();
+}
+
+std::vector<ThreadPool::WorkerStats> ProgramBuild::workerStats() {
+    return pool.stats();
+}
+
+// Soma dos contadores dos arquivos analisados (cada um na thread que o analisou).
+CompilerStats ProgramBuild::stats() {
+    CompilerStats total = CompilerStats();
+    for (auto& f : files)
+        if (f->analyzed)
+            addStats(&total, f->stats);
+    return total;
+}
+
+void ProgramBuild::report(ostream& out, size_t file, int line, const string& message) {
+    Diagnostic d;
+    d.phase = PHASE_SEMANTIC;
+    d.file = files[file]->path;
+    d.line = line;
+    d.message = message;
+    errors.push_back(d);
+    out << "\n[ARQUIVO] " << d.file << DiagnosticWriter::human(d);
+}
+
+const std::vector<Diagnostic>& ProgramBuild::diagnostics() {
+    return errors;
+}
+
+// Fase 1: leitura e esboço, uma onda de arquivos por vez.
+void ProgramBuild::load(const string& mainPath, const string& mainSource) {
+    std::unordered_map<string, size_t> byKey;
+    auto add = [&](const string& path) {
+        auto found = byKey.find(fileKey(path));
+        if (found != byKey.end())
+            return found->second;
+        files.push_back(std::unique_ptr<ProgramFile>(new ProgramFile()));
+        ProgramFile& f = *files.back();
+        f.path = path;
+        f.loaded = f.outlined = f.analyzed = f.ok = false;
+        f.pending = 0;
+        f.stats = CompilerStats();
+        byKey[fileKey(path)] = files.size() - 1;
+        return files.size() - 1;
+    };
+
+    add(mainPath);
+    files[0]->source = mainSource;
+    files[0]->loaded = true;
+
+    for (size_t begin = 0; begin < files.size(); ) {
+        size_t end = files.size();
+        for (size_t i = begin; i < end; i++) {
+            ProgramFile* f = files[i].get();
+            pool.submit([this, f] {
+                TraceThread attach(trace);
+                TraceSpan span("esboco", f->path);
+                if (!f->loaded)
+                    f->loaded = readFile(f->path, &f->source);
+                if (f->loaded)
+                    f->outlined = f->outline.scan(f->source);
+            });
+        }
+        TraceSpan span("fase", "espera");
+        pool.wait();
+
+        for (size_t i = begin; i < end; i++) {
+            fs::path dir = fs::path(files[i]->path).parent_path();
+            for (const OutlineImport& imp : files[i]->outline.imports) {
+                size_t target = add((dir / imp.path).lexically_normal().generic_string());
+                if (std::find(files[i]->imports.begin(), files[i]->imports.end(), target) != files[i]->imports.end())
+                    continue;
+                files[i]->imports.push_back(target);
+                files[i]->importLines.push_back(imp.line);
+                files[target]->importers.push_back(i);
+            }
+        }
+        begin = end;
+    }
+}
+
+// Ordena os arquivos (importados antes de quem importa) e rejeita importações circulares.
+bool ProgramBuild::sort(ostream& out) {
+    enum { WHITE, GRAY, BLACK };
+    std::vector<int> color(files.size(), WHITE);
+    bool ok = true;
+
+    std::function<void(size_t)> visit = [&](size_t u) {
+        color[u] = GRAY;
+        ProgramFile& f = *files[u];
+        for (size_t k = 0; k < f.imports.size() && ok; k++) {
+            size_t v = f.imports[k];
+            if (color[v] == GRAY) {
+                report(out, u, f.importLines[k], "Importacao circular de '" + files[v]->path + "'");
+                ok = false;
+            } else if (color[v] == WHITE) {
+                visit(v);
+            }
+        }
+        color[u] = BLACK;
+        order.push_back(u);
+    };
+    visit(0);
+    return ok;
+}
+
+// Junção das declarações de classe de todos os arquivos em uma tabela global.
+bool ProgramBuild::merge(ostream& out) {
+    for (size_t u : order) {
+        ProgramFile& f = *files[u];
+        for (size_t k = 0; k < f.imports.size(); k++) {
+            if (!files[f.imports[k]]->loaded) {
+                report(out, u, f.importLines[k], "Arquivo importado '" + files[f.imports[k]]->path + "' nao encontrado");
+                return false;
+            }
+        }
+    }
+
+    struct Declaration {
+        size_t file;
+        int line;
+    };
+    std::unordered_map<string, Declaration> global;
+    for (size_t u : order) {
+        if (!files[u]->outlined)
+            continue;
+        for (const OutlineClass& c : files[u]->outline.classes) {
+            auto found = global.find(c.name);
+            if (found == global.end()) {
+                global[c.name] = { u, c.line };
+            } else if (found->second.file != u) {
+                // Repetições dentro de um mesmo arquivo são reportadas pelo parser.
+                report(out, u, c.line, "Classe '" + c.name + "' ja foi declarada em '" +
+                       files[found->second.file]->path + "' na linha " + to_string(found->second.line));
+                return false;
+            }
+        }
+    }
+
+    InterfaceClass ic;
+    for (size_t u : order) {
+        if (!files[u]->outlined)
+            continue;
+        for (const OutlineClass& c : files[u]->outline.classes) {
+            if (c.parent.empty() || global.count(c.parent))
+                continue;
+            bool imported = false;
+            for (auto& m : modules)
+                imported = imported || m->findClass(c.parent, &ic);
+            if (!imported) {
+                report(out, u, c.line, "Classe pai '" + c.parent + "' nao foi declarada");
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// Fase 2: análise completa de um arquivo; libera os que só esperavam por ele.
+void ProgramBuild::analyze(size_t file) {
+    ProgramFile& f = *files[file];
+    TraceThread attach(trace);
+    TraceSpan span("arquivo", f.path);
+    std::ostringstream out;
+    if (countingEvents)
+        f.time.countEvents();
+    if (timed)
+        f.time.start();
+    {
+        Compilation compilation(out, prelude);
+        for (auto& m : modules)
+            compilation.import(m);
+        for (size_t v : f.visible)
+            compilation.import(files[v]->interface);
+        if (recordOccurrences)
+            compilation.setCrossReference(&f.occurrences);
+
+        f.ok = compilation.compileSource(f.source);
+        f.stats = compilerStats;
+        f.diagnostics = compilation.diagnostics();
+        for (Diagnostic& d : f.diagnostics)
+            d.file = f.path;
+        if (f.ok && (keepInterfaces || !f.importers.empty())) {
+            f.interface = std::make_shared<ModuleInterface>();
+            f.interface->openBuffer(f.path, compilation.interfaceData());
+        }
+    }
+    if (timed)
+        f.time.stop();
+    f.output = out.str();
+    f.analyzed = true;
+
+    if (!f.ok)
+        return;
+    std::lock_guard<std::mutex> lock(mutex);
+    for (size_t u : f.importers)
+        if (--files[u]->pending == 0)
+            pool.submit([this, u] { analyze(u); });
+}
+
+// Com um relatório de tempo ativo (`--time-report`), cada arquivo é medido na thread que o
+// analisa e os relatórios são somados ao ativo no fim. Um trace ativo (`--trace`) é ativado
+// nas threads do pool enquanto executam as tarefas deste programa.
+bool ProgramBuild::compile(const string& mainPath, const string& mainSource, ostream& out, bool keep) {
+    keepInterfaces = keep;
+    timed = activeTimeReport != nullptr;
+    countingEvents = timed && activeTimeReport->countsEvents();
+    trace = activeTrace;
+    load(mainPath, mainSource);
+    if (!sort(out) || !merge(out))
+        return false;
+
+    // Visibilidade: as classes dos arquivos importados direta ou indiretamente.
+    for (size_t u : order) {
+        ProgramFile& f = *files[u];
+        for (size_t v : f.imports) {
+            f.visible.push_back(v);
+            f.visible.insert(f.visible.end(), files[v]->visible.begin(), files[v]->visible.end());
+        }
+        std::sort(f.visible.begin(), f.visible.end());
+        f.visible.erase(std::unique(f.visible.begin(), f.visible.end()), f.visible.end());
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (size_t u : order) {
+            files[u]->pending = files[u]->imports.size();
+            if (files[u]->pending == 0)
+                pool.submit([this, u] { analyze(u); });
+        }
+    }
+    {
+        TraceSpan span("fase", "espera");
+        pool.wait();
+    }
+
+    if (timed)
+        for (size_t u : order)
+            activeTimeReport->merge(files[u]->time);
+
+    for (size_t u : order) {
+        if (files[u]->analyzed && !files[u]->ok) {
+            out << "\n[ARQUIVO] " << files[u]->path << files[u]->output;
+            errors = files[u]->diagnostics;
+            return false;
+        }
+    }
+
+    out << "\n[SUCESSO] Compilacao finalizada com sucesso.\n";
+    return true;
+}
+
+// As classes de cada arquivo, na ordem das importações.
+string ProgramBuild::interfaceData() {
+    PhaseTimer timer(TIME_INTERFACE);
+    TraceSpan span("fase", "interface");
+    std::vector<InterfaceClass> all;
+    for (size_t u : order)
+        if (files[u]->interface != nullptr)
+            files[u]->interface->readAll(&all);
+    return ModuleInterface::serialize(all);
+}
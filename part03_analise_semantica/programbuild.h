@@ -0,0 +1,92 @@
+#include "superheader.h"
+
+// Um arquivo de um programa com importações e o resultado da sua análise.
+struct ProgramFile {
+    string path;                    // Caminho usado nas mensagens.
+    string source;
+    bool loaded;                    // `false` se o arquivo não pôde ser lido.
+    Outline outline;
+    bool outlined;                  // `false` se o esboço falhou (o parser reporta o erro).
+    std::vector<size_t> imports;    // Arquivos importados diretamente (índices).
+    std::vector<int> importLines;   // Linha de cada importação.
+    std::vector<size_t> importers;  // Arquivos que importam este.
+    std::vector<size_t> visible;    // Arquivos importados direta ou indiretamente.
+
+    size_t pending;                 // Importações ainda não analisadas.
+    bool analyzed;                  // A análise foi executada.
+    bool ok;                        // A análise terminou sem erros.
+    string output;                  // Mensagens da análise.
+    std::vector<Diagnostic> diagnostics; // Erro da análise, com o caminho do arquivo.
+    CompilerStats stats;            // Contadores da análise (`--stats`).
+    std::shared_ptr<ModuleInterface> interface; // Classes do arquivo, para quem o importa.
+    CrossReference occurrences;     // Declarações e usos (`recordCrossReferences`).
+    TimeReport time;                // Fases da análise (`--time-report`).
+};
+
+// A classe `ProgramBuild` compila programas de vários arquivos (`import "arquivo.xpp";`).
+//
+// Fase 1 (leitura): partindo do arquivo principal, os arquivos são lidos e esboçados
+// (`Outline`) em paralelo, em ondas: os arquivos importados por uma onda formam a próxima.
+// O caminho de uma importação é relativo ao diretório do arquivo que importa.
+//
+// Junção: as classes de todos os arquivos vão para uma tabela global, que detecta classes
+// declaradas em mais de um arquivo e classes pai que não existem em nenhum deles (os mesmos
+// erros de `Parser::declareClass`, agora entre arquivos). As importações não podem ser
+// circulares.
+//
+// Fase 2 (análise): cada arquivo é analisado por completo, com a sua própria tabela de
+// símbolos, em uma thread do pool, assim que os arquivos que ele importa terminam. As classes
+// deles chegam como interfaces binárias em memória (as mesmas do `--emit-interface`): um
+// arquivo vê as classes dos arquivos que importa, direta ou indiretamente. Arquivos
+// independentes são analisados em paralelo.
+//
+// As mensagens não dependem da ordem de execução: é reportado o primeiro erro na ordem das
+// importações (um arquivo vem depois dos que ele importa).
+class ProgramBuild {
+public:
+    ProgramBuild(size_t jobs, SymbolTable* prelude = nullptr); // `jobs` 0: uma thread por núcleo.
+    ~ProgramBuild();
+
+    // Interface de `--import`, visível em todos os arquivos.
+    void import(std::shared_ptr<ModuleInterface> module);
+
+    // Compila o programa cujo arquivo principal é `mainPath`, com o texto `mainSource`.
+    // Escreve em `out` a mensagem de sucesso ou o erro; `false` se houve erro. Com
+    // `keepInterfaces`, guarda a interface de todos os arquivos para `interfaceData`.
+    bool compile(const string& mainPath, const string& mainSource, ostream& out, bool keepInterfaces = false);
+
+    // Registra as declarações e os usos de cada arquivo, para o índice de referências.
+    void recordCrossReferences();
+    void crossReferences(std::vector<XrefFile>* out); // Um item por arquivo analisado.
+
+    string interfaceData();     // Interface de todas as classes do programa.
+    const std::vector<Diagnostic>& diagnostics(); // O erro reportado por `compile`, se houve.
+    size_t fileCount();
+    size_t threadCount();
+    std::vector<ThreadPool::WorkerStats> workerStats(); // Tempo de cada thread do pool.
+    CompilerStats stats();      // Soma dos contadores das análises.
+
+private:
+    ThreadPool pool;
+    SymbolTable* prelude;       // Palavras reservadas, compartilhadas pelas análises.
+    bool ownsPrelude;
+    bool keepInterfaces;
+    bool recordOccurrences;
+    bool timed;                     // Havia um relatório de tempo ativo em `compile`.
+    bool countingEvents;            // ... que media os contadores de hardware.
+    Trace* trace;                   // Trace ativo em `compile`, ativado nas tarefas do pool.
+    std::vector<std::shared_ptr<ModuleInterface>> modules;
+    std::vector<std::unique_ptr<ProgramFile>> files; // files[0] é o arquivo principal.
+    std::vector<size_t> order;                       // Importados antes de quem importa.
+    std::mutex mutex;                                // Protege `pending` durante a fase 2.
+    std::vector<Diagnostic> errors;
+
+    void load(const string& mainPath, const string& mainSource);
+    bool sort(ostream& out);
+    bool merge(ostream& out);
+    void analyze(size_t file);
+    void report(ostream& out, size_t file, int line, const string& message);
+
+    ProgramBuild(const ProgramBuild&);
+    ProgramBuild& operator=(const ProgramBuild&);
+};
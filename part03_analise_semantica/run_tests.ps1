@@ -12,6 +12,9 @@ $tests = @(
     @{Name="Programa completo"; File="test_completo.xpp"; Expected="success"},
     @{Name="Teste semantico completo"; File="test_semantico.xpp"; Expected="success"},
     @{Name="Teste simples"; File="test_simple.xpp"; Expected="success"},
+    @{Name="Heranca e atribuicoes compativeis"; File="test_heranca.xpp"; Expected="success"},
+    @{Name="Acesso a membros proprios e herdados"; File="test_membros.xpp"; Expected="success"},
+    @{Name="Classes importadas de outro arquivo"; File="test_importacao.xpp"; Expected="success"},
     
     # Testes de Erro Lexico
     @{Name="Erro lexico - caractere invalido"; File="test_erro_lexico.xpp"; Expected="error"},
@@ -24,7 +27,11 @@ $tests = @(
     @{Name="Erro semantico - redeclaracao variavel"; File="test_erro_semantico2.xpp"; Expected="error"},
     @{Name="Erro semantico - classe nao declarada"; File="test_erro_semantico3.xpp"; Expected="error"},
     @{Name="Erro semantico - redeclaracao classe"; File="test_erro_semantico4.xpp"; Expected="error"},
-    @{Name="Erro semantico - heranca invalida"; File="test_erro_semantico5.xpp"; Expected="error"}
+    @{Name="Erro semantico - heranca invalida"; File="test_erro_semantico5.xpp"; Expected="error"},
+    @{Name="Erro semantico - super sem superclasse"; File="test_erro_semantico6.xpp"; Expected="error"},
+    @{Name="Erro semantico - atribuicao incompativel"; File="test_erro_semantico7.xpp"; Expected="error"},
+    @{Name="Erro semantico - membro inexistente"; File="test_erro_semantico8.xpp"; Expected="error"},
+    @{Name="Erro semantico - classe repetida entre arquivos"; File="test_erro_importacao.xpp"; Expected="error"}
 )
 
 $passed = 0
@@ -40,21 +47,21 @@ foreach ($test in $tests) {
     $testNumber++
     
     # Separador visual para diferentes categorias
-    if ($test.Name -match "^Erro lexico" -and $testNumber -eq 6) {
+    if ($test.Name -match "^Erro lexico" -and $testNumber -eq 9) {
         Write-Host ""
         Write-Host "----------------------------------------" -ForegroundColor Cyan
         Write-Host "TESTES DE ERRO LEXICO" -ForegroundColor Cyan
         Write-Host "----------------------------------------" -ForegroundColor Cyan
         Write-Host ""
     }
-    elseif ($test.Name -match "^Erro sintatico" -and $testNumber -eq 7) {
+    elseif ($test.Name -match "^Erro sintatico" -and $testNumber -eq 10) {
         Write-Host ""
         Write-Host "----------------------------------------" -ForegroundColor Cyan
         Write-Host "TESTES DE ERRO SINTATICO" -ForegroundColor Cyan
         Write-Host "----------------------------------------" -ForegroundColor Cyan
         Write-Host ""
     }
-    elseif ($test.Name -match "^Erro semantico" -and $testNumber -eq 8) {
+    elseif ($test.Name -match "^Erro semantico" -and $testNumber -eq 11) {
         Write-Host ""
         Write-Host "----------------------------------------" -ForegroundColor Cyan
         Write-Host "TESTES DE ERRO SEMANTICO" -ForegroundColor Cyan
@@ -88,6 +95,38 @@ foreach ($test in $tests) {
     Write-Host ""
 }
 
+# Cache de resultados: o mesmo fonte em dois caminhos, com diagnosticos em JSON. O segundo
+# resultado deve citar o proprio caminho, e nao o do arquivo que preencheu o cache.
+Write-Host "----------------------------------------" -ForegroundColor Cyan
+Write-Host "TESTES DO CACHE DE RESULTADOS" -ForegroundColor Cyan
+Write-Host "----------------------------------------" -ForegroundColor Cyan
+Write-Host ""
+
+$cacheRoot = Join-Path $env:TEMP "xpp_cache_test"
+Remove-Item -Recurse -Force $cacheRoot -ErrorAction SilentlyContinue
+New-Item -ItemType Directory -Force (Join-Path $cacheRoot "t1"), (Join-Path $cacheRoot "t2") | Out-Null
+$first = Join-Path $cacheRoot "t1\a.xpp"
+$second = Join-Path $cacheRoot "t2\b.xpp"
+Copy-Item "tests\test_erro_semantico1.xpp" $first
+Copy-Item "tests\test_erro_semantico1.xpp" $second
+$cacheDir = Join-Path $cacheRoot "cache"
+
+$tests += @{Name="Cache - mesmo fonte em dois caminhos (json)"}
+$testNumber++
+Write-Host "[$testNumber/$($tests.Count)] Cache - mesmo fonte em dois caminhos (json)" -ForegroundColor Yellow
+& .\xpp_compiler.exe --cache-dir $cacheDir --diagnostics-format json $first 2>&1 | Out-Null
+$output = (& .\xpp_compiler.exe --cache-dir $cacheDir --diagnostics-format json $second 2>&1) -join "`n"
+$expected = '"file":' + ($second | ConvertTo-Json)
+if ($output.Contains($expected) -and -not $output.Contains("a.xpp")) {
+    Write-Host "  PASSOU" -ForegroundColor Green
+    $passed++
+} else {
+    Write-Host "  FALHOU" -ForegroundColor Red
+    $failed++
+}
+Write-Host ""
+Remove-Item -Recurse -Force $cacheRoot -ErrorAction SilentlyContinue
+
 Write-Host ""
 Write-Host "========================================"
 Write-Host "RESUMO DOS TESTES" -ForegroundColor White
@@ -1,16 +1,28 @@
 #include "superheader.h"
 
-Scanner::Scanner(string fileName, SymbolTable* st)
+Scanner::Scanner(string fileName, SymbolTable* st, ostream& out) : current(UNDEFINED)
 {
     pos = 0;
     line = 1;
+    tokenStart = 0;
+    tokenLine = 1;
     symbolTable = st; // Armazena referencia para a tabela de simbolos.
 
+    PhaseTimer timer(TIME_READ);
+    TraceSpan span("fase", "leitura");
+    AllocationScope allocations(ALLOC_SCANNER);
     ifstream inputFile(fileName, ios::in); // Verifica se o arquivo esta aberto
+    XPP_PROBE2(file__open, fileName.c_str(), inputFile.is_open());
     string fileLine;
 
     if (inputFile.is_open())
     {
+        // Reserva o tamanho do arquivo (mais o '\n' final que a leitura pode acrescentar):
+        // sem isso a string cresce por duplicação e o pico da leitura chega ao dobro do fonte.
+        std::error_code ec;
+        uintmax_t fileSize = std::filesystem::file_size(fileName, ec);
+        if (!ec)
+            this->input.reserve((size_t) fileSize + 1);
         while (getline(inputFile, fileLine)) // Se estiver, preenche o input
         {
             this->input.append(fileLine + '\n');
@@ -18,7 +30,38 @@ Scanner::Scanner(string fileName, SymbolTable* st)
         inputFile.close();
     }
     else // Se nao estiver
-        cout << "Unable to open file\n";
+        out << "Unable to open file\n";
+    if (activeTimeReport != nullptr)
+        activeTimeReport->addBytes(input.size());
+}
+
+// Scanner sobre um texto ja carregado (por exemplo, recebido pelo daemon), normalizado como
+// a leitura de arquivo: toda linha termina em '\n'. `firstLine` numera um trecho de um
+// arquivo maior com as linhas do arquivo.
+Scanner* Scanner::fromSource(const string& source, SymbolTable* st, int firstLine)
+{
+    PhaseTimer timer(TIME_READ);
+    TraceSpan span("fase", "leitura");
+    AllocationScope allocations(ALLOC_SCANNER);
+    Scanner* scanner = new Scanner(st);
+    scanner->line = firstLine;
+    scanner->tokenLine = firstLine;
+    scanner->input.reserve(source.size() + 1); // O '\n' final não realoca a cópia.
+    scanner->input = source;
+    if (!source.empty() && source.back() != '\n')
+        scanner->input += '\n';
+    if (activeTimeReport != nullptr)
+        activeTimeReport->addBytes(scanner->input.size());
+    return scanner;
+}
+
+Scanner::Scanner(SymbolTable* st) : current(UNDEFINED)
+{
+    pos = 0;
+    line = 1;
+    tokenStart = 0;
+    tokenLine = 1;
+    symbolTable = st;
 }
 
 // Getter que retorna a linha atual do arquivo
@@ -27,21 +70,67 @@ int Scanner::getLine()
     return line;
 }
 
+int Scanner::getTokenLine()
+{
+    return tokenLine;
+}
+
+// A coluna e calculada sob demanda (so o registro de referencias cruzadas e os
+// diagnosticos a consultam).
+int Scanner::getTokenColumn()
+{
+    return columnAt(tokenStart);
+}
+
+int Scanner::columnAt(int offset)
+{
+    int start = offset;
+    while (start > 0 && input[start - 1] != '\n')
+        start--;
+    return offset - start + 1;
+}
+
+int Scanner::getTokenOffset()
+{
+    return tokenStart;
+}
+
+// O token atual termina onde o scanner parou.
+int Scanner::getTokenLength()
+{
+    return pos - tokenStart;
+}
+
+// Preenche o token reutilizado pelo scanner: o parser so consulta o token atual, entao um
+// unico objeto basta e nenhum token e alocado por chamada.
+Token* Scanner::emit(int type, const string& lexeme)
+{
+    XPP_STAT(tokens[type]++);
+    current.type = type;
+    current.attribute = UNDEFINED;
+    current.lexeme = lexeme;
+    return &current;
+}
+
 // Método que retorna o próximo token da entrada
 Token* Scanner::nextToken()
 {
+    PhaseTimer timer(TIME_LEXICAL);
+    AllocationScope allocations(ALLOC_SCANNER);
     Token* token;
     int state = 0;
-    string lexeme;
+    lexeme.clear(); // Reaproveita a capacidade: sem alocação por token depois do aquecimento.
 
     while (true)
     {
         switch (state)
         {
         case 0: // Verifica os caracteres iniciais para determinar o tipo de token
+            tokenStart = pos; // Espacos e comentarios voltam ao estado 0 e avancam o inicio.
+            tokenLine = line;
             if (input[pos] == '\0')
             {
-                token = new Token(END_OF_FILE);
+                token = emit(END_OF_FILE);
                 return token;
             }
             else if (input[pos] == '<')
@@ -123,10 +212,12 @@ Token* Scanner::nextToken()
             
             if (entry != nullptr && entry->reserved) {
                 // E uma palavra reservada: retorna o token correspondente da tabela.
-                token = new Token(entry->token->type, lexeme);
+                XPP_STAT(keywords++);
+                token = emit(entry->tokenType, lexeme);
             } else {
                 // E um identificador normal: cria um novo token ID.
-                token = new Token(ID, lexeme);
+                XPP_STAT(identifiers++);
+                token = emit(ID, lexeme);
             }
             
             return token;
@@ -146,19 +237,19 @@ Token* Scanner::nextToken()
             if (isalpha(input[pos]) || input[pos] == '_') {
                 lexicalError();
             }
-            token = new Token(INTEGER_LITERAL, lexeme);
+            token = emit(INTEGER_LITERAL, lexeme);
             return token;
 
         case 5: // <
             if (input[pos] == '=')
             {
                 pos++;
-                token = new Token(LESS_OR_EQUAL_THAN);
+                token = emit(LESS_OR_EQUAL_THAN);
                 return token;
             }
             else
             {
-                token = new Token(LESS_THAN);
+                token = emit(LESS_THAN);
                 return token;
             }
 
@@ -166,25 +257,25 @@ Token* Scanner::nextToken()
             if (input[pos] == '=')
             {
                 pos++;
-                token = new Token(GREATER_OR_EQUAL_THAN);
+                token = emit(GREATER_OR_EQUAL_THAN);
                 return token;
             }
             else
             {
-                token = new Token(GREATER_THAN);
+                token = emit(GREATER_THAN);
                 return token;
             }
 
         case 7: // *
-            token = new Token(MULTIPLY_OPERATOR);
+            token = emit(MULTIPLY_OPERATOR);
             return token;
 
         case 8: // -
-            token = new Token(MINUS_OPERATOR);
+            token = emit(MINUS_OPERATOR);
             return token;
 
         case 9: // +
-            token = new Token(PLUS_OPERATOR);
+            token = emit(PLUS_OPERATOR);
             return token;
 
         case 10: // / ou comentário
@@ -200,7 +291,7 @@ Token* Scanner::nextToken()
             }
             else
             {
-                token = new Token(DIVIDE_OPERATOR);
+                token = emit(DIVIDE_OPERATOR);
                 return token;
             }
             break;
@@ -209,12 +300,12 @@ Token* Scanner::nextToken()
             if (input[pos] == '=')
             {
                 pos++;
-                token = new Token(EQUAL);
+                token = emit(EQUAL);
                 return token;
             }
             else
             {
-                token = new Token(ASSIGNMENT);
+                token = emit(ASSIGNMENT);
                 return token;
             }
 
@@ -222,7 +313,7 @@ Token* Scanner::nextToken()
             if (input[pos] == '=')
             {
                 pos++;
-                token = new Token(NOT_EQUAL);
+                token = emit(NOT_EQUAL);
                 return token;
             }
             else
@@ -232,35 +323,35 @@ Token* Scanner::nextToken()
             break;
 
         case 19: // )
-            token = new Token(RIGHT_BRACKET);
+            token = emit(RIGHT_BRACKET);
             return token;
 
         case 20: // (
-            token = new Token(LEFT_BRACKET);
+            token = emit(LEFT_BRACKET);
             return token;
 
         case 21: // }
-            token = new Token(RIGHT_CURLY_BRACE);
+            token = emit(RIGHT_CURLY_BRACE);
             return token;
 
         case 22: // {
-            token = new Token(LEFT_CURLY_BRACE);
+            token = emit(LEFT_CURLY_BRACE);
             return token;
 
         case 23: // [
-            token = new Token(LEFT_SQUARE_BRACKET);
+            token = emit(LEFT_SQUARE_BRACKET);
             return token;
 
         case 24: // ]
-            token = new Token(RIGHT_SQUARE_BRACKET);
+            token = emit(RIGHT_SQUARE_BRACKET);
             return token;
 
         case 26: // ,
-            token = new Token(COMMA);
+            token = emit(COMMA);
             return token;
 
         case 27: // ;
-            token = new Token(SEMICOLON);
+            token = emit(SEMICOLON);
             return token;
 
         case 28: // Espaços em branco
@@ -314,15 +405,15 @@ Token* Scanner::nextToken()
             }
             
             pos++; // Avança para além da aspa dupla de fechamento
-            token = new Token(STRING_LITERAL, lexeme);
+            token = emit(STRING_LITERAL, lexeme);
             return token;
 
         case 50: // %
-            token = new Token(MODULO_OPERATOR);
+            token = emit(MODULO_OPERATOR);
             return token;
 
         case 51: // .
-            token = new Token(DOT);
+            token = emit(DOT);
             return token;
 
         default:
@@ -334,6 +425,14 @@ Token* Scanner::nextToken()
 // Função de erro léxico
 void Scanner::lexicalError()
 {
-    cout << "\n[ERRO LEXICO] Linha " << line << ": caractere invalido '" << input[pos] << "'" << endl;
-    exit(1); // Finaliza o programa
+    AllocationScope allocations(ALLOC_DIAGNOSTICS);
+    // A compilacao e interrompida e o erro e reportado por `Parser::run`.
+    Diagnostic d;
+    d.phase = PHASE_LEXICAL;
+    d.line = line;
+    d.column = columnAt(pos);
+    d.offset = pos;
+    d.length = 1;
+    d.message = "caractere invalido '" + string(1, input[pos]) + "'";
+    throw CompileError(d);
 }
@@ -6,15 +6,28 @@ class Scanner
         string input;   // Armazena o texto de entrada, buffer de entrada
         int pos;        // Posicao atual no buffer
         int line;       // Qual linha do arquivo estou
+        int tokenStart; // Posicao e linha do inicio do ultimo token devolvido
+        int tokenLine;
         SymbolTable* symbolTable; // Tabela de simbolos para diferenciar IDs de palavras reservadas
+        Token current;  // Token devolvido por nextToken, reutilizado a cada chamada
+        string lexeme;  // Lexema em construcao, reutilizado a cada chamada
+
+        Token* emit(int type, const string& lexeme = "");
+        Scanner(SymbolTable*);
     
     public:
         // Construtor
-        Scanner(string, SymbolTable*);    // Arquivo de entrada e tabela de simbolos
+        Scanner(string, SymbolTable*, ostream& out = cout); // Arquivo de entrada, tabela de simbolos e saida de erros
+        static Scanner* fromSource(const string&, SymbolTable*, int firstLine = 1); // Texto ja carregado em memoria
 
         int getLine();      // Get para retornar pois arq privado
+        int getTokenLine();   // Linha onde comeca o token atual
+        int getTokenColumn(); // Coluna (a partir de 1) onde comeca o token atual
+        int getTokenOffset(); // Intervalo do token atual no texto, em bytes
+        int getTokenLength();
+        int columnAt(int offset); // Coluna (a partir de 1) de uma posicao do texto
     
-        // Metodo que retorna o proximo token da entrada
+        // Metodo que retorna o proximo token da entrada (valido ate a proxima chamada)
         Token* nextToken();        
     
         // Metodo para manipular erros
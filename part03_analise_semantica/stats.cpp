@@ -0,0 +1,94 @@
+#include "superheader.h"
+#include <cstdio>
+
+thread_local CompilerStats compilerStats;
+
+// Bytes por símbolo antes dos registros compactos, medidos (não calculados) no compilador
+// original: cada declaração alocava um `Token`, um `STEntry` e um nó de `std::map`, e a
+// soma dos blocos do malloc (tamanho utilizável + 8 bytes de cabeçalho) alocados entre o
+// `new Token` e o `add` foi dividida pelo número de declarações. Com `xpp_gen --classes 2000`
+// (81881 símbolos, nomes curtos o bastante para caberem na própria `string`), são exatamente
+// 3 blocos e 240 bytes por símbolo; com `--ident-length 20` os nomes vão para o heap e o
+// custo sobe para ~392 bytes, que o relatório não considera.
+static const size_t LEGACY_BYTES_PER_SYMBOL = 240;
+
+// Slot da tabela hash atual (hash + átomo + ponteiro) mais o byte de controle,
+// considerando a ocupação máxima de 7/8.
+static const size_t SLOT_BYTES = (sizeof(FlatHashMap<Atom, STEntry*>::Slot) + 1) * 8 / 7;
+
+void printStats(ostream& out, SymbolTable* global) {
+    long symbols = compilerStats.symbols;
+    double before = (double) LEGACY_BYTES_PER_SYMBOL;
+    double after = symbols > 0 ? (double) global->arena->bytesUsed() / symbols + SLOT_BYTES : 0;
+    const double MB = 1024.0 * 1024.0;
+
+    out << "\n[STATS] Simbolos declarados:      " << symbols << "\n";
+    out << "[STATS] Nomes internalizados:     " << global->names->size() - 1 << "\n";
+    out << "[STATS] Tipos distintos:          " << global->types->size() - 1 << "\n";
+    out << "[STATS] Tamanho do STEntry:       " << sizeof(STEntry) << " bytes\n";
+    out << "[STATS] Arena (usado/reservado):  " << global->arena->bytesUsed() << " / "
+        << global->arena->bytesReserved() << " bytes\n";
+    out << "[STATS] Bytes por simbolo:        antes ~" << (long) before << ", depois ~" << (long) after << "\n";
+    if (after > 0)
+        out << "[STATS] Simbolos por MB:          antes ~" << (long) (MB / before)
+            << ", depois ~" << (long) (MB / after) << "\n";
+    printCounters(out, compilerStats);
+    out.flush();
+}
+
+void addStats(CompilerStats* total, const CompilerStats& other) {
+    total->symbols += other.symbols;
+#ifndef XPP_NO_STATS
+    for (int t = 0; t <= END_OF_FILE; t++)
+        total->tokens[t] += other.tokens[t];
+    total->identifiers += other.identifiers;
+    total->keywords += other.keywords;
+    total->lookups += other.lookups;
+    total->lookupHops += other.lookupHops;
+    total->scopes += other.scopes;
+    total->scopeDepthMax = std::max(total->scopeDepthMax, other.scopeDepthMax);
+    total->scopeDepthSum += other.scopeDepthSum;
+    for (int k = 0; k <= PARAMETER; k++)
+        total->symbolsByKind[k] += other.symbolsByKind[k];
+#endif
+}
+
+#ifndef XPP_NO_STATS
+static const char* const KIND_NAMES[PARAMETER + 1] = {
+    "reservada", "classe", "variavel", "metodo", "construtor", "parametro"
+};
+
+static string average(long total, long count) {
+    char text[32];
+    snprintf(text, sizeof(text), "%.2f", count > 0 ? (double) total / count : 0.0);
+    return text;
+}
+#endif
+
+void printCounters(ostream& out, const CompilerStats& s) {
+#ifndef XPP_NO_STATS
+    long tokens = 0;
+    for (int t = 0; t <= END_OF_FILE; t++)
+        tokens += s.tokens[t];
+    out << "[STATS] Tokens emitidos:          " << tokens << "\n";
+    for (int t = 0; t <= END_OF_FILE; t++) {
+        if (s.tokens[t] == 0)
+            continue;
+        string name = Token::getTokenTypeName(t);
+        name.resize(std::max<size_t>(name.size() + 1, 24), ' ');
+        out << "[STATS]   " << name << s.tokens[t] << "\n";
+    }
+    out << "[STATS] Identificadores/reserv.:  " << s.identifiers << " / " << s.keywords << "\n";
+    out << "[STATS] Buscas na tabela (get):   " << s.lookups << ", " << s.lookupHops << " saltos para escopos pais (media "
+        << average(s.lookupHops, s.lookups) << ")\n";
+    out << "[STATS] Escopos criados:          " << s.scopes << "\n";
+    out << "[STATS] Profundidade de escopo:   maxima " << s.scopeDepthMax << ", media " << average(s.scopeDepthSum, s.scopes) << "\n";
+    out << "[STATS] Simbolos por tipo:        ";
+    for (int k = 0; k <= PARAMETER; k++)
+        out << (k > 0 ? ", " : "") << KIND_NAMES[k] << " " << s.symbolsByKind[k];
+    out << "\n";
+#else
+    (void) s;
+    out << "[STATS] Contadores do front end:  desativados neste build (NDEBUG ou XPP_NO_STATS)\n";
+#endif
+}
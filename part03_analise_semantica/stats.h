@@ -0,0 +1,45 @@
+#include "superheader.h"
+
+// Contadores coletados durante a compilação e exibidos com `--stats`.
+// Cada thread tem sua própria instância, de modo que compilações paralelas não disputam
+// as mesmas linhas de cache.
+//
+// Os contadores do front end (tokens, buscas, escopos) são atualizados por `XPP_STAT` e
+// somem do código em builds de release (`-DNDEBUG`) ou com `-DXPP_NO_STATS`; `-DXPP_STATS`
+// os mantém em um build de release. `symbols` é sempre contado.
+#if defined(NDEBUG) && !defined(XPP_STATS) && !defined(XPP_NO_STATS)
+#define XPP_NO_STATS
+#endif
+
+struct CompilerStats {
+    long symbols;   // Símbolos adicionados às tabelas (inclui palavras reservadas).
+#ifndef XPP_NO_STATS
+    long tokens[END_OF_FILE + 1];       // Tokens emitidos, por tipo.
+    long identifiers;                   // Estado 2 do scanner: lexemas que não são reservados...
+    long keywords;                      // ... e palavras reservadas.
+    long lookups;                       // Chamadas de `SymbolTable::get`.
+    long lookupHops;                    // Escopos pais visitados por essas buscas.
+    long scopes;                        // Escopos abertos por `Parser::enterScope`.
+    long scopeDepth;                    // Profundidade atual (0: escopo global).
+    long scopeDepthMax;
+    long scopeDepthSum;                 // Soma das profundidades ao abrir cada escopo (média).
+    long symbolsByKind[PARAMETER + 1];  // Símbolos adicionados, por `SymbolKind`.
+#endif
+};
+
+#ifndef XPP_NO_STATS
+#define XPP_STAT(statement) (compilerStats.statement)
+#else
+#define XPP_STAT(statement) ((void) 0)
+#endif
+
+extern thread_local CompilerStats compilerStats;
+
+// Soma os contadores de outra análise (por exemplo, de outro arquivo do programa).
+void addStats(CompilerStats* total, const CompilerStats& other);
+
+// Imprime o relatório de `--stats` para a compilação cuja tabela global é `global`.
+void printStats(ostream&, SymbolTable* global);
+
+// Imprime os contadores do front end (a parte de `printStats` que não depende da tabela).
+void printCounters(ostream&, const CompilerStats&);
@@ -1,45 +1,37 @@
 #include "superheader.h"
 
-// Construtor padrão que inicializa uma entrada de símbolo sem associar um token.
+// Construtor padrão que inicializa uma entrada de símbolo vazia.
 STEntry::STEntry() {
-    token = nullptr;
-    reserved = false;
-    kind = KEYWORD;
-    type = "";
-    isArray = false;
-    parentClass = "";
+    name = NO_ATOM;
+    type = NO_TYPE;
+    parentClass = NO_ATOM;
     line = 0;
-}
-
-// O símbolo não é marcado como reservado por padrão.
-STEntry::STEntry(Token* tok) {
-    token = tok;
+    kind = KEYWORD;
+    tokenType = UNDEFINED;
     reserved = false;
-    kind = VARIABLE;
-    type = "";
     isArray = false;
-    parentClass = "";
-    line = 0;
 }
 
-// Construtor que inicializa uma entrada de símbolo com um token e uma flag de reserva.
-STEntry::STEntry(Token* tok, bool res) {
-    token = tok;
-    reserved = res;
-    kind = res ? KEYWORD : VARIABLE;
-    type = "";
-    isArray = false;
-    parentClass = "";
+// Construtor para palavras reservadas: guarda o tipo de token que o scanner deve devolver.
+STEntry::STEntry(Atom n, int tok) {
+    name = n;
+    type = NO_TYPE;
+    parentClass = NO_ATOM;
     line = 0;
+    kind = KEYWORD;
+    tokenType = (uint8_t) tok;
+    reserved = true;
+    isArray = false;
 }
 
 // Construtor completo para análise semântica detalhada.
-STEntry::STEntry(Token* tok, SymbolKind k, string t, bool arr, int ln) {
-    token = tok;
-    reserved = false;
-    kind = k;
+STEntry::STEntry(Atom n, SymbolKind k, TypeId t, bool arr, int ln) {
+    name = n;
     type = t;
-    isArray = arr;
-    parentClass = "";
+    parentClass = NO_ATOM;
     line = ln;
+    kind = k;
+    tokenType = ID;
+    reserved = false;
+    isArray = arr;
 }
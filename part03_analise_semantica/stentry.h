@@ -1,7 +1,7 @@
 #include "superheader.h"
 
 // Enumeração para tipos de símbolos na tabela.
-enum SymbolKind {
+enum SymbolKind : uint8_t {
     KEYWORD,        // Palavra reservada
     CLASS_NAME,     // Nome de classe
     VARIABLE,       // Variável local ou de classe
@@ -11,21 +11,25 @@ enum SymbolKind {
 };
 
 // A classe `STEntry` representa uma entrada na tabela de símbolos.
-// Cada entrada contém um ponteiro para um token associado e informações
-// semânticas sobre o símbolo.
+// O registro é compacto (20 bytes): nomes são átomos do `Interner`, tipos são `TypeId`s da
+// `TypeTable` da compilação e as entradas são alocadas na `Arena` da compilação com `new (arena) STEntry(...)`.
 class STEntry {
 public:
-    Token* token;           // Ponteiro para o token associado.
-    bool reserved;          // Indica se o símbolo é uma palavra reservada.
+    Atom name;              // Nome (lexema) internalizado.
+    TypeId type;            // Tipo do símbolo (int, string, classe ou array).
+    Atom parentClass;       // Para classes: classe pai (se houver herança).
+    int line;               // Linha onde foi declarado.
     SymbolKind kind;        // Tipo do símbolo (classe, variável, método, etc.)
-    string type;            // Tipo do símbolo (int, string, nome de classe)
-    bool isArray;           // Indica se é um array
-    string parentClass;     // Para classes: classe pai (se houver herança)
-    int line;               // Linha onde foi declarado
+    uint8_t tokenType;      // Para palavras reservadas: tipo do token (CLASS, INT, ...).
+    bool reserved;          // Indica se o símbolo é uma palavra reservada.
+    bool isArray;           // Indica se é um array.
 
     // Construtores para criar uma entrada de símbolo com diferentes configurações.
-    STEntry(); 
-    STEntry(Token*);   
-    STEntry(Token*, bool);
-    STEntry(Token*, SymbolKind, string type = "", bool isArray = false, int line = 0);
+    STEntry();
+    STEntry(Atom, int tokenType);   // Palavra reservada.
+    STEntry(Atom, SymbolKind, TypeId type = NO_TYPE, bool isArray = false, int line = 0);
+
+    // Entradas vivem na arena da compilação.
+    static void* operator new(size_t size, Arena* arena) { return arena->allocate(size, alignof(STEntry)); }
+    static void operator delete(void*, Arena*) {}
 };
@@ -9,12 +9,57 @@
 #include <map>
 #include <fstream>
 #include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <cstdlib>
+#include <string_view>
+#include <new>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <memory>
+#include <functional>
+#include <filesystem>
+#include <chrono>
+#include <sstream>
+#include <thread>
+#include <condition_variable>
+#include <deque>
+#include <set>
+#include <type_traits>
 
 // Project Headers
 #include "token.h"         // Defines Token and enum Names
+#include "allocations.h"   // Defines AllocationScope (allocation accounting, --alloc-report)
+#include "probes.h"        // Defines XPP_PROBE2/3 (USDT static tracepoints for bpftrace/perf)
+#include "flathashmap.h"   // Defines FlatHashMap (open-addressing hash table)
+#include "arena.h"         // Defines Arena (per-compilation bump allocator)
+#include "interner.h"      // Defines Interner and Atom (interned names)
+#include "typetable.h"     // Defines TypeTable and TypeId (interned types)
 #include "stentry.h"       // Defines STEntry class
+#include "classhierarchy.h" // Defines ClassHierarchy (subtype index and member tables)
+#include "classsource.h"   // Defines InterfaceClass and ClassSource (classes imported by getClass)
+#include "moduleinterface.h" // Defines ModuleInterface (binary .xpi class interfaces)
 #include "symboltable.h"   // Defines SymbolTable class
+#include "persistentsymboltable.h" // Defines PersistentSymbolTable (copy-on-write snapshots)
+#include "stats.h"         // Defines CompilerStats (--stats report)
+#include "perfcounters.h" // Defines PerfCounters (hardware counters, --perf-counters)
+#include "timereport.h"    // Defines TimeReport and PhaseTimer (--time-report)
+#include "trace.h"         // Defines Trace and TraceSpan (--trace, Chrome trace events)
+#include "crossreference.h" // Defines CrossReference (declarations and uses of identifiers)
+#include "diagnostics.h"   // Defines Diagnostic, CompileError and DiagnosticWriter (human/JSON/SARIF output)
 #include "scanner.h"       // Defines Scanner class
 #include "parser.h"        // Defines Parser class
+#include "compilationcache.h" // Defines CompilationCache (content-addressed result cache)
+#include "xrefindex.h"     // Defines XrefIndex (on-disk cross-reference index, --emit-xref)
+#include "outline.h"       // Defines Outline (class ranges and dependencies without parsing)
+#include "incrementalbuild.h" // Defines IncrementalBuild (class-granular rebuilds)
+#include "compilation.h"   // Defines Compilation (owner of all per-compilation objects)
+#include "threadpool.h"    // Defines ThreadPool (fixed worker threads)
+#include "programbuild.h"  // Defines ProgramBuild (multi-file programs with imports)
+#include "documentanalysis.h" // Defines DocumentAnalysis (per-class reanalysis for the language server)
+#include "driver.h"        // Defines CompilerOptions and runCompiler (command-line driver)
 
 #endif // SUPERHEADER_H
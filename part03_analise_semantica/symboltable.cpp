@@ -1,30 +1,71 @@
 #include "superheader.h"
 
 // Construtor padrão que inicializa uma nova tabela de símbolos sem um escopo pai.
+// A tabela raiz cria a arena, o `Interner`, a `TypeTable` e a `ClassHierarchy`
+// compartilhados pelos escopos filhos.
 SymbolTable::SymbolTable() {
-    parent = nullptr;
+    createState(nullptr);
+}
+
+// Tabela raiz de uma compilação sobre um prelúdio congelado (palavras reservadas e nomes
+// compartilhados por todas as compilações de um processo, como no daemon). O prelúdio vira
+// o escopo pai e o `Interner` da compilação estende o dele; nada do prelúdio é alterado.
+SymbolTable* SymbolTable::withPrelude(SymbolTable* prelude) {
+    SymbolTable* table = new SymbolTable(prelude);
+    table->createState(prelude);
+    return table;
+}
+
+void SymbolTable::createState(SymbolTable* prelude) {
+    AllocationScope allocations(ALLOC_SYMBOLS);
+    parent = prelude;
+    arena = new Arena();
+    names = new Interner(arena, prelude != nullptr ? prelude->names : nullptr);
+    types = new TypeTable(names);
+    classes = new ClassHierarchy(types);
+    ownsState = true;
 }
 
 // O escopo pai é usado para busca hierárquica de símbolos em escopos mais amplos.
 SymbolTable::SymbolTable(SymbolTable* p) {
     parent = p;
+    arena = p->arena;
+    names = p->names;
+    types = p->types;
+    classes = p->classes;
+    ownsState = false;
+}
+
+// Todas as entradas (`STEntry`) e nomes da compilação vivem na arena, então a liberação
+// da tabela raiz é uma única operação, sem percorrer os escopos. As interfaces importadas
+// pertencem à `Compilation` (e podem ser compartilhadas entre compilações).
+SymbolTable::~SymbolTable() {
+    if (!ownsState)
+        return;
+    delete classes;
+    delete types;
+    delete names;
+    delete arena;
 }
 
 // Tenta adicionar um novo símbolo à tabela atual.
 // - Se já houver um símbolo com o mesmo lexema, a função retorna `false` sem adicionar.
 // - Caso contrário, o símbolo é inserido e a função retorna `true`.
 bool SymbolTable::add(STEntry* t) {
-    if (symbols.find(t->token->lexeme) != symbols.end())
+    AllocationScope allocations(ALLOC_SYMBOLS);
+    if (!symbols.insert(t->name, t))
         return false; // Símbolo já existe.
-    
-    symbols.insert({t->token->lexeme, t});
+
+    compilerStats.symbols++;
+    XPP_STAT(symbolsByKind[t->kind]++);
     return true;
 }
 
 // Remove um símbolo da tabela baseado no lexema fornecido.
 // ou `false` caso contrário.
-bool SymbolTable::remove(string name) {
-    return symbols.erase(name) != 0;
+bool SymbolTable::remove(const string& name) {
+    Atom atom = names->find(name);
+    return atom != NO_ATOM && symbols.erase(atom);
 }
 
 // Limpa todos os símbolos do escopo atual, esvaziando a tabela.
@@ -37,25 +78,132 @@ bool SymbolTable::isEmpty() {
 }
 
 // Busca um símbolo pelo nome (lexema).
+// Um nome que nunca foi internalizado não pode estar em nenhum escopo, então a busca
+// termina sem consultar as tabelas.
+STEntry* SymbolTable::get(const string& name) {
+    Atom atom = names->find(name);
+    if (atom == NO_ATOM) {
+        XPP_STAT(lookups++);
+        return nullptr;
+    }
+    return get(atom);
+}
+
 // A busca é feita primeiro na tabela atual e, se não encontrado, sobe na hierarquia
-// até o escopo global (tabela raiz):
+// até o escopo global (tabela raiz). O hash do átomo é calculado uma única vez e
+// reaproveitado em todos os escopos:
 // - Retorna um ponteiro para o `STEntry` se o símbolo for encontrado.
 // - Retorna `nullptr` se o símbolo não for encontrado em nenhum escopo.
-STEntry* SymbolTable::get(string name) {
-    SymbolTable* table = this;
-    auto s = table->symbols.find(name);
-
-    while (s == table->symbols.end()) { // Continuar a busca nos escopos superiores.
-        table = table->parent;
-        if (table == nullptr) 
-            return nullptr; // Chegou ao topo da hierarquia e não encontrou o símbolo.
-        s = table->symbols.find(name);
+STEntry* SymbolTable::get(Atom name) {
+    uint64_t hash = symbols.hash(name);
+    XPP_STAT(lookups++);
+
+    for (SymbolTable* table = this; table != nullptr; table = table->parent) {
+        STEntry** s = table->symbols.findHashed(name, hash);
+        if (s != nullptr)
+            return *s;
+        XPP_STAT(lookupHops += table->parent != nullptr);
+    }
+
+    return nullptr; // Chegou ao topo da hierarquia e não encontrou o símbolo.
+}
+
+// Busca um símbolo apenas no escopo atual, sem subir para os escopos pais.
+// Usado nas verificações de redeclaração.
+STEntry* SymbolTable::getLocal(const string& name) {
+    Atom atom = names->find(name);
+    if (atom == NO_ATOM)
+        return nullptr;
+
+    STEntry** s = symbols.find(atom);
+    return s != nullptr ? *s : nullptr;
+}
+
+// Busca uma classe no escopo global. Se ela não foi declarada nesta compilação, procura nas
+// interfaces importadas e materializa apenas essa classe (e suas ancestrais): o custo da
+// importação é proporcional às classes efetivamente usadas. Uma classe importada cuja pai
+// não está em nenhuma interface é um erro semântico; sem posição no fonte, o parser o
+// reporta no token atual.
+STEntry* SymbolTable::getClass(const string& name) {
+    AllocationScope allocations(ALLOC_SYMBOLS);
+    STEntry* entry = get(name);
+    if (entry != nullptr || modules.empty())
+        return entry;
+
+    InterfaceClass ic;
+    for (ClassSource* module : modules) {
+        if (!module->findClass(name, &ic))
+            continue;
+
+        Atom atom = intern(name);
+        TypeId type = types->classType(atom);
+        TypeId parentType = ic.parent.empty() ? NO_TYPE : types->classType(intern(ic.parent));
+
+        // A entrada é criada antes de importar a classe pai: um ciclo de extends entre
+        // interfaces encontra esta entrada e para; o ciclo é reportado por ClassHierarchy::build.
+        entry = new (arena) STEntry(atom, CLASS_NAME, type, false, ic.line);
+        entry->parentClass = intern(ic.parent);
+        add(entry);
+
+        // A classe pai precisa estar completa para que a tabela de membros seja achatada.
+        if (parentType != NO_TYPE) {
+            STEntry* parent = getClass(string(ic.parent));
+            if (parent == nullptr || parent->kind != CLASS_NAME) {
+                Diagnostic d;
+                d.phase = PHASE_SEMANTIC;
+                d.message = "Classe pai '" + string(ic.parent) + "' nao foi declarada";
+                throw CompileError(d);
+            }
+        }
+
+        classes->addClass(type, parentType, ic.line);
+        classes->markImported(type);
+
+        std::vector<TypeId> params;
+        for (const InterfaceMember& m : ic.members) {
+            Atom memberName = intern(m.name);
+            TypeId memberType = types->fromName(m.type);
+            if (m.kind == METHOD) {
+                classes->addMethod(type, memberName, memberType, m.isArray, m.line);
+                params.clear();
+                for (std::string_view p : m.params)
+                    params.push_back(types->fromName(p));
+                classes->setParams(type, memberName, params);
+            } else {
+                classes->addField(type, memberName, memberType, m.isArray, m.line);
+            }
+        }
+        return entry;
     }
-    
-    return s->second;
+    return nullptr;
 }
 
 // Útil para navegação hierárquica entre diferentes escopos.
 SymbolTable* SymbolTable::getParent() {
     return parent;
 }
+
+// Palavras reservadas da linguagem X++.
+SymbolTable* SymbolTable::initializeKeywords() {
+    static const struct { const char* lexeme; int type; } keywords[] = {
+        { "class", CLASS },     { "extends", EXTENDS }, { "int", INT },
+        { "string", STRING },   { "break", BREAK },     { "print", PRINT },
+        { "read", READ },       { "return", RETURN },   { "super", SUPER },
+        { "if", IF },           { "else", ELSE },       { "for", FOR },
+        { "new", NEW },         { "constructor", CONSTRUCTOR }, { "import", IMPORT }
+    };
+
+    for (const auto& k : keywords)
+        add(new (arena) STEntry(intern(k.lexeme), k.type));
+
+    return this;
+}
+
+Atom SymbolTable::intern(std::string_view name) {
+    AllocationScope allocations(ALLOC_SYMBOLS);
+    return names->intern(name);
+}
+
+string SymbolTable::nameOf(Atom atom) {
+    return string(names->str(atom));
+}
@@ -1,24 +1,47 @@
 #include "superheader.h"
 
-// A classe `SymbolTable` representa uma tabela de símbolos que utiliza um mapa (`map`) para
-// armazenar pares de chave-valor, onde a chave é uma string (o lexema) e o valor é um ponteiro
-// para um objeto da classe `STEntry`.
+// A classe `SymbolTable` representa uma tabela de símbolos que utiliza uma tabela hash de
+// endereçamento aberto (`FlatHashMap`) para armazenar pares de chave-valor, onde a chave é o
+// átomo do nome (lexema) e o valor é um ponteiro para um objeto da classe `STEntry`.
 // A tabela suporta escopos hierárquicos através da referência à tabela pai.
+// Todos os escopos de uma compilação compartilham a mesma arena, o mesmo `Interner`, a
+// mesma `TypeTable` e a mesma `ClassHierarchy`, criados pela tabela raiz.
 class SymbolTable {
 public:
     SymbolTable* parent; // Referência à tabela pai (escopo imediatamente anterior).
-    std::map<std::string, STEntry*> symbols; // Armazena os símbolos do escopo atual.
+    FlatHashMap<Atom, STEntry*> symbols; // Armazena os símbolos do escopo atual.
+    Arena* arena;        // Arena onde as entradas da compilação são alocadas.
+    Interner* names;     // Nomes internalizados da compilação.
+    TypeTable* types;    // Tipos internalizados da compilação.
+    ClassHierarchy* classes; // Índice de herança das classes declaradas.
+    std::vector<ClassSource*> modules; // Interfaces importadas (apenas na tabela raiz, sem posse).
 
     // Construtores para criar tabelas de símbolos, com ou sem um escopo pai.
     SymbolTable();
     SymbolTable(SymbolTable*);
+    ~SymbolTable(); // A tabela raiz libera a arena e o estado compartilhado da compilação.
+    static SymbolTable* withPrelude(SymbolTable* prelude); // Tabela raiz sobre um prelúdio congelado.
 
     // Funções para manipulação da tabela de símbolos.
-    bool add(STEntry*);          // Adiciona um novo símbolo.
-    bool remove(std::string);    // Remove um símbolo.
-    void clear();                // Limpa todos os símbolos.
-    bool isEmpty();              // Verifica se a tabela está vazia.
-    STEntry* get(std::string);   // Busca um símbolo pelo nome (lexema).
-    SymbolTable* getParent();    // Retorna a tabela pai (escopo anterior).
-    SymbolTable* initializeKeywords();        // Inicializa a tabela de símbolos com palavras-chave.
+    bool add(STEntry*);                    // Adiciona um novo símbolo.
+    bool remove(const std::string&);       // Remove um símbolo.
+    void clear();                          // Limpa todos os símbolos.
+    bool isEmpty();                        // Verifica se a tabela está vazia.
+    STEntry* get(const std::string&);      // Busca um símbolo pelo nome (lexema).
+    STEntry* get(Atom);                    // Busca um símbolo pelo átomo do nome.
+    STEntry* getLocal(const std::string&); // Busca um símbolo apenas no escopo atual.
+    STEntry* getClass(const std::string&); // Busca uma classe, importando-a das interfaces se preciso.
+    SymbolTable* getParent();              // Retorna a tabela pai (escopo anterior).
+    SymbolTable* initializeKeywords();     // Inicializa a tabela de símbolos com palavras-chave.
+
+    Atom intern(std::string_view);         // Internaliza um nome no `Interner` da compilação.
+    std::string nameOf(Atom);              // Texto de um átomo.
+
+private:
+    bool ownsState; // Se esta tabela criou (e deve liberar) a arena e as tabelas compartilhadas.
+
+    void createState(SymbolTable* prelude);
+
+    SymbolTable(const SymbolTable&);
+    SymbolTable& operator=(const SymbolTable&);
 };
@@ -0,0 +1,81 @@
+#include "superheader.h"
+
+ThreadPool::ThreadPool(size_t threads) {
+    running = 0;
+    stopping = false;
+    if (threads == 0)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    workerStats.resize(threads, WorkerStats());
+    idleSince.resize(threads, Clock::now());
+    for (size_t i = 0; i < threads; i++)
+        workers.push_back(std::thread(&ThreadPool::work, this, i));
+}
+
+ThreadPool::~ThreadPool() {
+    wait();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    ready.notify_all();
+    for (std::thread& t : workers)
+        t.join();
+}
+
+void ThreadPool::submit(std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        queue.push_back(std::move(task));
+    }
+    ready.notify_one();
+}
+
+void ThreadPool::wait() {
+    std::unique_lock<std::mutex> lock(mutex);
+    idle.wait(lock, [this] { return queue.empty() && running == 0; });
+}
+
+size_t ThreadPool::size() {
+    return workers.size();
+}
+
+// A espera em andamento de uma thread parada também conta como tempo ocioso.
+std::vector<ThreadPool::WorkerStats> ThreadPool::stats() {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<WorkerStats> result = workerStats;
+    Clock::time_point now = Clock::now();
+    for (size_t i = 0; i < result.size(); i++)
+        if (idleSince[i] != Clock::time_point())
+            result[i].idleMs += std::chrono::duration<double, std::milli>(now - idleSince[i]).count();
+    return result;
+}
+
+void ThreadPool::work(size_t index) {
+    typedef std::chrono::duration<double, std::milli> Ms;
+    WorkerStats& stats = workerStats[index];
+    std::unique_lock<std::mutex> lock(mutex);
+    for (;;) {
+        ready.wait(lock, [this] { return stopping || !queue.empty(); });
+        if (queue.empty())
+            return; // Encerrando.
+
+        std::function<void()> task = std::move(queue.front());
+        queue.pop_front();
+        running++;
+        Clock::time_point start = Clock::now();
+        stats.idleMs += Ms(start - idleSince[index]).count();
+        idleSince[index] = Clock::time_point();
+        lock.unlock();
+        task();
+        Clock::time_point done = Clock::now();
+        lock.lock();
+        Clock::time_point locked = Clock::now();
+        stats.tasks++;
+        stats.busyMs += Ms(done - start).count();
+        stats.lockMs += Ms(locked - done).count();
+        idleSince[index] = locked;
+        running--;
+        if (queue.empty() && running == 0)
+            idle.notify_all();
+    }
+}
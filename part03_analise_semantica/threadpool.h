@@ -0,0 +1,44 @@
+#include "superheader.h"
+
+// A classe `ThreadPool` mantém um número fixo de threads que executam tarefas de uma fila.
+// Uma tarefa pode enfileirar outras (por exemplo, os arquivos que só podiam ser analisados
+// depois dela); `wait` retorna quando a fila esvazia e nenhuma tarefa está em execução.
+//
+// Cada thread mede, desde a criação do pool, o tempo executando tarefas, o tempo parada com
+// a fila vazia e o tempo esperando o mutex da fila ao terminar uma tarefa (quatro leituras
+// do relógio por tarefa, desprezíveis diante da análise de um arquivo).
+class ThreadPool {
+public:
+    struct WorkerStats {
+        long tasks;
+        double busyMs;      // Executando tarefas.
+        double idleMs;      // Esperando uma tarefa com a fila vazia.
+        double lockMs;      // Esperando o mutex da fila depois de uma tarefa.
+    };
+
+    ThreadPool(size_t threads); // 0: uma thread por núcleo.
+    ~ThreadPool();              // Espera as tarefas pendentes e encerra as threads.
+
+    void submit(std::function<void()> task);
+    void wait();
+    size_t size();
+    std::vector<WorkerStats> stats(); // Uma entrada por thread.
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> queue;
+    std::mutex mutex;
+    std::condition_variable ready;  // Há tarefa na fila (ou o pool está encerrando).
+    std::condition_variable idle;   // A fila esvaziou e nenhuma tarefa está em execução.
+    size_t running;
+    bool stopping;
+    std::vector<WorkerStats> workerStats;       // Protegido por `mutex`.
+    std::vector<Clock::time_point> idleSince;   // Início da espera atual (ou `time_point()`).
+
+    void work(size_t index);
+
+    ThreadPool(const ThreadPool&);
+    ThreadPool& operator=(const ThreadPool&);
+};
@@ -0,0 +1,325 @@
+#include "superheader.h"
+#include <cstdio>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
+thread_local TimeReport* activeTimeReport = nullptr;
+
+static const char* const PHASE_NAMES[TIME_PHASES] = { "leitura", "lexico", "sintatico", "semantico", "interface" };
+
+uint64_t readTicks() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return (uint64_t) std::chrono::steady_clock::now().time_since_epoch().count();
+#endif
+}
+
+// CPU da thread e pico de RSS do processo.
+static void readUsage(double* cpuMs, long* rssKB) {
+#ifndef _WIN32
+    struct rusage ru;
+#ifdef RUSAGE_THREAD
+    getrusage(RUSAGE_THREAD, &ru);
+#else
+    getrusage(RUSAGE_SELF, &ru);
+#endif
+    *cpuMs = (ru.ru_utime.tv_sec + ru.ru_stime.tv_sec) * 1e3 + (ru.ru_utime.tv_usec + ru.ru_stime.tv_usec) / 1e3;
+#ifdef __APPLE__
+    *rssKB = ru.ru_maxrss / 1024;
+#else
+    *rssKB = ru.ru_maxrss;
+#endif
+#else
+    *cpuMs = 0;
+    *rssKB = 0;
+#endif
+}
+
+TimeReport::TimeReport() {
+    memset(totals, 0, sizeof(totals));
+    memset(outerTicks, 0, sizeof(outerTicks));
+    depth = 0;
+    last = startTicks = 0;
+    outerCpu = 0;
+    outerRss = 0;
+    bytes = 0;
+    previous = nullptr;
+    counting = false;
+    memset(outerEvents, 0, sizeof(outerEvents));
+    memset(eventAvailable, 0, sizeof(eventAvailable));
+}
+
+void TimeReport::countEvents() {
+    counting = true;
+}
+
+bool TimeReport::countsEvents() {
+    return counting;
+}
+
+void TimeReport::start() {
+    if (counting && perf == nullptr) {
+        perf.reset(new PerfCounters());
+        if (!perf->open())
+            eventError = perf->error();
+        for (int e = 0; e < PERF_EVENTS; e++)
+            eventAvailable[e] = perf->available((PerfEvent) e);
+    }
+    previous = activeTimeReport;
+    activeTimeReport = this;
+    startTime = std::chrono::steady_clock::now();
+    startTicks = last = readTicks();
+}
+
+// Calibração: ticks por nanossegundo no intervalo entre `start` e `stop`.
+void TimeReport::stop() {
+    uint64_t ticks = readTicks() - startTicks;
+    double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - startTime).count();
+    double msPerTick = ticks > 0 ? ns / 1e6 / (double) ticks : 0;
+    for (Totals& t : totals) {
+        t.wallMs += (double) t.ticks * msPerTick;
+        t.ticks = 0;
+    }
+    activeTimeReport = previous;
+}
+
+// Atribui o intervalo desde a última transição à fase mais interna.
+void TimeReport::charge(uint64_t now) {
+    totals[stack[depth - 1]].ticks += now - last;
+    last = now;
+}
+
+// Chamadas aninhadas da mesma fase (um método semântico que chama outro) não mudam a
+// atribuição, então a pilha só cresce quando a fase muda.
+bool TimeReport::enter(TimedPhase phase) {
+    if (depth > 0 && (stack[depth - 1] == phase || depth == (int) (sizeof(stack) / sizeof(stack[0]))))
+        return false;
+    if (depth == 0) {
+        readUsage(&outerCpu, &outerRss);
+        if (perf != nullptr)
+            perf->read(outerEvents);
+        for (int i = 0; i < TIME_PHASES; i++)
+            outerTicks[i] = totals[i].ticks;
+        last = readTicks(); // A chamada ao sistema não entra na fase.
+    } else {
+        charge(readTicks());
+    }
+    stack[depth++] = phase;
+    totals[phase].calls++;
+    return true;
+}
+
+void TimeReport::leave() {
+    charge(readTicks());
+    if (--depth > 0)
+        return;
+
+    uint64_t events[PERF_EVENTS];
+    if (perf != nullptr) {
+        perf->read(events);
+        for (int e = 0; e < PERF_EVENTS; e++)
+            totals[stack[0]].events[e] += events[e] - outerEvents[e];
+    }
+    double cpu;
+    long rss;
+    readUsage(&cpu, &rss);
+    uint64_t spent = 0;
+    for (int i = 0; i < TIME_PHASES; i++)
+        spent += totals[i].ticks - outerTicks[i];
+    for (int i = 0; i < TIME_PHASES && spent > 0; i++)
+        totals[i].cpuMs += (cpu - outerCpu) * (double) (totals[i].ticks - outerTicks[i]) / (double) spent;
+    totals[stack[0]].rssKB += rss - outerRss;
+    totals[stack[0]].outer = true;
+}
+
+void TimeReport::addBytes(size_t n) {
+    bytes += n;
+}
+
+void TimeReport::merge(const TimeReport& other) {
+    for (int i = 0; i < TIME_PHASES; i++) {
+        totals[i].wallMs += other.totals[i].wallMs;
+        totals[i].cpuMs += other.totals[i].cpuMs;
+        totals[i].rssKB += other.totals[i].rssKB;
+        totals[i].calls += other.totals[i].calls;
+        totals[i].outer = totals[i].outer || other.totals[i].outer;
+        for (int e = 0; e < PERF_EVENTS; e++)
+            totals[i].events[e] += other.totals[i].events[e];
+    }
+    for (int e = 0; e < PERF_EVENTS; e++)
+        eventAvailable[e] = eventAvailable[e] || other.eventAvailable[e];
+    if (eventError.empty())
+        eventError = other.eventError;
+    bytes += other.bytes;
+}
+
+long TimeReport::rssGrowthKB(TimedPhase phase) {
+    return totals[phase].rssKB;
+}
+
+// Vazão de cada fase: o fonte inteiro (bytes e tokens) dividido pelo tempo da fase.
+void TimeReport::print(ostream& out) {
+    const double MB = 1024.0 * 1024.0;
+    long tokens = totals[TIME_LEXICAL].calls;
+    char line[160];
+
+    snprintf(line, sizeof(line), "\n[TEMPO] %-10s %10s %10s %10s %10s %12s %10s\n",
+             "Fase", "Real (ms)", "CPU (ms)", "Entradas", "MB/s", "Tokens/s", "RSS (+KB)");
+    out << line;
+
+    Totals sum = Totals();
+    for (int i = 0; i <= TIME_PHASES; i++) {
+        const Totals& t = i < TIME_PHASES ? totals[i] : sum;
+        if (i < TIME_PHASES) {
+            sum.wallMs += t.wallMs;
+            sum.cpuMs += t.cpuMs;
+            sum.rssKB += t.rssKB;
+            sum.calls += t.calls;
+            sum.outer = sum.outer || t.outer;
+        }
+        double seconds = t.wallMs / 1e3;
+        char rate[16] = "-", tokenRate[16] = "-", rss[16] = "-";
+        if (seconds > 0 && bytes > 0) {
+            snprintf(rate, sizeof(rate), "%.1f", bytes / MB / seconds);
+            snprintf(tokenRate, sizeof(tokenRate), "%.0f", tokens / seconds);
+        }
+        if (t.outer)
+            snprintf(rss, sizeof(rss), "%ld", t.rssKB);
+        snprintf(line, sizeof(line), "[TEMPO] %-10s %10.3f %10.3f %10ld %10s %12s %10s\n",
+                 i < TIME_PHASES ? PHASE_NAMES[i] : "total", t.wallMs, t.cpuMs, t.calls, rate, tokenRate, rss);
+        out << line;
+    }
+}
+
+// As fases externas da tabela de `--perf-counters`: a análise sintática inclui a léxica e a
+// semântica, que rodam dentro dela.
+static const char* eventPhaseName(int phase) {
+    return phase == TIME_SYNTAX ? "analise" : PHASE_NAMES[phase];
+}
+
+void TimeReport::printEvents(ostream& out) {
+    bool any = false;
+    for (bool available : eventAvailable)
+        any = any || available;
+    if (!any) {
+        out << "\n[PERF] Contadores de hardware indisponiveis: " << (eventError.empty() ? "sem suporte" : eventError) << "\n";
+        return;
+    }
+
+    char line[200];
+    auto count = [&](char* text, size_t size, int e, double value, const char* format) {
+        if (eventAvailable[e])
+            snprintf(text, size, format, value);
+        else
+            snprintf(text, size, "-");
+    };
+
+    snprintf(line, sizeof(line), "\n[PERF] %-10s %14s %14s %6s %12s %12s %12s\n",
+             "Fase", "Ciclos", "Instrucoes", "IPC", "Desvios err.", "Falhas L1D", "Falhas LLC");
+    out << line;
+    uint64_t sum[PERF_EVENTS] = {};
+    for (int i = 0; i <= TIME_PHASES; i++) {
+        if (i < TIME_PHASES && !totals[i].outer)
+            continue;
+        const uint64_t* v = i < TIME_PHASES ? totals[i].events : sum;
+        if (i < TIME_PHASES)
+            for (int e = 0; e < PERF_EVENTS; e++)
+                sum[e] += v[e];
+        char c[PERF_EVENTS][24], ipc[16] = "-";
+        for (int e = 0; e < PERF_EVENTS; e++)
+            count(c[e], sizeof(c[e]), e, (double) v[e], "%.0f");
+        if (eventAvailable[PERF_CYCLES] && eventAvailable[PERF_INSTRUCTIONS] && v[PERF_CYCLES] > 0)
+            snprintf(ipc, sizeof(ipc), "%.2f", (double) v[PERF_INSTRUCTIONS] / v[PERF_CYCLES]);
+        snprintf(line, sizeof(line), "[PERF] %-10s %14s %14s %6s %12s %12s %12s\n",
+                 i < TIME_PHASES ? eventPhaseName(i) : "total", c[PERF_CYCLES], c[PERF_INSTRUCTIONS], ipc,
+                 c[PERF_BRANCH_MISSES], c[PERF_L1D_MISSES], c[PERF_LLC_MISSES]);
+        out << line;
+    }
+
+    // Normalizados pelo fonte inteiro, para comparar entradas de tamanhos diferentes.
+    long tokens = totals[TIME_LEXICAL].calls;
+    double kb = bytes / 1024.0;
+    const char* labels[2] = { "Por token", "Por KB" };
+    double units[2] = { (double) tokens, kb };
+    for (int u = 0; u < 2; u++) {
+        if (units[u] <= 0)
+            continue;
+        char c[PERF_EVENTS][24];
+        for (int e = 0; e < PERF_EVENTS; e++)
+            count(c[e], sizeof(c[e]), e, sum[e] / units[u], "%.2f");
+        snprintf(line, sizeof(line), "[PERF] %-10s %14s %14s %6s %12s %12s %12s\n",
+                 labels[u], c[PERF_CYCLES], c[PERF_INSTRUCTIONS], "", c[PERF_BRANCH_MISSES], c[PERF_L1D_MISSES], c[PERF_LLC_MISSES]);
+        out << line;
+    }
+}
+
+// {"available": ..., "tokens": N, "bytes": N, "phases": {fase: {evento: N, "ipc": x}},
+//  "total": {...}, "per_token": {...}, "per_kb": {...}}; eventos indisponíveis são `null`.
+string TimeReport::eventsJson() {
+    bool any = false;
+    for (bool available : eventAvailable)
+        any = any || available;
+    long tokens = totals[TIME_LEXICAL].calls;
+    char number[32];
+
+    string out = "{\"available\":";
+    out += any ? "true" : "false";
+    out += ",\"error\":";
+    appendJson(out, any ? "" : eventError);
+    out += ",\"tokens\":" + to_string(tokens) + ",\"bytes\":" + to_string(bytes);
+
+    // `raw`: contagens inteiras e o IPC; senão, contagens divididas por `unit`.
+    auto object = [&](const uint64_t* v, double unit, bool raw) {
+        out += "{";
+        for (int e = 0; e < PERF_EVENTS; e++) {
+            out += e > 0 ? ",\"" : "\"";
+            out += PerfCounters::eventName((PerfEvent) e);
+            out += "\":";
+            if (!eventAvailable[e] || unit <= 0) {
+                out += "null";
+                continue;
+            }
+            snprintf(number, sizeof(number), raw ? "%.0f" : "%.4f", v[e] / unit);
+            out += number;
+        }
+        if (raw) {
+            out += ",\"ipc\":";
+            if (eventAvailable[PERF_CYCLES] && eventAvailable[PERF_INSTRUCTIONS] && v[PERF_CYCLES] > 0) {
+                snprintf(number, sizeof(number), "%.4f", (double) v[PERF_INSTRUCTIONS] / v[PERF_CYCLES]);
+                out += number;
+            } else {
+                out += "null";
+            }
+        }
+        out += "}";
+    };
+
+    uint64_t sum[PERF_EVENTS] = {};
+    out += ",\"phases\":{";
+    bool first = true;
+    for (int i = 0; i < TIME_PHASES; i++) {
+        if (!totals[i].outer)
+            continue;
+        for (int e = 0; e < PERF_EVENTS; e++)
+            sum[e] += totals[i].events[e];
+        out += first ? "\"" : ",\"";
+        first = false;
+        out += eventPhaseName(i);
+        out += "\":";
+        object(totals[i].events, 1, true);
+    }
+    out += "},\"total\":";
+    object(sum, 1, true);
+    out += ",\"per_token\":";
+    object(sum, (double) tokens, false);
+    out += ",\"per_kb\":";
+    object(sum, bytes / 1024.0, false);
+    out += "}\n";
+    return out;
+}
@@ -0,0 +1,106 @@
+#include "superheader.h"
+
+// Fases medidas por `--time-report`.
+enum TimedPhase : uint8_t {
+    TIME_READ,          // Leitura do fonte (driver e `Scanner`).
+    TIME_LEXICAL,       // `Scanner::nextToken`.
+    TIME_SYNTAX,        // `Parser::run`, sem o tempo das fases internas.
+    TIME_SEMANTIC,      // Declarações, buscas e verificações de tipos do parser.
+    TIME_INTERFACE,     // Serialização da interface binária.
+    TIME_PHASES
+};
+
+// A classe `TimeReport` acumula, por fase, o tempo real, o tempo de CPU, o número de
+// entradas na fase e o crescimento do pico de RSS de uma compilação.
+//
+// As fases se aninham (o parser chama o scanner a cada token): cada intervalo é atribuído só
+// à fase mais interna, então a soma das fases é o tempo total. O relógio é o contador de
+// ciclos do processador (x86) calibrado contra o relógio monotônico ao parar o relatório,
+// ou o próprio relógio monotônico nas outras arquiteturas: uma leitura custa poucos
+// nanossegundos, o que permite medir cada token.
+//
+// O tempo de CPU e o pico de RSS exigem uma chamada ao sistema, então são lidos apenas ao
+// entrar e sair das fases externas (leitura, análise, interface). A CPU de uma fase externa
+// é dividida entre as fases que rodaram dentro dela na proporção do tempo real; o RSS é
+// atribuído à fase externa.
+//
+// Com `countEvents` (`--perf-counters`), os contadores de hardware da thread (`PerfCounters`)
+// também são lidos nas fronteiras das fases externas e atribuídos a elas: ler um contador é
+// uma chamada ao sistema, cara demais para cada token.
+//
+// O relatório fica ativo na thread que chamou `start` até `stop`. Sem relatório ativo, um
+// `PhaseTimer` custa a leitura de um ponteiro.
+class TimeReport {
+public:
+    TimeReport();
+
+    void countEvents();                 // Mede também os contadores de hardware (antes de `start`).
+    bool countsEvents();
+    void start();                       // Ativa o relatório nesta thread.
+    void stop();
+    bool enter(TimedPhase phase);       // `false` se já está na fase (nada a fazer em `leave`).
+    void leave();
+    void addBytes(size_t bytes);        // Fonte analisado (para MB/s e tokens/s).
+    void merge(const TimeReport& other); // Soma outro relatório (arquivos de um programa).
+    long rssGrowthKB(TimedPhase phase); // Crescimento do pico de RSS na fase (só fases externas).
+    void print(ostream& out);
+    void printEvents(ostream& out);     // Tabela de `--perf-counters`.
+    string eventsJson();                // O mesmo, em JSON (acompanhamento de regressões).
+
+private:
+    struct Totals {
+        uint64_t ticks;
+        double wallMs;                  // `ticks` convertidos por `stop`.
+        double cpuMs;
+        long rssKB;
+        long calls;
+        bool outer;                     // Já foi uma fase externa (tem RSS medido).
+        uint64_t events[PERF_EVENTS];   // Contadores de hardware (só fases externas).
+    };
+
+    Totals totals[TIME_PHASES];
+    TimedPhase stack[16];
+    int depth;
+    uint64_t last;                      // Instante da última transição.
+    uint64_t outerTicks[TIME_PHASES];   // Ticks das fases ao entrar na fase externa atual.
+    double outerCpu;
+    long outerRss;
+    size_t bytes;
+
+    bool counting;
+    std::unique_ptr<PerfCounters> perf; // Aberto por `start`, na thread medida.
+    uint64_t outerEvents[PERF_EVENTS];
+    bool eventAvailable[PERF_EVENTS];   // Em algum dos relatórios somados.
+    string eventError;                  // Motivo quando nenhum contador abriu.
+
+    uint64_t startTicks;
+    std::chrono::steady_clock::time_point startTime;
+    TimeReport* previous;               // Relatório ativo antes de `start` (restaurado por `stop`).
+
+    void charge(uint64_t now);
+};
+
+extern thread_local TimeReport* activeTimeReport;
+
+// Contador de ciclos do processador (x86) ou relógio monotônico: sem unidade fixa, só para
+// intervalos calibrados contra o relógio monotônico (`TimeReport`, `Trace`).
+uint64_t readTicks();
+
+// Mede o escopo como a fase `phase` quando há um relatório ativo na thread.
+class PhaseTimer {
+public:
+    explicit PhaseTimer(TimedPhase phase) : report(activeTimeReport) {
+        if (report != nullptr && !report->enter(phase))
+            report = nullptr;
+    }
+    ~PhaseTimer() {
+        if (report != nullptr)
+            report->leave();
+    }
+
+private:
+    TimeReport* report;
+
+    PhaseTimer(const PhaseTimer&);
+    PhaseTimer& operator=(const PhaseTimer&);
+};
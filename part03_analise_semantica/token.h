@@ -48,8 +48,9 @@ enum TokenType
     FOR,                   // 38 - for
     NEW,                   // 39 - new
     CONSTRUCTOR,           // 40 - constructor
+    IMPORT,                // 41 - import
 
-    END_OF_FILE            // 41 - End of file
+    END_OF_FILE            // 42 - End of file
 };
 
 class Token 
@@ -129,6 +130,7 @@ class Token
                 "FOR",
                 "NEW",
                 "CONSTRUCTOR",
+                "IMPORT",
                 "END_OF_FILE"
             };
             return typeNames[type];
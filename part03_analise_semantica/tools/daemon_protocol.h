@@ -0,0 +1,89 @@
+// Protocolo entre o cliente (`xppc`) e o daemon (`xppd`) do compilador X++.
+//
+// As mensagens trafegam em um socket Unix local, com inteiros de 32 bits na ordem nativa
+// (cliente e daemon estão sempre na mesma máquina):
+//   requisição  "XPPD" | tipo | nº de strings | strings {tamanho, bytes}...
+//               strings: diretório atual do cliente, argumentos do compilador e, no tipo
+//               REQUEST_SOURCE, o texto do programa por último
+//   resposta    código de saída | tamanho | saída do compilador
+// Uma conexão pode enviar várias requisições em sequência.
+#ifndef DAEMON_PROTOCOL_H
+#define DAEMON_PROTOCOL_H
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+const uint32_t DAEMON_MAGIC = 0x44505058; // "XPPD"
+const uint32_t REQUEST_PATH = 0;          // O daemon lê o arquivo indicado nos argumentos.
+const uint32_t REQUEST_SOURCE = 1;        // O texto do programa segue na requisição.
+const uint32_t DAEMON_MAX_MESSAGE = 256u << 20;
+
+// Caminho do socket: $XPPD_SOCKET ou /tmp/xppd-<uid>.sock.
+inline std::string daemonSocketPath() {
+    const char* env = getenv("XPPD_SOCKET");
+    if (env != nullptr && *env)
+        return env;
+    return "/tmp/xppd-" + std::to_string((unsigned long) getuid()) + ".sock";
+}
+
+inline bool daemonAddress(const std::string& path, sockaddr_un* addr) {
+    if (path.size() >= sizeof(addr->sun_path))
+        return false;
+    memset(addr, 0, sizeof(*addr));
+    addr->sun_family = AF_UNIX;
+    memcpy(addr->sun_path, path.c_str(), path.size() + 1);
+    return true;
+}
+
+inline bool writeAll(int fd, const void* data, size_t size) {
+    const char* p = (const char*) data;
+    while (size > 0) {
+        ssize_t n = write(fd, p, size);
+        if (n <= 0)
+            return false;
+        p += n;
+        size -= (size_t) n;
+    }
+    return true;
+}
+
+inline bool readAll(int fd, void* data, size_t size) {
+    char* p = (char*) data;
+    while (size > 0) {
+        ssize_t n = read(fd, p, size);
+        if (n <= 0)
+            return false;
+        p += n;
+        size -= (size_t) n;
+    }
+    return true;
+}
+
+inline void putU32(std::string& buf, uint32_t v) {
+    buf.append((const char*) &v, 4);
+}
+
+inline void putString(std::string& buf, const std::string& s) {
+    putU32(buf, (uint32_t) s.size());
+    buf += s;
+}
+
+inline bool readU32(int fd, uint32_t* v) {
+    return readAll(fd, v, 4);
+}
+
+inline bool readString(int fd, std::string* s) {
+    uint32_t size;
+    if (!readU32(fd, &size) || size > DAEMON_MAX_MESSAGE)
+        return false;
+    s->resize(size);
+    return size == 0 || readAll(fd, &(*s)[0], size);
+}
+
+#endif // DAEMON_PROTOCOL_H
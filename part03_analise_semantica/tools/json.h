@@ -0,0 +1,254 @@
+// JSON mínimo para o servidor de linguagem (`xpp_lsp`): leitura das mensagens JSON-RPC e
+// escrita das respostas. Os números são guardados também como texto, para devolver o `id`
+// de uma requisição exatamente como veio.
+#ifndef XPP_JSON_H
+#define XPP_JSON_H
+
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+struct JsonValue {
+    enum Kind { NUL, BOOLEAN, NUMBER, STRING, ARRAY, OBJECT };
+
+    Kind kind = NUL;
+    bool boolean = false;
+    std::string text;                                       // STRING, ou o número como escrito.
+    std::vector<JsonValue> items;                           // ARRAY
+    std::vector<std::pair<std::string, JsonValue>> fields;  // OBJECT
+
+    // Campo ou elemento ausente: um valor nulo.
+    const JsonValue& operator[](const char* key) const {
+        static const JsonValue null;
+        for (const auto& f : fields)
+            if (f.first == key)
+                return f.second;
+        return null;
+    }
+    const JsonValue& operator[](size_t i) const {
+        static const JsonValue null;
+        return i < items.size() ? items[i] : null;
+    }
+
+    bool isNull() const { return kind == NUL; }
+    long asInt(long fallback = 0) const { return kind == NUMBER ? strtol(text.c_str(), nullptr, 10) : fallback; }
+    const std::string& asString() const { return text; }
+};
+
+inline std::string jsonQuote(const std::string& s) {
+    static const char* hex = "0123456789abcdef";
+    std::string out = "\"";
+    for (unsigned char c : s) {
+        switch (c) {
+        case '"': out += "\\\""; break;
+        case '\\': out += "\\\\"; break;
+        case '\n': out += "\\n"; break;
+        case '\r': out += "\\r"; break;
+        case '\t': out += "\\t"; break;
+        default:
+            if (c < 0x20) {
+                out += "\\u00";
+                out += hex[c >> 4];
+                out += hex[c & 15];
+            } else {
+                out += (char) c;
+            }
+        }
+    }
+    return out + "\"";
+}
+
+// Texto JSON de um valor (usado para devolver o `id`).
+inline std::string jsonWrite(const JsonValue& v) {
+    switch (v.kind) {
+    case JsonValue::BOOLEAN: return v.boolean ? "true" : "false";
+    case JsonValue::NUMBER: return v.text;
+    case JsonValue::STRING: return jsonQuote(v.text);
+    case JsonValue::ARRAY: {
+        std::string out = "[";
+        for (size_t i = 0; i < v.items.size(); i++)
+            out += (i ? "," : "") + jsonWrite(v.items[i]);
+        return out + "]";
+    }
+    case JsonValue::OBJECT: {
+        std::string out = "{";
+        for (size_t i = 0; i < v.fields.size(); i++)
+            out += (i ? "," : "") + jsonQuote(v.fields[i].first) + ":" + jsonWrite(v.fields[i].second);
+        return out + "}";
+    }
+    default: return "null";
+    }
+}
+
+class JsonReader {
+public:
+    explicit JsonReader(const std::string& s) : s(s), p(0) {}
+
+    bool parse(JsonValue* out) {
+        if (!value(out))
+            return false;
+        space();
+        return p == s.size();
+    }
+
+private:
+    const std::string& s;
+    size_t p;
+
+    void space() {
+        while (p < s.size() && (s[p] == ' ' || s[p] == '\t' || s[p] == '\n' || s[p] == '\r'))
+            p++;
+    }
+
+    bool literal(const char* word) {
+        size_t n = strlen(word);
+        if (s.compare(p, n, word) != 0)
+            return false;
+        p += n;
+        return true;
+    }
+
+    static void utf8(std::string& out, unsigned long c) {
+        if (c < 0x80) {
+            out += (char) c;
+        } else if (c < 0x800) {
+            out += (char) (0xC0 | (c >> 6));
+            out += (char) (0x80 | (c & 0x3F));
+        } else if (c < 0x10000) {
+            out += (char) (0xE0 | (c >> 12));
+            out += (char) (0x80 | ((c >> 6) & 0x3F));
+            out += (char) (0x80 | (c & 0x3F));
+        } else {
+            out += (char) (0xF0 | (c >> 18));
+            out += (char) (0x80 | ((c >> 12) & 0x3F));
+            out += (char) (0x80 | ((c >> 6) & 0x3F));
+            out += (char) (0x80 | (c & 0x3F));
+        }
+    }
+
+    bool hex4(unsigned long* c) {
+        if (p + 4 > s.size())
+            return false;
+        char buf[5] = { s[p], s[p + 1], s[p + 2], s[p + 3], 0 };
+        char* end;
+        *c = strtoul(buf, &end, 16);
+        p += 4;
+        return end == buf + 4;
+    }
+
+    bool string(std::string* out) {
+        if (p >= s.size() || s[p] != '"')
+            return false;
+        p++;
+        while (p < s.size() && s[p] != '"') {
+            if (s[p] != '\\') {
+                *out += s[p++];
+                continue;
+            }
+            if (++p >= s.size())
+                return false;
+            char e = s[p++];
+            switch (e) {
+            case 'n': *out += '\n'; break;
+            case 't': *out += '\t'; break;
+            case 'r': *out += '\r'; break;
+            case 'b': *out += '\b'; break;
+            case 'f': *out += '\f'; break;
+            case 'u': {
+                unsigned long c, low;
+                if (!hex4(&c))
+                    return false;
+                if (c >= 0xD800 && c < 0xDC00 && literal("\\u") && hex4(&low))
+                    c = 0x10000 + ((c - 0xD800) << 10) + (low - 0xDC00);
+                utf8(*out, c);
+                break;
+            }
+            default: *out += e;
+            }
+        }
+        if (p >= s.size())
+            return false;
+        p++;
+        return true;
+    }
+
+    bool value(JsonValue* out) {
+        space();
+        if (p >= s.size())
+            return false;
+        char c = s[p];
+        if (c == '{') {
+            out->kind = JsonValue::OBJECT;
+            p++;
+            space();
+            if (p < s.size() && s[p] == '}') {
+                p++;
+                return true;
+            }
+            while (true) {
+                std::string key;
+                space();
+                if (!string(&key))
+                    return false;
+                space();
+                if (p >= s.size() || s[p++] != ':')
+                    return false;
+                out->fields.emplace_back(key, JsonValue());
+                if (!value(&out->fields.back().second))
+                    return false;
+                space();
+                if (p < s.size() && s[p] == ',') {
+                    p++;
+                    continue;
+                }
+                return p < s.size() && s[p++] == '}';
+            }
+        }
+        if (c == '[') {
+            out->kind = JsonValue::ARRAY;
+            p++;
+            space();
+            if (p < s.size() && s[p] == ']') {
+                p++;
+                return true;
+            }
+            while (true) {
+                out->items.emplace_back();
+                if (!value(&out->items.back()))
+                    return false;
+                space();
+                if (p < s.size() && s[p] == ',') {
+                    p++;
+                    continue;
+                }
+                return p < s.size() && s[p++] == ']';
+            }
+        }
+        if (c == '"') {
+            out->kind = JsonValue::STRING;
+            return string(&out->text);
+        }
+        if (literal("true") || literal("false")) {
+            out->kind = JsonValue::BOOLEAN;
+            out->boolean = s[p - 1] == 'e' && s[p - 2] == 'u'; // "true", e não "false".
+            return true;
+        }
+        if (literal("null")) {
+            out->kind = JsonValue::NUL;
+            return true;
+        }
+        size_t start = p;
+        while (p < s.size() && (isdigit((unsigned char) s[p]) || strchr("+-.eE", s[p]) != nullptr))
+            p++;
+        if (p == start)
+            return false;
+        out->kind = JsonValue::NUMBER;
+        out->text = s.substr(start, p - start);
+        return true;
+    }
+};
+
+#endif // XPP_JSON_H
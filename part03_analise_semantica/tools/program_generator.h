@@ -0,0 +1,332 @@
+// Gerador de programas X++ válidos para medições (`xpp_gen` e os benchmarks em `bench/`). A mesma
+// semente e as mesmas opções geram sempre o mesmo texto, em qualquer plataforma: o sorteio
+// usa um splitmix64 próprio, sem depender da biblioteca padrão.
+//
+// Os programas passam pelas três análises sem erro, respeitando as regras do compilador:
+// - a superclasse é declarada antes da subclasse e nenhum nome se repete na hierarquia
+//   (os nomes levam o número da classe);
+// - o corpo da classe tem campos, construtor e métodos, nessa ordem (o construtor separa os
+//   campos dos métodos, que começam pelo mesmo tipo);
+// - as variáveis locais são declaradas no início do método e os laços usam uma variável de
+//   controle por nível de aninhamento;
+// - uma chamada `o.m(...)` usa um parâmetro `o` de uma classe anterior e um método dela.
+#ifndef XPP_PROGRAM_GENERATOR_H
+#define XPP_PROGRAM_GENERATOR_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Pesos relativos de cada tipo de comando nos corpos dos métodos.
+struct StatementMix {
+    int assign = 40;        // `v = expressao;`, `a = int[n];` e `o = new C();`
+    int call = 15;          // `v = o.m(args);`
+    int print = 10;
+    int read = 5;
+    int branch = 15;        // `if`/`else`
+    int loop = 15;          // `for`, com `break` ocasional
+};
+
+struct GeneratorOptions {
+    uint64_t seed = 1;
+    int classes = 100;              // Ignorado quando há `targetBytes`.
+    size_t targetBytes = 0;         // Gera classes até o fonte atingir este tamanho.
+    int inheritanceDepth = 4;       // Classes na maior cadeia de `extends` (1: sem herança).
+    int fields = 4;                 // Campos por classe.
+    int methods = 4;                // Métodos por classe.
+    int statements = 8;             // Comandos no corpo de cada método.
+    int nesting = 2;                // Profundidade máxima de `if`/`for` aninhados.
+    int commentPercent = 10;        // Chance de um comentário antes de cada comando.
+    int identifierLength = 6;       // Comprimento mínimo dos identificadores.
+    StatementMix mix;
+
+    // Programas de vários arquivos: os nomes começam na classe `firstClass` (faixas disjuntas
+    // não colidem entre arquivos) e as classes sem pai no arquivo estendem `baseClass`, de um
+    // arquivo importado (vazio: nenhuma).
+    int firstClass = 0;
+    std::string baseClass;
+};
+
+class ProgramGenerator {
+public:
+    explicit ProgramGenerator(const GeneratorOptions& options) : options(options), state(options.seed) {}
+
+    std::string generate() {
+        std::string out;
+        generate(out);
+        return out;
+    }
+
+    // Acrescenta o programa a `out`.
+    void generate(std::string& out) {
+        classes.clear();
+        size_t start = out.size();
+        for (int i = 0; options.targetBytes > 0 ? out.size() - start < options.targetBytes : i < options.classes; i++)
+            generateClass(out, i);
+    }
+
+private:
+    struct ClassInfo {
+        std::string name;
+        int depth;                      // Classes na cadeia até a raiz, inclusive.
+        std::vector<std::string> methods;
+        std::vector<int> arity;         // Parâmetros inteiros de cada método.
+    };
+
+    // Nomes visíveis no corpo do método sendo gerado.
+    struct Scope {
+        std::vector<std::string> ints;          // Locais, parâmetros e campos inteiros.
+        std::vector<std::string> arrays;        // `int[]`
+        std::vector<std::string> strings;
+        std::vector<std::string> loops;         // Variáveis de controle, uma por nível.
+        std::string object;                     // Parâmetro de classe (vazio se não há).
+        int objectClass = -1;
+    };
+
+    GeneratorOptions options;
+    uint64_t state;
+    std::vector<ClassInfo> classes;
+
+    uint64_t next() {
+        uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+    int below(int n) { return n > 0 ? (int) (next() % (uint64_t) n) : 0; }
+    bool chance(int percent) { return below(100) < percent; }
+
+    // Prefixo, número da classe, separador, número do membro e enchimento até o comprimento
+    // pedido; o separador e o enchimento são letras, então nomes diferentes nunca coincidem.
+    std::string name(char prefix, int a, int b = -1) {
+        std::string s(1, prefix);
+        s += std::to_string(a);
+        if (b >= 0) {
+            s += 'k';
+            s += std::to_string(b);
+        }
+        if ((int) s.size() < options.identifierLength)
+            s.append(options.identifierLength - s.size(), 'z');
+        return s;
+    }
+
+    template <class T>
+    const T& pick(const std::vector<T>& items) { return items[below((int) items.size())]; }
+
+    static void indent(std::string& out, int level) { out.append(4 * level, ' '); }
+
+    void comment(std::string& out, int level) {
+        if (!chance(options.commentPercent))
+            return;
+        indent(out, level);
+        out += below(4) == 0 ? "/* comentario gerado " + std::to_string(below(1000)) + " */\n"
+                             : "// comentario gerado " + std::to_string(below(1000)) + "\n";
+    }
+
+    void generateClass(std::string& out, int index) {
+        int id = options.firstClass + index;
+        ClassInfo info;
+        info.name = name('C', id);
+        info.depth = 1;
+        int parent = -1;
+        if (options.inheritanceDepth > 1 && index > 0 && chance(70)) {
+            int candidate = index - 1 - below(index < 16 ? index : 16);
+            if (classes[candidate].depth < options.inheritanceDepth)
+                parent = candidate;
+        }
+        if (parent >= 0)
+            info.depth = classes[parent].depth + 1;
+
+        comment(out, 0);
+        std::string parentName = parent >= 0 ? classes[parent].name : options.baseClass;
+        out += "class " + info.name;
+        if (!parentName.empty())
+            out += " extends " + parentName;
+        out += " {\n";
+
+        // Campos: inteiros, arrays e strings, na proporção 2:1:1.
+        Scope fields;
+        for (int f = 0; f < options.fields; f++) {
+            std::string field = name('f', id, f);
+            indent(out, 1);
+            switch (f % 4) {
+            case 1: out += "int[] " + field + ";\n"; fields.arrays.push_back(field); break;
+            case 3: out += "string " + field + ";\n"; fields.strings.push_back(field); break;
+            default: out += "int " + field + ";\n"; fields.ints.push_back(field); break;
+            }
+        }
+
+        indent(out, 1);
+        out += "constructor() {\n";
+        if (!parentName.empty()) {
+            indent(out, 2);
+            out += "super();\n";
+        }
+        for (const std::string& field : fields.ints) {
+            indent(out, 2);
+            out += field + " = " + std::to_string(below(100)) + ";\n";
+        }
+        for (const std::string& field : fields.arrays) {
+            indent(out, 2);
+            out += field + " = int[" + std::to_string(1 + below(64)) + "];\n";
+        }
+        indent(out, 1);
+        out += "}\n";
+
+        for (int m = 0; m < options.methods; m++)
+            generateMethod(out, index, m, info, fields);
+
+        out += "}\n";
+        classes.push_back(info);
+    }
+
+    void generateMethod(std::string& out, int index, int m, ClassInfo& info, const Scope& fields) {
+        Scope scope = fields;
+        std::string method = name('m', options.firstClass + index, m);
+        int arity = below(3);
+
+        comment(out, 1);
+        indent(out, 1);
+        out += "int " + method + "(";
+        for (int p = 0; p < arity; p++) {
+            std::string param = name('p', m, p);
+            out += (p > 0 ? ", int " : "int ") + param;
+            scope.ints.push_back(param);
+        }
+        if (index > 0 && options.mix.call > 0) {
+            scope.objectClass = index - 1 - below(index < 32 ? index : 32);
+            while (classes[scope.objectClass].methods.empty() && scope.objectClass > 0)
+                scope.objectClass--;
+            if (!classes[scope.objectClass].methods.empty()) {
+                scope.object = name('o', m);
+                out += std::string(arity > 0 ? ", " : "") + classes[scope.objectClass].name + " " + scope.object;
+            }
+        }
+        out += ") {\n";
+
+        // Locais: dois inteiros, um array, uma string e uma variável de laço por nível.
+        std::vector<std::string> ints = { name('v', m, 0), name('v', m, 1) };
+        indent(out, 2);
+        out += "int " + ints[0] + ", " + ints[1];
+        for (int level = 0; level < options.nesting; level++) {
+            scope.loops.push_back(name('i', m, level));
+            out += ", " + scope.loops.back();
+        }
+        out += ";\n";
+        scope.ints.insert(scope.ints.end(), ints.begin(), ints.end());
+        scope.arrays.push_back(name('a', m));
+        indent(out, 2);
+        out += "int[] " + scope.arrays.back() + ";\n";
+        scope.strings.push_back(name('s', m));
+        indent(out, 2);
+        out += "string " + scope.strings.back() + ";\n";
+        indent(out, 2);
+        out += scope.arrays.back() + " = int[" + std::to_string(8 + below(56)) + "];\n";
+
+        for (int s = 0; s < options.statements; s++)
+            statement(out, scope, 2, 0, false);
+        indent(out, 2);
+        out += "return " + expression(scope, 2) + ";\n";
+        indent(out, 1);
+        out += "}\n";
+
+        info.methods.push_back(method);
+        info.arity.push_back(arity);
+    }
+
+    void block(std::string& out, const Scope& scope, int level, int nesting, bool inLoop) {
+        int budget = options.statements >> nesting;
+        int count = 1 + below(budget > 1 ? budget : 1);
+        for (int s = 0; s < count; s++)
+            statement(out, scope, level, nesting, inLoop);
+    }
+
+    void statement(std::string& out, const Scope& scope, int level, int nesting, bool inLoop) {
+        const StatementMix& mix = options.mix;
+        bool nest = nesting < options.nesting;
+        int call = scope.object.empty() ? 0 : mix.call;
+        int branch = nest ? mix.branch : 0, loop = nest ? mix.loop : 0;
+        int total = mix.assign + call + mix.print + mix.read + branch + loop;
+        int roll = below(total > 0 ? total : 1);
+
+        comment(out, level);
+        indent(out, level);
+        if ((roll -= mix.assign) < 0 || total == 0) {
+            int kind = below(10);
+            if (kind == 0)
+                out += pick(scope.arrays) + " = int[" + expression(scope, 1) + "];\n";
+            else if (kind == 1 && !scope.object.empty())
+                out += scope.object + " = new " + classes[scope.objectClass].name + "();\n";
+            else if (kind == 2)
+                out += pick(scope.strings) + " = \"texto " + std::to_string(below(1000)) + "\";\n";
+            else if (kind == 3)
+                out += pick(scope.arrays) + "[" + expression(scope, 1) + "] = " + expression(scope, 2) + ";\n";
+            else
+                out += pick(scope.ints) + " = " + expression(scope, 3) + ";\n";
+        } else if ((roll -= call) < 0) {
+            const ClassInfo& target = classes[scope.objectClass];
+            int method = below((int) target.methods.size());
+            out += pick(scope.ints) + " = " + scope.object + "." + target.methods[method] + "(";
+            for (int a = 0; a < target.arity[method]; a++)
+                out += (a > 0 ? ", " : "") + expression(scope, 1);
+            out += ");\n";
+        } else if ((roll -= mix.print) < 0) {
+            out += "print " + (chance(20) ? pick(scope.strings) : expression(scope, 2)) + ";\n";
+        } else if ((roll -= mix.read) < 0) {
+            out += "read " + pick(scope.ints) + ";\n";
+        } else if ((roll -= branch) < 0) {
+            out += "if (" + condition(scope) + ") {\n";
+            block(out, scope, level + 1, nesting + 1, inLoop);
+            if (inLoop && chance(20)) {
+                indent(out, level + 1);
+                out += "break;\n";
+            }
+            indent(out, level);
+            out += "}";
+            if (chance(40)) {
+                out += " else {\n";
+                block(out, scope, level + 1, nesting + 1, inLoop);
+                indent(out, level);
+                out += "}";
+            }
+            out += "\n";
+        } else {
+            const std::string& i = scope.loops[nesting];
+            out += "for (" + i + " = 0; " + i + " < " + std::to_string(1 + below(100)) + "; " + i + " = " + i + " + 1) {\n";
+            block(out, scope, level + 1, nesting + 1, true);
+            indent(out, level);
+            out += "}\n";
+        }
+    }
+
+    std::string condition(const Scope& scope) {
+        static const char* const RELATIONS[] = { "<", "<=", ">", ">=", "==", "!=" };
+        return expression(scope, 1) + " " + RELATIONS[below(6)] + " " + expression(scope, 1);
+    }
+
+    // Expressão aritmética com até `terms` termos (literais, variáveis, elementos de array e
+    // subexpressões entre parênteses).
+    std::string expression(const Scope& scope, int terms) {
+        static const char* const OPERATORS[] = { " + ", " - ", " * ", " / ", " % " };
+        std::string s;
+        int count = 1 + below(terms);
+        for (int t = 0; t < count; t++) {
+            if (t > 0)
+                s += OPERATORS[below(5)];
+            int kind = below(10);
+            if (kind < 4)
+                s += pick(scope.ints);
+            else if (kind < 7)
+                s += std::to_string(below(1000));
+            else if (kind < 8)
+                s += pick(scope.arrays) + "[" + pick(scope.ints) + "]";
+            else if (kind < 9 && terms > 1)
+                s += "(" + expression(scope, terms - 1) + ")";
+            else
+                s += "-" + std::to_string(1 + below(9));
+        }
+        return s;
+    }
+};
+
+#endif
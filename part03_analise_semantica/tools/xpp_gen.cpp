@@ -0,0 +1,95 @@
+// Gera um programa X++ válido e determinístico (ver `program_generator.h`) para medições.
+//
+// Compilacao (a partir de part03_analise_semantica/):
+//   g++ -O2 -o xpp_gen tools/xpp_gen.cpp
+//
+// Uso:
+//   ./xpp_gen [opcoes] [-o saida.xpp]
+//     --seed N            semente (1)
+//     --classes N         classes (100), ou
+//     --size N[K|M|G]     classes até o fonte atingir o tamanho
+//     --depth N           classes na maior cadeia de heranca (4)
+//     --fields N          campos por classe (4)
+//     --methods N         metodos por classe (4)
+//     --statements N      comandos por metodo (8)
+//     --nesting N         profundidade de if/for aninhados (2)
+//     --comments P        porcentagem de comandos com comentario (10)
+//     --ident-length N    comprimento minimo dos identificadores (6)
+//     --mix A,C,P,R,I,F   pesos de atribuicao, chamada, print, read, if e for (40,15,10,5,15,15)
+#include "program_generator.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+static bool parseSize(const char* text, size_t* bytes) {
+    char* end;
+    double value = strtod(text, &end);
+    double unit = *end == 'K' || *end == 'k' ? 1024.0 : *end == 'M' || *end == 'm' ? 1024.0 * 1024
+                : *end == 'G' || *end == 'g' ? 1024.0 * 1024 * 1024 : 1;
+    if (end == text || value <= 0 || (unit > 1 && end[1] != '\0') || (unit == 1 && *end != '\0'))
+        return false;
+    *bytes = (size_t) (value * unit);
+    return true;
+}
+
+static bool parseMix(const char* text, StatementMix* mix) {
+    int* weights[] = { &mix->assign, &mix->call, &mix->print, &mix->read, &mix->branch, &mix->loop };
+    for (int i = 0; i < 6; i++) {
+        char* end;
+        long value = strtol(text, &end, 10);
+        if (end == text || value < 0 || *end != (i < 5 ? ',' : '\0'))
+            return false;
+        *weights[i] = (int) value;
+        text = end + 1;
+    }
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    GeneratorOptions options;
+    const char* output = nullptr;
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+        int* knob = strcmp(arg, "--classes") == 0 ? &options.classes
+                  : strcmp(arg, "--depth") == 0 ? &options.inheritanceDepth
+                  : strcmp(arg, "--fields") == 0 ? &options.fields
+                  : strcmp(arg, "--methods") == 0 ? &options.methods
+                  : strcmp(arg, "--statements") == 0 ? &options.statements
+                  : strcmp(arg, "--nesting") == 0 ? &options.nesting
+                  : strcmp(arg, "--comments") == 0 ? &options.commentPercent
+                  : strcmp(arg, "--ident-length") == 0 ? &options.identifierLength : nullptr;
+        bool ok = value != nullptr;
+        if (knob != nullptr && ok) {
+            char* end;
+            long n = strtol(value, &end, 10);
+            ok = end != value && *end == '\0' && n >= 0 && n <= 1000000;
+            *knob = (int) n;
+        } else if (strcmp(arg, "--seed") == 0 && ok) {
+            options.seed = strtoull(value, nullptr, 10);
+        } else if (strcmp(arg, "--size") == 0 && ok) {
+            ok = parseSize(value, &options.targetBytes);
+        } else if (strcmp(arg, "--mix") == 0 && ok) {
+            ok = parseMix(value, &options.mix);
+        } else if (strcmp(arg, "-o") == 0 && ok) {
+            output = value;
+        } else {
+            ok = false;
+        }
+        if (!ok) {
+            fprintf(stderr, "Opcao invalida: %s (veja o comentario no inicio de tools/xpp_gen.cpp)\n", arg);
+            return 2;
+        }
+        i++;
+    }
+
+    std::string program = ProgramGenerator(options).generate();
+    FILE* f = output != nullptr ? fopen(output, "wb") : stdout;
+    if (f == nullptr || fwrite(program.data(), 1, program.size(), f) != program.size()) {
+        fprintf(stderr, "Nao foi possivel gravar %s\n", output != nullptr ? output : "a saida");
+        return 1;
+    }
+    if (f != stdout)
+        fclose(f);
+    return 0;
+}
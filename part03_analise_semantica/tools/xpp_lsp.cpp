@@ -0,0 +1,339 @@
+// Servidor de linguagem (LSP) do X++ sobre stdin/stdout: diagnósticos, ir para a definição
+// e hover. Cada documento aberto é um `DocumentAnalysis`, que reanalisa apenas as classes
+// afetadas por uma edição (sincronização incremental do texto).
+//
+// As mensagens são lidas por uma thread própria e tratadas em lotes pela thread principal:
+// todas as edições que chegaram juntas são aplicadas antes de uma única análise, e os
+// diagnósticos são publicados antes das respostas. Requisições canceladas
+// (`$/cancelRequest`) são respondidas com RequestCancelled sem serem executadas, e as que
+// se referem a uma versão do documento já substituída por uma edição posterior do mesmo
+// lote, com ContentModified.
+//
+// As posições do protocolo (linha e caractere a partir de 0) são tratadas como bytes: o
+// fonte X++ é ASCII.
+//
+// Compilacao (a partir de part03_analise_semantica/):
+//   g++ -O2 -pthread -o xpp_lsp tools/xpp_lsp.cpp $(ls *.cpp | grep -v principal.cpp)
+//
+// Uso: configurar o editor para executar ./xpp_lsp como servidor da linguagem X++.
+#include "../superheader.h"
+#include "json.h"
+#include <cstdio>
+#include <set>
+#include <strings.h>
+
+const int REQUEST_CANCELLED = -32800;
+const int CONTENT_MODIFIED = -32801;
+const int METHOD_NOT_FOUND = -32601;
+
+static SymbolTable* prelude;
+
+struct Document {
+    std::unique_ptr<DocumentAnalysis> analysis;
+    long version;
+    unsigned long changes;    // Edições aplicadas (identifica versões substituídas).
+    bool dirty;               // Há edições ainda não analisadas.
+};
+static std::map<string, Document> documents;
+
+// Mensagens recebidas, na ordem de chegada. Os cancelamentos não entram na fila: são
+// registrados assim que lidos, para valer também para requisições já enfileiradas. Só
+// valem para requisições ainda sem resposta; um cancelamento que chega depois da resposta é
+// descartado, então os conjuntos não crescem com a sessão.
+class Inbox {
+public:
+    Inbox() : closed(false) {}
+
+    void push(JsonValue&& message) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!message["id"].isNull())
+            pending.insert(jsonWrite(message["id"]));
+        queue.push_back(std::move(message));
+        ready.notify_one();
+    }
+
+    void cancel(const string& id) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (pending.count(id))
+            cancelled.insert(id);
+    }
+
+    // Chamada antes de responder a requisição `id`: `true` se ela foi cancelada.
+    bool finish(const string& id) {
+        std::lock_guard<std::mutex> lock(mutex);
+        pending.erase(id);
+        return cancelled.erase(id) > 0;
+    }
+
+    void close() {
+        std::lock_guard<std::mutex> lock(mutex);
+        closed = true;
+        ready.notify_one();
+    }
+
+    // Espera ao menos uma mensagem e retira todas as que estão na fila; `false` no fim da entrada.
+    bool takeAll(std::vector<JsonValue>* out) {
+        std::unique_lock<std::mutex> lock(mutex);
+        ready.wait(lock, [this] { return closed || !queue.empty(); });
+        out->clear();
+        while (!queue.empty()) {
+            out->push_back(std::move(queue.front()));
+            queue.pop_front();
+        }
+        return !out->empty();
+    }
+
+private:
+    std::mutex mutex;
+    std::condition_variable ready;
+    std::deque<JsonValue> queue;
+    std::set<string> pending;       // Requisições recebidas e ainda não respondidas.
+    std::set<string> cancelled;
+    bool closed;
+};
+
+static Inbox inbox;
+
+// Enquadramento do protocolo: cabeçalhos "Content-Length: N", linha vazia e N bytes de JSON.
+static bool readMessage(string* body) {
+    char line[1024];
+    size_t length = 0;
+    bool header = false;
+    while (fgets(line, sizeof(line), stdin) != nullptr) {
+        if (strcmp(line, "\r\n") == 0 || strcmp(line, "\n") == 0) {
+            if (header)
+                break;
+            continue;
+        }
+        if (strncasecmp(line, "Content-Length:", 15) == 0) {
+            length = strtoul(line + 15, nullptr, 10);
+            header = true;
+        }
+    }
+    if (!header)
+        return false;
+    body->resize(length);
+    return length == 0 || fread(&(*body)[0], 1, length, stdin) == length;
+}
+
+static void readLoop() {
+    string body;
+    while (readMessage(&body)) {
+        JsonValue message;
+        if (!JsonReader(body).parse(&message))
+            continue;
+        if (message["method"].asString() == "$/cancelRequest")
+            inbox.cancel(jsonWrite(message["params"]["id"]));
+        else
+            inbox.push(std::move(message));
+    }
+    inbox.close();
+}
+
+static void send(const string& json) {
+    fprintf(stdout, "Content-Length: %zu\r\n\r\n", json.size());
+    fwrite(json.data(), 1, json.size(), stdout);
+    fflush(stdout);
+}
+
+static void reply(const JsonValue& id, const string& result) {
+    send("{\"jsonrpc\":\"2.0\",\"id\":" + jsonWrite(id) + ",\"result\":" + result + "}");
+}
+
+static void replyError(const JsonValue& id, int code, const string& message) {
+    send("{\"jsonrpc\":\"2.0\",\"id\":" + jsonWrite(id) + ",\"error\":{\"code\":" + to_string(code) +
+         ",\"message\":" + jsonQuote(message) + "}}");
+}
+
+// file:///a%20b/x.xpp -> /a b/x.xpp
+static string uriToPath(const string& uri) {
+    string path = uri.compare(0, 7, "file://") == 0 ? uri.substr(7) : uri;
+    string decoded;
+    for (size_t i = 0; i < path.size(); i++) {
+        if (path[i] == '%' && i + 2 < path.size()) {
+            decoded += (char) strtol(path.substr(i + 1, 2).c_str(), nullptr, 16);
+            i += 2;
+        } else {
+            decoded += path[i];
+        }
+    }
+    return decoded;
+}
+
+static string position(int line, int column) {
+    return "{\"line\":" + to_string(line - 1) + ",\"character\":" + to_string(column - 1) + "}";
+}
+
+static string range(int line, int column, int length) {
+    return "{\"start\":" + position(line, column) + ",\"end\":" + position(line, column + length) + "}";
+}
+
+// Os diagnósticos marcam a linha inteira: as mensagens do compilador só têm a linha.
+static void publishDiagnostics(const string& uri, Document& doc) {
+    string items;
+    DocumentAnalysis& analysis = *doc.analysis;
+    for (const DocumentDiagnostic& d : analysis.diagnostics()) {
+        size_t start = analysis.offsetOf(d.line, 1);
+        size_t end = analysis.text().find('\n', start);
+        int length = (int) ((end == string::npos ? analysis.text().size() : end) - start);
+        items += (items.empty() ? "" : ",");
+        items += "{\"range\":" + range(d.line, 1, length) + ",\"severity\":1,\"source\":\"xpp\",\"code\":" +
+                 jsonQuote(d.phase) + ",\"message\":" + jsonQuote(d.message) + "}";
+    }
+    send("{\"jsonrpc\":\"2.0\",\"method\":\"textDocument/publishDiagnostics\",\"params\":{\"uri\":" +
+         jsonQuote(uri) + ",\"version\":" + to_string(doc.version) + ",\"diagnostics\":[" + items + "]}}");
+}
+
+static string describe(const Occurrence& o) {
+    switch (o.kind) {
+    case CLASS_NAME:
+        return "class " + o.name + (o.type.empty() ? "" : " extends " + o.type);
+    case METHOD:
+        return o.type + " " + o.owner + "." + o.name + "()";
+    case PARAMETER:
+        return o.type + " " + o.name + " (parametro)";
+    default:
+        return o.field ? o.type + " " + o.owner + "." + o.name + " (campo)"
+                       : o.type + " " + o.name + " (variavel local)";
+    }
+}
+
+static void applyChanges(Document& doc, const JsonValue& changes) {
+    DocumentAnalysis& analysis = *doc.analysis;
+    for (const JsonValue& change : changes.items) {
+        const JsonValue& r = change["range"];
+        if (r.isNull()) {
+            analysis.setText(change["text"].asString());
+            continue;
+        }
+        size_t start = analysis.offsetOf(r["start"]["line"].asInt() + 1, r["start"]["character"].asInt() + 1);
+        size_t end = analysis.offsetOf(r["end"]["line"].asInt() + 1, r["end"]["character"].asInt() + 1);
+        analysis.replace(start, end > start ? end - start : 0, change["text"].asString());
+    }
+}
+
+static void handleNotification(const string& method, const JsonValue& params) {
+    const string& uri = params["textDocument"]["uri"].asString();
+    if (method == "textDocument/didOpen") {
+        Document& doc = documents[uri];
+        doc.analysis.reset(new DocumentAnalysis(prelude));
+        doc.analysis->setPath(uriToPath(uri));
+        doc.analysis->setText(params["textDocument"]["text"].asString());
+        doc.version = params["textDocument"]["version"].asInt();
+        doc.changes = 0;
+        doc.dirty = true;
+    } else if (method == "textDocument/didChange") {
+        auto found = documents.find(uri);
+        if (found == documents.end())
+            return;
+        applyChanges(found->second, params["contentChanges"]);
+        found->second.version = params["textDocument"]["version"].asInt();
+        found->second.changes++;
+        found->second.dirty = true;
+    } else if (method == "textDocument/didClose") {
+        documents.erase(uri);
+        send("{\"jsonrpc\":\"2.0\",\"method\":\"textDocument/publishDiagnostics\",\"params\":{\"uri\":" +
+             jsonQuote(uri) + ",\"diagnostics\":[]}}");
+    }
+}
+
+static string handleRequest(const string& method, const JsonValue& params, bool* shutdown) {
+    if (method == "initialize") {
+        return "{\"capabilities\":{\"textDocumentSync\":{\"openClose\":true,\"change\":2},"
+               "\"definitionProvider\":true,\"hoverProvider\":true},"
+               "\"serverInfo\":{\"name\":\"xpp_lsp\",\"version\":" + jsonQuote(COMPILER_VERSION) + "}}";
+    }
+    if (method == "shutdown") {
+        *shutdown = true;
+        return "null";
+    }
+
+    const string& uri = params["textDocument"]["uri"].asString();
+    auto found = documents.find(uri);
+    if (found == documents.end())
+        return "null";
+    DocumentAnalysis& analysis = *found->second.analysis;
+    int line = (int) params["position"]["line"].asInt() + 1;
+    int column = (int) params["position"]["character"].asInt() + 1;
+
+    Occurrence o;
+    if (!analysis.occurrenceAt(line, column, &o))
+        return "null";
+    int declLine, declColumn;
+    bool declared = analysis.definitionOf(o, &declLine, &declColumn);
+
+    if (method == "textDocument/definition") {
+        if (!declared)
+            return "null";
+        return "{\"uri\":" + jsonQuote(uri) + ",\"range\":" + range(declLine, declColumn, (int) o.name.size()) + "}";
+    }
+    // Hover: a descrição vem da declaração, que tem o tipo completo.
+    int start = o.column;
+    Occurrence d;
+    if (declared && analysis.occurrenceAt(declLine, declColumn, &d) && d.declaration)
+        o = d;
+    return "{\"contents\":{\"kind\":\"plaintext\",\"value\":" + jsonQuote(describe(o)) + "},\"range\":" +
+           range(line, start, (int) o.name.size()) + "}";
+}
+
+int main() {
+    std::ios::sync_with_stdio(false);
+    prelude = Compilation::createPrelude();
+    std::thread reader(readLoop);
+    reader.detach();
+
+    bool shutdown = false;
+    bool exiting = false;
+    std::vector<JsonValue> batch;
+    while (!exiting && inbox.takeAll(&batch)) {
+        // 1. Notificações na ordem de chegada; cada requisição guarda a versão que viu. O
+        // `exit` encerra o lote (o que vem depois dele é ignorado), mas só depois que as
+        // requisições anteriores, inclusive um `shutdown`, forem respondidas.
+        struct Pending {
+            const JsonValue* message;
+            unsigned long changes;
+        };
+        std::vector<Pending> requests;
+        for (const JsonValue& m : batch) {
+            const string& method = m["method"].asString();
+            if (m["id"].isNull()) {
+                if (method == "exit") {
+                    exiting = true;
+                    break;
+                }
+                handleNotification(method, m["params"]);
+                continue;
+            }
+            auto doc = documents.find(m["params"]["textDocument"]["uri"].asString());
+            requests.push_back({ &m, doc != documents.end() ? doc->second.changes : 0 });
+        }
+
+        // 2. Uma análise por documento alterado, por mais edições que o lote tenha.
+        for (auto& entry : documents) {
+            if (entry.second.dirty) {
+                entry.second.analysis->analyze();
+                entry.second.dirty = false;
+                publishDiagnostics(entry.first, entry.second);
+            }
+        }
+
+        // 3. Respostas.
+        for (const Pending& p : requests) {
+            const JsonValue& id = (*p.message)["id"];
+            const string& method = (*p.message)["method"].asString();
+            const JsonValue& params = (*p.message)["params"];
+            auto doc = documents.find(params["textDocument"]["uri"].asString());
+            if (inbox.finish(jsonWrite(id))) {
+                replyError(id, REQUEST_CANCELLED, "Requisicao cancelada");
+            } else if (doc != documents.end() && doc->second.changes != p.changes) {
+                replyError(id, CONTENT_MODIFIED, "Documento alterado depois da requisicao");
+            } else if (method == "initialize" || method == "shutdown" || method == "textDocument/hover" ||
+                       method == "textDocument/definition") {
+                reply(id, handleRequest(method, params, &shutdown));
+            } else {
+                replyError(id, METHOD_NOT_FOUND, "Metodo nao suportado: " + method);
+            }
+        }
+    }
+    return shutdown ? 0 : 1;
+}
@@ -0,0 +1,57 @@
+// Consulta ao índice de referências gravado por `xpp_compiler --emit-xref indice.xpx`. O
+// índice é mapeado em memória e cada consulta é uma busca binária, sem carregar o arquivo.
+//
+// Compilacao (a partir de part03_analise_semantica/):
+//   g++ -O2 -o xpp_xref tools/xpp_xref.cpp $(ls *.cpp | grep -v principal.cpp)
+//
+// Uso:
+//   ./xpp_xref indice.xpx refs SIMBOLO         declarações e usos (`C`, `C.m` ou `C.x@12:9`)
+//   ./xpp_xref indice.xpx subclasses CLASSE    classes que estendem CLASSE (toda a descendência)
+//   ./xpp_xref indice.xpx files                arquivos indexados
+#include "../superheader.h"
+#include <cstdio>
+
+static const char* kindName(SymbolKind kind, bool field) {
+    switch (kind) {
+    case CLASS_NAME: return "classe";
+    case METHOD: return "metodo";
+    case PARAMETER: return "parametro";
+    default: return field ? "campo" : "local";
+    }
+}
+
+int main(int argc, char* argv[]) {
+    string command = argc > 2 ? argv[2] : "";
+    if (argc < 3 || ((command == "refs" || command == "subclasses") && argc != 4) ||
+        (command != "refs" && command != "subclasses" && command != "files")) {
+        fprintf(stderr, "Uso: %s indice.xpx refs SIMBOLO | subclasses CLASSE | files\n", argv[0]);
+        return 2;
+    }
+
+    XrefIndex index;
+    if (!index.open(argv[1])) {
+        fprintf(stderr, "Indice invalido ou inexistente: %s\n", argv[1]);
+        return 2;
+    }
+
+    if (command == "files") {
+        for (size_t i = 0; i < index.fileCount(); i++)
+            printf("%s\n", index.fileAt(i).c_str());
+        return 0;
+    }
+
+    if (command == "refs") {
+        std::vector<XrefReference> refs;
+        index.references(argv[3], &refs);
+        for (const XrefReference& r : refs)
+            printf("%s:%d:%d: %s %s\n", r.file.c_str(), r.line, r.column,
+                   r.declaration ? "declaracao" : "uso", kindName(r.kind, r.field));
+        return refs.empty() ? 1 : 0;
+    }
+
+    std::vector<XrefSubclass> subs;
+    index.subclasses(argv[3], &subs, true);
+    for (const XrefSubclass& s : subs)
+        printf("%s:%d: %s extends %s\n", s.file.c_str(), s.line, s.name.c_str(), s.parent.c_str());
+    return subs.empty() ? 1 : 0;
+}
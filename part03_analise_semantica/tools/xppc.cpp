@@ -0,0 +1,61 @@
+// Cliente do daemon do compilador X++: substitui `xpp_compiler` na linha de comando
+// (mesmos argumentos, mesma saída, mesmo código de saída), repassando a compilação ao
+// `xppd`. O argumento "-" no lugar do arquivo envia o programa lido da entrada padrão.
+//
+// Se o daemon não estiver em execução, executa o compilador local: $XPP_COMPILER ou
+// `xpp_compiler` no PATH, que também aceita "-" e lê a mesma entrada padrão.
+//
+// Compilacao (a partir de part03_analise_semantica/):
+//   g++ -O2 -o xppc tools/xppc.cpp
+#include "daemon_protocol.h"
+#include <climits>
+#include <cstdio>
+#include <iostream>
+#include <iterator>
+
+static int runLocal(char* argv[]) {
+    const char* compiler = getenv("XPP_COMPILER");
+    if (compiler == nullptr || !*compiler)
+        compiler = "xpp_compiler";
+    argv[0] = (char*) compiler;
+    execvp(compiler, argv);
+    fprintf(stderr, "xppc: daemon indisponivel e nao foi possivel executar %s\n", compiler);
+    return 1;
+}
+
+int main(int argc, char* argv[]) {
+    sockaddr_un addr;
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0 || !daemonAddress(daemonSocketPath(), &addr) || connect(fd, (sockaddr*) &addr, sizeof(addr)) != 0)
+        return runLocal(argv);
+
+    char cwd[PATH_MAX];
+    if (getcwd(cwd, sizeof(cwd)) == nullptr)
+        cwd[0] = '\0';
+
+    bool fromStdin = false;
+    for (int i = 1; i < argc; i++)
+        if (std::string(argv[i]) == "-")
+            fromStdin = true;
+
+    std::string request;
+    putU32(request, DAEMON_MAGIC);
+    putU32(request, fromStdin ? REQUEST_SOURCE : REQUEST_PATH);
+    putU32(request, (uint32_t) argc + (fromStdin ? 1 : 0)); // diretório + argumentos [+ texto]
+    putString(request, cwd);
+    for (int i = 1; i < argc; i++)
+        putString(request, argv[i]);
+    if (fromStdin)
+        putString(request, std::string(std::istreambuf_iterator<char>(std::cin), std::istreambuf_iterator<char>()));
+
+    uint32_t status;
+    std::string output;
+    if (!writeAll(fd, request.data(), request.size()) || !readU32(fd, &status) || !readString(fd, &output)) {
+        fprintf(stderr, "xppc: conexao com o daemon interrompida\n");
+        return 1;
+    }
+    close(fd);
+
+    fwrite(output.data(), 1, output.size(), stdout);
+    return (int) status;
+}
@@ -0,0 +1,265 @@
+// Daemon do compilador X++: mantém o compilador residente e atende requisições de vários
+// clientes (`xppc`) em paralelo por um socket Unix.
+//
+// Estado mantido entre requisições:
+// - o prelúdio (palavras reservadas e seus nomes internalizados), congelado e compartilhado
+//   por todas as compilações sem locks;
+// - as interfaces binárias (.xpi) já mapeadas, reabertas apenas quando o arquivo muda.
+// As conexões são atendidas por um `ThreadPool` de tamanho fixo (`-j`; padrão: uma thread
+// por núcleo); as que chegam com todas as threads ocupadas esperam na fila do pool. Cada
+// compilação escreve em um buffer próprio, devolvido ao cliente junto com o código de saída.
+//
+// SIGINT e SIGTERM encerram o daemon: ele para de aceitar conexões, interrompe a leitura
+// das conexões abertas (a requisição em andamento ainda é respondida) e junta as threads.
+//
+// Compilacao (a partir de part03_analise_semantica/):
+//   g++ -O2 -pthread -o xppd tools/xppd.cpp $(ls *.cpp | grep -v principal.cpp)
+//
+// Uso: ./xppd [--socket caminho] [-j threads]
+#include "../superheader.h"
+
+#ifndef _WIN32
+
+#include "daemon_protocol.h"
+#include <csignal>
+#include <set>
+#include <sstream>
+#include <thread>
+#include <sys/stat.h>
+
+static SymbolTable* prelude;
+static string socketPath;
+static int server = -1;
+static volatile sig_atomic_t stopRequested = 0;
+
+// Cache de interfaces por caminho. Uma interface substituída continua válida para as
+// compilações que ainda a usam (posse compartilhada).
+class ModuleCache {
+public:
+    std::shared_ptr<ModuleInterface> open(const string& path) {
+        struct stat st;
+        if (stat(path.c_str(), &st) != 0)
+            return nullptr;
+
+        std::lock_guard<std::mutex> lock(mutex);
+        Cached& c = modules[path];
+        if (c.module != nullptr && c.mtime == st.st_mtime && c.size == st.st_size)
+            return c.module;
+
+        std::shared_ptr<ModuleInterface> module = std::make_shared<ModuleInterface>();
+        if (!module->open(path)) {
+            modules.erase(path);
+            return nullptr;
+        }
+        c.module = module;
+        c.mtime = st.st_mtime;
+        c.size = st.st_size;
+        return module;
+    }
+
+private:
+    struct Cached {
+        std::shared_ptr<ModuleInterface> module;
+        time_t mtime;
+        off_t size;
+    };
+    std::mutex mutex;
+    std::map<string, Cached> modules;
+};
+
+static ModuleCache moduleCache;
+
+// Conexões em atendimento. No encerramento, a leitura de cada uma é fechada: a espera pela
+// próxima requisição retorna como se o cliente tivesse desconectado.
+class Connections {
+public:
+    bool add(int fd) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (closing)
+            return false;
+        fds.insert(fd);
+        return true;
+    }
+
+    void remove(int fd) {
+        std::lock_guard<std::mutex> lock(mutex);
+        fds.erase(fd);
+    }
+
+    void closeAll() {
+        std::lock_guard<std::mutex> lock(mutex);
+        closing = true;
+        for (int fd : fds)
+            ::shutdown(fd, SHUT_RD);
+    }
+
+private:
+    std::mutex mutex;
+    std::set<int> fds;
+    bool closing = false;
+};
+
+static Connections connections;
+
+// Caminhos relativos são resolvidos a partir do diretório do cliente.
+static string resolve(const string& cwd, const string& path) {
+    if (path.empty() || path[0] == '/')
+        return path;
+    return cwd + "/" + path;
+}
+
+static int compile(const std::vector<string>& args, const string& cwd, const string* source, ostream& out) {
+    CompilerOptions options;
+    if (!parseOptions(args, &options)) {
+        printUsage(out);
+        return 1;
+    }
+
+    options.fileName = resolve(cwd, options.fileName);
+    options.interfaceOut = resolve(cwd, options.interfaceOut);
+    options.xrefOut = resolve(cwd, options.xrefOut);
+    options.traceOut = resolve(cwd, options.traceOut);
+    options.perfJson = resolve(cwd, options.perfJson);
+    options.incrementalState = resolve(cwd, options.incrementalState);
+    for (string& path : options.imports)
+        path = resolve(cwd, path);
+    if (source != nullptr) {
+        options.hasSource = true;
+        options.source = *source;
+    }
+
+    return runCompiler(options, out, prelude,
+                       [](const string& path) { return moduleCache.open(path); });
+}
+
+// Atende as requisições de uma conexão até o cliente fechá-la (ou o daemon encerrar).
+static void serve(int fd) {
+    if (!connections.add(fd)) {
+        close(fd);
+        return;
+    }
+    for (;;) {
+        uint32_t magic, kind, count;
+        if (!readU32(fd, &magic) || magic != DAEMON_MAGIC || !readU32(fd, &kind) || !readU32(fd, &count) ||
+            count < 1 || count > 4096 || (kind == REQUEST_SOURCE && count < 2))
+            break;
+
+        std::vector<string> strings(count);
+        bool ok = true;
+        for (uint32_t i = 0; i < count && ok; i++)
+            ok = readString(fd, &strings[i]);
+        if (!ok)
+            break;
+
+        string cwd = strings[0];
+        const string* source = nullptr;
+        size_t argsEnd = count;
+        if (kind == REQUEST_SOURCE) {
+            source = &strings[count - 1];
+            argsEnd--;
+        }
+        std::vector<string> args(strings.begin() + 1, strings.begin() + argsEnd);
+
+        std::ostringstream out;
+        int status = compile(args, cwd, source, out);
+
+        string reply;
+        putU32(reply, (uint32_t) status);
+        putString(reply, out.str());
+        if (!writeAll(fd, reply.data(), reply.size()))
+            break;
+    }
+    connections.remove(fd);
+    close(fd);
+}
+
+// Só funções seguras em tratadores de sinal: fechar o socket faz o `accept` pendente (ou o
+// próximo) falhar, e o laço principal vê `stopRequested`.
+static void requestStop(int) {
+    stopRequested = 1;
+    ::shutdown(server, SHUT_RDWR);
+}
+
+int main(int argc, char* argv[]) {
+    socketPath = daemonSocketPath();
+    size_t threads = 0;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--socket" && i + 1 < argc) {
+            socketPath = argv[++i];
+        } else if (arg == "-j" && i + 1 < argc) {
+            threads = strtoul(argv[++i], nullptr, 10);
+        } else {
+            cout << "Uso: ./xppd [--socket caminho] [-j threads]\n";
+            return 1;
+        }
+    }
+
+    sockaddr_un addr;
+    if (!daemonAddress(socketPath, &addr)) {
+        cout << "Caminho de socket muito longo: " << socketPath << "\n";
+        return 1;
+    }
+
+    server = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (server < 0) {
+        perror("socket");
+        return 1;
+    }
+
+    // Um socket que sobrou de uma execução anterior é removido; um daemon ativo não.
+    int probe = socket(AF_UNIX, SOCK_STREAM, 0);
+    bool running = connect(probe, (sockaddr*) &addr, sizeof(addr)) == 0;
+    close(probe);
+    if (running) {
+        cout << "Ja existe um daemon em " << socketPath << "\n";
+        return 1;
+    }
+    unlink(socketPath.c_str());
+
+    if (bind(server, (sockaddr*) &addr, sizeof(addr)) != 0 || listen(server, 128) != 0) {
+        perror("bind/listen");
+        return 1;
+    }
+
+    signal(SIGPIPE, SIG_IGN);
+    struct sigaction stop = {};
+    stop.sa_handler = requestStop;
+    sigaction(SIGINT, &stop, nullptr);
+    sigaction(SIGTERM, &stop, nullptr);
+
+    // As threads do pool herdam a máscara com os sinais bloqueados: SIGINT e SIGTERM são
+    // sempre entregues à thread principal, que está no `accept`.
+    sigset_t signals, previous;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &signals, &previous);
+    prelude = Compilation::createPrelude();
+    std::unique_ptr<ThreadPool> pool(new ThreadPool(threads));
+    pthread_sigmask(SIG_SETMASK, &previous, nullptr);
+    cout << "xppd escutando em " << socketPath << " com " << pool->size() << " threads" << endl;
+
+    while (!stopRequested) {
+        int client = accept(server, nullptr, nullptr);
+        if (client < 0)
+            continue;
+        pool->submit([client] { serve(client); });
+    }
+
+    unlink(socketPath.c_str());
+    close(server);
+    connections.closeAll();
+    pool.reset(); // Espera as conexões em andamento e junta as threads.
+    delete prelude;
+    return 0;
+}
+
+#else
+
+int main() {
+    cout << "O daemon xppd requer sockets Unix e nao esta disponivel no Windows.\n";
+    return 1;
+}
+
+#endif
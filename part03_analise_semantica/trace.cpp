@@ -0,0 +1,132 @@
+#include "superheader.h"
+#include <charconv>
+#include <cstdio>
+
+#ifdef __linux__
+#include <sys/syscall.h>
+#endif
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+thread_local Trace* activeTrace = nullptr;
+
+// Último buffer usado por esta thread e o trace a que ele pertence.
+struct TraceCache {
+    uint64_t trace;
+    TraceBuffer* buffer;
+};
+static thread_local TraceCache traceCache = { 0, nullptr };
+static std::atomic<uint64_t> nextTraceId(1);
+
+// Identificador da thread no sistema (o mesmo de `top -H` e `perf`), ou um número sequencial.
+static uint64_t threadId() {
+#ifdef __linux__
+    return (uint64_t) syscall(SYS_gettid);
+#else
+    static std::atomic<uint64_t> next(1);
+    static thread_local uint64_t id = next++;
+    return id;
+#endif
+}
+
+static uint64_t processId() {
+#ifndef _WIN32
+    return (uint64_t) getpid();
+#else
+    return 1;
+#endif
+}
+
+Trace::Trace() {
+    id = nextTraceId++;
+    startTicks = 0;
+    usPerTick = 0;
+    previous = nullptr;
+}
+
+void Trace::start() {
+    previous = activeTrace;
+    activeTrace = this;
+    buffer()->main = true;
+    startTime = std::chrono::steady_clock::now();
+    startTicks = readTicks();
+}
+
+void Trace::stop() {
+    uint64_t ticks = readTicks() - startTicks;
+    double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - startTime).count();
+    usPerTick = ticks > 0 ? us / (double) ticks : 0;
+    activeTrace = previous;
+}
+
+// O buffer da thread atual, registrado na primeira gravação.
+TraceBuffer* Trace::buffer() {
+    if (traceCache.trace == id)
+        return traceCache.buffer;
+    std::lock_guard<std::mutex> lock(mutex);
+    buffers.push_back(std::unique_ptr<TraceBuffer>(new TraceBuffer()));
+    TraceBuffer* b = buffers.back().get();
+    b->tid = threadId();
+    b->main = false;
+    b->events.reserve(4096);
+    traceCache.trace = id;
+    traceCache.buffer = b;
+    return b;
+}
+
+void Trace::record(const char* category, std::string_view name, uint64_t begin, uint64_t end) {
+    TraceBuffer* b = buffer();
+    b->events.push_back({ begin, end, category, (uint32_t) b->names.size(), (uint32_t) name.size() });
+    b->names.append(name.data(), name.size());
+}
+
+// Microssegundos com três casas, a partir de nanossegundos inteiros (sem formatar `double`).
+static void appendMicros(string& out, double us) {
+    uint64_t ns = (uint64_t) (us * 1e3 + 0.5);
+    char buf[32];
+    char* end = std::to_chars(buf, buf + sizeof(buf), ns / 1000).ptr;
+    *end++ = '.';
+    *end++ = (char) ('0' + ns / 100 % 10);
+    *end++ = (char) ('0' + ns / 10 % 10);
+    *end++ = (char) ('0' + ns % 10);
+    out.append(buf, end - buf);
+}
+
+// Eventos completos ("X") com início e duração em microssegundos desde `start`, mais o nome
+// de cada faixa (metadado "thread_name").
+string Trace::json() {
+    std::lock_guard<std::mutex> lock(mutex);
+    string pid = to_string(processId());
+    string out = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    size_t events = 0;
+    for (auto& b : buffers)
+        events += b->events.size() + 1;
+    out.reserve(events * 128);
+    bool first = true;
+    int worker = 0;
+    for (auto& b : buffers) {
+        string tid = to_string(b->tid);
+        string ids = ",\"pid\":" + pid + ",\"tid\":" + tid + "}";
+        string thread = b->main ? "xpp_compiler" : "worker " + to_string(++worker);
+        out += first ? "" : ",\n";
+        first = false;
+        out += "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" + pid + ",\"tid\":" + tid + ",\"args\":{\"name\":";
+        appendJson(out, thread);
+        out += "}}";
+
+        for (const TraceEvent& e : b->events) {
+            out += ",\n{\"name\":";
+            appendJson(out, std::string_view(b->names).substr(e.nameOffset, e.nameLength));
+            out += ",\"cat\":\"";
+            out += e.category;
+            out += "\",\"ph\":\"X\",\"ts\":";
+            appendMicros(out, (double) (e.begin - startTicks) * usPerTick);
+            out += ",\"dur\":";
+            appendMicros(out, (double) (e.end - e.begin) * usPerTick);
+            out += ids;
+        }
+    }
+    out += "\n]}\n";
+    return out;
+}
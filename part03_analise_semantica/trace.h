@@ -0,0 +1,98 @@
+#include "superheader.h"
+
+// Trecho de execução gravado por `--trace`: [begin, end) em ticks de `readTicks`.
+struct TraceEvent {
+    uint64_t begin;
+    uint64_t end;
+    const char* category;   // "arquivo", "fase", "classe", "metodo" (literais).
+    uint32_t nameOffset;    // Nome em `TraceBuffer::names`.
+    uint32_t nameLength;
+};
+
+// Trechos de uma thread. Só a thread dona escreve no buffer, sem locks; os nomes são
+// copiados para um único texto, porque os lexemas e caminhos não sobrevivem à compilação.
+struct TraceBuffer {
+    uint64_t tid;
+    bool main;              // A thread que chamou `Trace::start`.
+    std::vector<TraceEvent> events;
+    string names;
+};
+
+// A classe `Trace` grava os trechos (arquivos, fases, classes e métodos) de uma compilação
+// e os exporta no formato de eventos do Chrome (chrome://tracing, Perfetto), uma faixa por
+// thread, para mostrar onde a análise paralela fica esperando.
+//
+// Cada thread grava no seu próprio `TraceBuffer`; o lock só é usado na primeira gravação de
+// uma thread (registro do buffer) e em `json`, depois de `stop`, quando nenhuma thread grava
+// mais. O relógio é o mesmo de `TimeReport`, calibrado entre `start` e `stop`.
+//
+// Como `TimeReport`, o trace fica ativo na thread que chamou `start` até `stop`; as threads
+// de `ProgramBuild` o ativam durante as suas tarefas (`TraceThread`). Sem trace ativo, um
+// `TraceSpan` custa a leitura de um ponteiro.
+class Trace {
+public:
+    Trace();
+
+    void start();                       // Ativa o trace nesta thread.
+    void stop();
+    void record(const char* category, std::string_view name, uint64_t begin, uint64_t end);
+    string json();                      // {"traceEvents": [...]}, depois de `stop`.
+
+private:
+    uint64_t id;                        // Distingue traces sucessivos no cache de cada thread.
+    std::mutex mutex;
+    std::vector<std::unique_ptr<TraceBuffer>> buffers;
+    uint64_t startTicks;
+    std::chrono::steady_clock::time_point startTime;
+    double usPerTick;                   // Calculado por `stop`.
+    Trace* previous;
+
+    TraceBuffer* buffer();
+
+    Trace(const Trace&);
+    Trace& operator=(const Trace&);
+};
+
+extern thread_local Trace* activeTrace;
+
+// Grava o escopo como um trecho quando há um trace ativo na thread. `name` precisa viver até
+// o fim do escopo.
+class TraceSpan {
+public:
+    TraceSpan(const char* category, std::string_view name) : trace(activeTrace), category(category), name(name) {
+        XPP_PROBE3(span__start, category, name.data(), name.size());
+        if (trace != nullptr)
+            begin = readTicks();
+    }
+    ~TraceSpan() {
+        XPP_PROBE3(span__end, category, name.data(), name.size());
+        if (trace != nullptr)
+            trace->record(category, name, begin, readTicks());
+    }
+
+private:
+    Trace* trace;
+    const char* category;
+    std::string_view name;
+    uint64_t begin;
+
+    TraceSpan(const TraceSpan&);
+    TraceSpan& operator=(const TraceSpan&);
+};
+
+// Ativa `trace` na thread atual durante o escopo (tarefas de um `ThreadPool`).
+class TraceThread {
+public:
+    explicit TraceThread(Trace* trace) : previous(activeTrace) {
+        activeTrace = trace;
+    }
+    ~TraceThread() {
+        activeTrace = previous;
+    }
+
+private:
+    Trace* previous;
+
+    TraceThread(const TraceThread&);
+    TraceThread& operator=(const TraceThread&);
+};
@@ -0,0 +1,100 @@
+#include "superheader.h"
+
+TypeTable::TypeTable(Interner* n) {
+    names = n;
+    create(TK_NONE, NO_ATOM, NO_TYPE);   // NO_TYPE
+    create(TK_INT, NO_ATOM, NO_TYPE);    // TYPE_INT
+    create(TK_STRING, NO_ATOM, NO_TYPE); // TYPE_STRING
+}
+
+TypeId TypeTable::create(TypeKind kind, Atom name, TypeId element) {
+    TypeInfo info;
+    info.kind = kind;
+    info.name = name;
+    info.element = element;
+    info.arrayType = NO_TYPE;
+    types.push_back(info);
+    return (TypeId) types.size() - 1;
+}
+
+TypeId TypeTable::classType(Atom name) {
+    TypeId* found = classTypes.find(name);
+    if (found != nullptr)
+        return *found;
+
+    TypeId id = create(TK_CLASS, name, NO_TYPE);
+    classTypes.insert(name, id);
+    return id;
+}
+
+// O tipo array fica guardado no próprio tipo do elemento, então `T[]` é obtido em O(1).
+TypeId TypeTable::arrayOf(TypeId element) {
+    if (types[element].arrayType == NO_TYPE) {
+        TypeId id = create(TK_ARRAY, NO_ATOM, element);
+        types[element].arrayType = id;
+    }
+    return types[element].arrayType;
+}
+
+TypeId TypeTable::fromToken(Token* token) {
+    if (token->type == INT)
+        return TYPE_INT;
+    if (token->type == STRING)
+        return TYPE_STRING;
+    if (token->type == ID)
+        return classType(names->intern(token->lexeme));
+    return NO_TYPE;
+}
+
+TypeId TypeTable::fromName(std::string_view text) {
+    int arrays = 0;
+    while (text.size() > 2 && text.substr(text.size() - 2) == "[]") {
+        text.remove_suffix(2);
+        arrays++;
+    }
+
+    TypeId t = text == "int" ? TYPE_INT : text == "string" ? TYPE_STRING : classType(names->intern(text));
+    while (arrays-- > 0)
+        t = arrayOf(t);
+    return t;
+}
+
+TypeKind TypeTable::kind(TypeId t) {
+    return types[t].kind;
+}
+
+bool TypeTable::isClass(TypeId t) {
+    return types[t].kind == TK_CLASS;
+}
+
+bool TypeTable::isArray(TypeId t) {
+    return types[t].kind == TK_ARRAY;
+}
+
+TypeId TypeTable::elementOf(TypeId t) {
+    return types[t].element;
+}
+
+TypeId TypeTable::baseOf(TypeId t) {
+    while (types[t].kind == TK_ARRAY)
+        t = types[t].element;
+    return t;
+}
+
+Atom TypeTable::classNameOf(TypeId t) {
+    return types[t].name;
+}
+
+string TypeTable::name(TypeId t) {
+    switch (types[t].kind) {
+    case TK_INT:    return "int";
+    case TK_STRING: return "string";
+    case TK_CLASS:  return string(names->str(types[t].name));
+    case TK_ARRAY:  return name(types[t].element) + "[]";
+    default:        return "<sem tipo>";
+    }
+}
+
+size_t TypeTable::size() {
+    return types.size();
+}
@@ -0,0 +1,53 @@
+#include "superheader.h"
+
+// Identificador de um tipo internalizado. Tipos iguais têm sempre o mesmo `TypeId`,
+// então comparar e usar tipos como chave é uma operação sobre inteiros.
+typedef uint32_t TypeId;
+const TypeId NO_TYPE = 0;      // Ausência de tipo (palavras reservadas, erros).
+const TypeId TYPE_INT = 1;     // int
+const TypeId TYPE_STRING = 2;  // string
+
+// Categorias de tipo.
+enum TypeKind : uint8_t {
+    TK_NONE,
+    TK_INT,
+    TK_STRING,
+    TK_CLASS,
+    TK_ARRAY
+};
+
+// A classe `TypeTable` internaliza os tipos da compilação: `int`, `string`, cada tipo de
+// classe (pelo átomo do nome) e `T[]` para cada tipo `T` usado em array.
+// Cada tipo é criado uma única vez e identificado por um `TypeId`.
+class TypeTable {
+public:
+    TypeTable(Interner*);
+
+    TypeId classType(Atom name);   // Tipo da classe com esse nome (criado se necessário).
+    TypeId arrayOf(TypeId element); // Tipo array de `element` (criado se necessário).
+    TypeId fromToken(Token*);      // Tipo nomeado pelo token (int, string ou ID).
+    TypeId fromName(std::string_view); // Tipo escrito como em `name()` (int, string, Classe, T[]).
+
+    TypeKind kind(TypeId);
+    bool isClass(TypeId);
+    bool isArray(TypeId);
+    TypeId elementOf(TypeId);      // Tipo do elemento de um array.
+    TypeId baseOf(TypeId);         // Remove todos os níveis de array.
+    Atom classNameOf(TypeId);      // Átomo do nome de um tipo de classe.
+    string name(TypeId);           // Nome legível (int, string, Classe, T[]).
+    size_t size();                 // Número de tipos distintos.
+
+private:
+    struct TypeInfo {
+        TypeKind kind;
+        Atom name;        // Para classes: nome da classe.
+        TypeId element;   // Para arrays: tipo do elemento.
+        TypeId arrayType; // Cache de arrayOf(este tipo); NO_TYPE se ainda não criado.
+    };
+
+    Interner* names;
+    std::vector<TypeInfo> types;            // Indexado por `TypeId`.
+    FlatHashMap<Atom, TypeId> classTypes;   // Nome da classe -> tipo.
+
+    TypeId create(TypeKind, Atom, TypeId);
+};
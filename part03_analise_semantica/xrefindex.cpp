@@ -0,0 +1,355 @@
+#include "superheader.h"
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/file.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+static const char MAGIC[4] = { 'X', 'P', 'P', 'X' };
+static const uint32_t VERSION = 1;
+static const size_t HEADER_SIZE = 48;
+static const size_t REF_SIZE = 20;
+static const size_t SUB_SIZE = 16;
+
+XrefIndex::XrefIndex() {
+    data = nullptr;
+    size = 0;
+    mapped = false;
+}
+
+XrefIndex::~XrefIndex() {
+#ifndef _WIN32
+    if (mapped)
+        munmap((void*) data, size);
+#endif
+}
+
+uint32_t XrefIndex::u32(size_t offset) {
+    uint32_t v;
+    memcpy(&v, data + offset, 4);
+    return v;
+}
+
+// `validate` só confere as seções; cada referência a string é conferida aqui. Uma string
+// fora da tabela (índice corrompido) é lida como vazia e não casa com nenhum símbolo.
+std::string_view XrefIndex::str(uint32_t offset) {
+    size_t base = u32(32) + (size_t) offset;
+    size_t stringsEnd = (size_t) u32(32) + u32(36);
+    if ((size_t) offset + 4 > u32(36) || base + 4 + u32(base) > stringsEnd)
+        return std::string_view();
+    return std::string_view((const char*) data + base + 4, u32(base));
+}
+
+bool XrefIndex::open(const string& fileName) {
+#ifndef _WIN32
+    int fd = ::open(fileName.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    struct stat st;
+    if (fstat(fd, &st) == 0 && st.st_size >= (off_t) HEADER_SIZE) {
+        void* p = mmap(nullptr, (size_t) st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p != MAP_FAILED) {
+            data = (const uint8_t*) p;
+            size = (size_t) st.st_size;
+            mapped = true;
+        }
+    }
+    close(fd);
+#else
+    ifstream in(fileName, ios::in | ios::binary);
+    if (in.is_open()) {
+        buffer.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+        data = buffer.data();
+        size = buffer.size();
+    }
+#endif
+
+    return validate();
+}
+
+// Validação do cabeçalho e dos limites das seções.
+bool XrefIndex::validate() {
+    if (data == nullptr || size < HEADER_SIZE || memcmp(data, MAGIC, 4) != 0 || u32(4) != VERSION)
+        return false;
+
+    return u32(40) == size
+        && (size_t) u32(12) + (size_t) u32(8) * 4 <= size
+        && (size_t) u32(20) + (size_t) u32(16) * REF_SIZE <= size
+        && (size_t) u32(28) + (size_t) u32(24) * SUB_SIZE <= size
+        && (size_t) u32(32) + u32(36) <= size;
+}
+
+size_t XrefIndex::fileCount() {
+    return u32(8);
+}
+
+size_t XrefIndex::referenceCount() {
+    return u32(16);
+}
+
+string XrefIndex::fileAt(size_t i) {
+    return string(str(u32(u32(12) + i * 4)));
+}
+
+// Primeiro registro cuja chave (a string do início do registro) não é menor que `key`.
+size_t XrefIndex::lowerBound(size_t offset, size_t count, size_t stride, std::string_view key) {
+    size_t low = 0, high = count;
+    while (low < high) {
+        size_t mid = low + (high - low) / 2;
+        if (str(u32(offset + mid * stride)) < key)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+    return low;
+}
+
+void XrefIndex::references(std::string_view symbol, std::vector<XrefReference>* out) {
+    size_t offset = u32(20), count = u32(16);
+    for (size_t i = lowerBound(offset, count, REF_SIZE, symbol); i < count; i++) {
+        size_t r = offset + i * REF_SIZE;
+        if (str(u32(r)) != symbol)
+            break;
+        uint32_t flags = u32(r + 16);
+        XrefReference ref;
+        ref.file = string(str(u32(r + 4)));
+        ref.line = (int) u32(r + 8);
+        ref.column = (int) u32(r + 12);
+        ref.kind = (SymbolKind) (flags & 0xFF);
+        ref.declaration = (flags >> 8) & 1;
+        ref.field = (flags >> 9) & 1;
+        out->push_back(ref);
+    }
+}
+
+// A descendência é percorrida em largura, uma busca binária por classe visitada.
+void XrefIndex::subclasses(std::string_view name, std::vector<XrefSubclass>* out, bool transitive) {
+    size_t offset = u32(28), count = u32(24);
+    std::unordered_set<string> seen = { string(name) };
+    size_t first = out->size();
+    std::string_view parent = name;
+    for (size_t next = first; ; next++) {
+        for (size_t i = lowerBound(offset, count, SUB_SIZE, parent); i < count; i++) {
+            size_t r = offset + i * SUB_SIZE;
+            if (str(u32(r)) != parent)
+                break;
+            XrefSubclass sub;
+            sub.parent = string(parent);
+            sub.name = string(str(u32(r + 4)));
+            sub.file = string(str(u32(r + 8)));
+            sub.line = (int) u32(r + 12);
+            if (seen.insert(sub.name).second) // Índices com arquivos desatualizados podem ter ciclos.
+                out->push_back(sub);
+        }
+        if (!transitive || next >= out->size())
+            break;
+        parent = (*out)[next].name;
+    }
+}
+
+string XrefIndex::symbolOf(const Occurrence& o) {
+    if (o.kind == CLASS_NAME)
+        return o.name;
+    string symbol = o.owner + "." + o.name;
+    if (o.declLine > 0)
+        symbol += "@" + to_string(o.declLine) + ":" + to_string(o.declColumn);
+    return symbol;
+}
+
+/**********************************************************
+*
+*                   ATUALIZAÇÃO
+*
+***********************************************************/
+
+namespace {
+
+struct RefEntry {
+    std::string_view symbol;
+    std::string_view file;
+    uint32_t line, column, flags;
+
+    bool operator<(const RefEntry& o) const {
+        if (symbol != o.symbol)
+            return symbol < o.symbol;
+        if (file != o.file)
+            return file < o.file;
+        return line != o.line ? line < o.line : column < o.column;
+    }
+};
+
+struct SubEntry {
+    std::string_view parent;
+    std::string_view child;
+    std::string_view file;
+    uint32_t line;
+
+    bool operator<(const SubEntry& o) const {
+        return parent != o.parent ? parent < o.parent : child < o.child;
+    }
+};
+
+// Intercala as entradas mantidas (já ordenadas) com as novas (ordenadas aqui).
+template <typename Entry>
+std::vector<Entry> mergeEntries(const std::vector<Entry>& kept, std::vector<Entry>& fresh) {
+    std::sort(fresh.begin(), fresh.end());
+    std::vector<Entry> all(kept.size() + fresh.size());
+    std::merge(kept.begin(), kept.end(), fresh.begin(), fresh.end(), all.begin());
+    return all;
+}
+
+// Atualizações do mesmo índice (compilações paralelas, ou o daemon) são serializadas por um
+// arquivo de trava ao lado do índice, para que nenhuma perca as entradas da outra.
+class IndexLock {
+public:
+    explicit IndexLock(const string& path) {
+#ifndef _WIN32
+        fd = ::open((path + ".lock").c_str(), O_CREAT | O_RDWR, 0644);
+        if (fd >= 0)
+            flock(fd, LOCK_EX);
+#endif
+    }
+    ~IndexLock() {
+#ifndef _WIN32
+        if (fd >= 0)
+            close(fd); // Libera a trava.
+#endif
+    }
+
+private:
+    int fd;
+};
+
+void put32(string& buf, uint32_t v) {
+    buf.append((const char*) &v, 4);
+}
+
+} // namespace
+
+bool XrefIndex::update(const string& path, const std::vector<XrefFile>& files) {
+    IndexLock lock(path);
+    XrefIndex old;
+    bool hasOld = old.open(path);
+
+    // O mesmo arquivo compilado por caminhos diferentes substitui as mesmas entradas.
+    std::vector<string> canonical;
+    std::unordered_set<std::string_view> replaced;
+    canonical.reserve(files.size());
+    for (const XrefFile& f : files) {
+        std::error_code error;
+        std::filesystem::path p = std::filesystem::weakly_canonical(f.path, error);
+        canonical.push_back(error ? f.path : p.string());
+        replaced.insert(canonical.back());
+    }
+
+    // Entradas mantidas do índice anterior: as strings continuam no arquivo mapeado, que
+    // permanece válido mesmo depois de o índice novo tomar o seu lugar.
+    std::vector<RefEntry> keptRefs;
+    std::vector<SubEntry> keptSubs;
+    std::vector<std::string_view> paths;
+    if (hasOld) {
+        std::unordered_set<uint32_t> stale; // Offsets dos caminhos substituídos.
+        for (size_t i = 0; i < old.fileCount(); i++) {
+            uint32_t ref = old.u32(old.u32(12) + i * 4);
+            if (replaced.count(old.str(ref)))
+                stale.insert(ref);
+            else
+                paths.push_back(old.str(ref));
+        }
+
+        size_t offset = old.u32(20), count = old.u32(16);
+        keptRefs.reserve(count);
+        for (size_t i = 0; i < count; i++) {
+            size_t r = offset + i * REF_SIZE;
+            if (!stale.count(old.u32(r + 4)))
+                keptRefs.push_back({ old.str(old.u32(r)), old.str(old.u32(r + 4)),
+                                     old.u32(r + 8), old.u32(r + 12), old.u32(r + 16) });
+        }
+
+        offset = old.u32(28);
+        count = old.u32(24);
+        for (size_t i = 0; i < count; i++) {
+            size_t r = offset + i * SUB_SIZE;
+            if (!stale.count(old.u32(r + 8)))
+                keptSubs.push_back({ old.str(old.u32(r)), old.str(old.u32(r + 4)),
+                                     old.str(old.u32(r + 8)), old.u32(r + 12) });
+        }
+    }
+
+    std::deque<string> symbols; // Donos das chaves novas (endereços estáveis).
+    std::vector<RefEntry> freshRefs;
+    std::vector<SubEntry> freshSubs;
+    for (size_t k = 0; k < files.size(); k++) {
+        const XrefFile& f = files[k];
+        std::string_view file = canonical[k];
+        paths.push_back(file);
+        for (const Occurrence& o : f.occurrences) {
+            symbols.push_back(symbolOf(o));
+            uint32_t flags = (uint32_t) o.kind | (o.declaration ? 1u << 8 : 0) | (o.field ? 1u << 9 : 0);
+            freshRefs.push_back({ symbols.back(), file, (uint32_t) o.line, (uint32_t) o.column, flags });
+            if (o.kind == CLASS_NAME && o.declaration && !o.type.empty())
+                freshSubs.push_back({ o.type, o.name, file, (uint32_t) o.line });
+        }
+    }
+
+    std::vector<RefEntry> refs = mergeEntries(keptRefs, freshRefs);
+    std::vector<SubEntry> subs = mergeEntries(keptSubs, freshSubs);
+    std::sort(paths.begin(), paths.end());
+    paths.erase(std::unique(paths.begin(), paths.end()), paths.end());
+
+    // As ocorrências de um símbolo são vizinhas, e os caminhos são poucos (as entradas de um
+    // arquivo apontam todas para a mesma cópia): a maioria das referências a strings sai
+    // sem consultar a tabela.
+    StringSection strings;
+    std::unordered_map<const char*, uint32_t> fileRefs;
+    auto fileRef = [&](std::string_view file) {
+        auto found = fileRefs.find(file.data());
+        return found != fileRefs.end() ? found->second : fileRefs[file.data()] = strings.ref(file);
+    };
+    string body;
+    body.reserve(paths.size() * 4 + refs.size() * REF_SIZE + subs.size() * SUB_SIZE);
+    uint32_t filesOffset = (uint32_t) HEADER_SIZE;
+    for (std::string_view p : paths)
+        put32(body, strings.ref(p));
+    uint32_t refsOffset = filesOffset + (uint32_t) body.size();
+    std::string_view lastSymbol;
+    uint32_t symbolRef = 0;
+    for (const RefEntry& e : refs) {
+        if (e.symbol.data() != lastSymbol.data() && e.symbol != lastSymbol) {
+            lastSymbol = e.symbol;
+            symbolRef = strings.ref(e.symbol);
+        }
+        put32(body, symbolRef);
+        put32(body, fileRef(e.file));
+        put32(body, e.line);
+        put32(body, e.column);
+        put32(body, e.flags);
+    }
+    uint32_t subsOffset = filesOffset + (uint32_t) body.size();
+    for (const SubEntry& e : subs) {
+        put32(body, strings.ref(e.parent));
+        put32(body, strings.ref(e.child));
+        put32(body, fileRef(e.file));
+        put32(body, e.line);
+    }
+    uint32_t stringsOffset = filesOffset + (uint32_t) body.size();
+
+    string header(MAGIC, 4);
+    put32(header, VERSION);
+    put32(header, (uint32_t) paths.size());
+    put32(header, filesOffset);
+    put32(header, (uint32_t) refs.size());
+    put32(header, refsOffset);
+    put32(header, (uint32_t) subs.size());
+    put32(header, subsOffset);
+    put32(header, stringsOffset);
+    put32(header, (uint32_t) strings.bytes.size());
+    put32(header, stringsOffset + (uint32_t) strings.bytes.size());
+    put32(header, 0);
+
+    return CompilationCache::writeAtomically(path, header + body + strings.bytes);
+}
@@ -0,0 +1,81 @@
+#include "superheader.h"
+
+// Ocorrências registradas na análise de um arquivo, para atualizar o índice.
+struct XrefFile {
+    string path;                        // Gravado no índice na forma canônica (identidade do arquivo).
+    std::vector<Occurrence> occurrences;
+};
+
+// Resultado de `XrefIndex::references`.
+struct XrefReference {
+    string file;
+    int line;
+    int column;
+    SymbolKind kind;
+    bool declaration;
+    bool field;
+};
+
+// Resultado de `XrefIndex::subclasses`.
+struct XrefSubclass {
+    string name;
+    string parent;
+    string file;
+    int line;                           // Linha da declaração da classe.
+};
+
+// A classe `XrefIndex` lê e atualiza o índice de referências (`--emit-xref`): todas as
+// declarações e usos de classes, campos, métodos, parâmetros e locais de um conjunto de
+// arquivos, ordenados pelo símbolo, para consultas por busca binária sem carregar o índice.
+//
+// Símbolos: a classe pelo nome (`C`), um membro pelo dono e nome (`C.m`), um local ou
+// parâmetro pelo dono, nome e posição da declaração (`C.x@12:9`).
+//
+// Formato (inteiros de 32 bits little-endian, alinhados em 4 bytes):
+//   cabeçalho  "XPPX", versão, nº de arquivos, offset dos arquivos, nº de ocorrências,
+//              offset das ocorrências, nº de subclasses, offset das subclasses, offset e
+//              tamanho da tabela de strings, tamanho do arquivo
+//   arquivos   {caminho}, em ordem
+//   ocorrências {símbolo, arquivo, linha, coluna, tipo(8)|declaração(1)|campo(1)}, ordenadas
+//              por símbolo, arquivo, linha e coluna
+//   subclasses {pai, classe, arquivo, linha}, ordenadas por pai e classe
+//   strings    {tamanho, bytes} referenciadas por offset (ver `StringSection`)
+//
+// `update` substitui as entradas dos arquivos recompilados: as entradas dos outros arquivos,
+// já ordenadas, são intercaladas com as novas em uma passada, e o índice é gravado de forma
+// atômica (quem estiver mapeando o índice anterior continua vendo o arquivo inteiro).
+class XrefIndex {
+public:
+    XrefIndex();
+    ~XrefIndex();
+
+    bool open(const string& path);      // Mapeia e valida o índice.
+    size_t fileCount();
+    size_t referenceCount();
+    string fileAt(size_t i);
+
+    // Declarações e usos do símbolo, em O(log n) + nº de resultados.
+    void references(std::string_view symbol, std::vector<XrefReference>* out);
+    // Classes que estendem `name` diretamente (ou, com `transitive`, toda a descendência).
+    void subclasses(std::string_view name, std::vector<XrefSubclass>* out, bool transitive = false);
+
+    static string symbolOf(const Occurrence& occurrence);
+
+    // Grava em `path` o índice anterior (se houver e for válido) com as entradas de `files`
+    // no lugar das que esses arquivos tinham.
+    static bool update(const string& path, const std::vector<XrefFile>& files);
+
+private:
+    const uint8_t* data;
+    size_t size;
+    std::vector<uint8_t> buffer;        // Usado quando não há mmap (Windows).
+    bool mapped;
+
+    bool validate();
+    uint32_t u32(size_t offset);
+    std::string_view str(uint32_t offset); // Vazia se a string sai da tabela de strings.
+    size_t lowerBound(size_t offset, size_t count, size_t stride, std::string_view key);
+
+    XrefIndex(const XrefIndex&);
+    XrefIndex& operator=(const XrefIndex&);
+};